@@ -17,6 +17,8 @@
 #include <data/model_loader.h>
 #include <data/abstract_image.h>
 
+#include <memory/memory_tag.h>
+
 // --public
 
 gdm::MeshHandle gdm::MeshFactory::Create(const char* mesh_name, int mesh_num, const ModelLoader& loader)
@@ -64,6 +66,8 @@ gdm::MeshHandle gdm::MeshFactory::Create(const char* mesh_name, int mesh_num, co
     mesh->tangents_.resize(mesh->coords_.size(), Vec3f{0.f, 1.f, 0.f});
   }
 
+  std::size_t vx_floats = (sizeof(Vec3f) * 3 + sizeof(Vec2f)) / sizeof(float);
+  mesh->interleaving_vxs_buffer_ = GrowableBuffer<float>(mesh->coords_.size() * vx_floats, MEMORY_TAG("Mesh"));
   AddToVxsBuffer(mesh, mesh->coords_);
   AddToVxsBuffer(mesh, mesh->texuv_);
   AddToVxsBuffer(mesh, mesh->normals_);
@@ -10,6 +10,7 @@
 #include <vector>
 
 #include "memory/defines.h"
+#include "memory/growable_buffer.h"
 #include "math/vector2.h"
 #include "math/vector3.h"
 #include "math/vector4.h"
@@ -45,7 +46,7 @@ public:
   std::vector<Vec3f> tangents_;
   std::vector<Vec2f> texuv_;
   std::size_t vx_total_sz_;
-  std::vector<float> interleaving_vxs_buffer_ ;
+  GrowableBuffer<float> interleaving_vxs_buffer_ {0};
   std::size_t interleaving_vxs_buffer_sz_;
   MaterialHandle material_;
   void* vertex_buffer_ = nullptr;
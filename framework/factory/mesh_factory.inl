@@ -6,7 +6,7 @@
 
 #include "mesh_factory.h"
 
-#include <system/array_utils.h>
+#include <cstring>
 
 // --private
 
@@ -15,15 +15,21 @@ inline void gdm::MeshFactory::AddToVxsBuffer(AbstractMesh* mesh, const std::vect
 {
   assert(!v.empty());
   std::size_t elems_cnt = sizeof(T) / sizeof(T::x);
+  std::size_t old_sz = mesh->interleaving_vxs_buffer_sz_;
+  std::size_t new_sz = old_sz + elems_cnt;
 
-  if (mesh->interleaving_vxs_buffer_ .empty())
-    mesh->interleaving_vxs_buffer_  = arr_utils::ArrayToVector(&v[0].x, v.size(), elems_cnt);
-  else
-    mesh->interleaving_vxs_buffer_  = arr_utils::Expand(&mesh->interleaving_vxs_buffer_[0], mesh->interleaving_vxs_buffer_sz_,
-                                      mesh->interleaving_vxs_buffer_ .size() / mesh->interleaving_vxs_buffer_sz_,
-                                      &v[0].x, elems_cnt, v.size());
+  // Buffer grows in place, so vertices are spread to the new stride from the
+  //  last one without overwriting ones which are not moved yet
+
+  mesh->interleaving_vxs_buffer_.resize(v.size() * new_sz);
+  float* data = mesh->interleaving_vxs_buffer_.data();
+  for (std::size_t i = v.size(); i-- > 0;)
+  {
+    std::memmove(data + i * new_sz, data + i * old_sz, old_sz * sizeof(float));
+    std::memcpy(data + i * new_sz + old_sz, &v[i].x, elems_cnt * sizeof(float));
+  }
   mesh->vx_total_sz_ += sizeof(T);
-  mesh->interleaving_vxs_buffer_sz_ += elems_cnt;
+  mesh->interleaving_vxs_buffer_sz_ = new_sz;
 
   assert(mesh->interleaving_vxs_buffer_ .size() == v.size() * mesh->interleaving_vxs_buffer_sz_);
-}
\ No newline at end of file
+}
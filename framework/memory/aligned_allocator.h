@@ -16,8 +16,8 @@ struct AlignedAllocator
 {
   AlignedAllocator() = default;
   AlignedAllocator(int memory_tag);
-  template<class U, size_t Align>
-  AlignedAllocator(const AlignedAllocator<U, Align>&) noexcept { }
+  template<class U, size_t OtherAlign>
+  AlignedAllocator(const AlignedAllocator<U, OtherAlign>&) noexcept { }
 
 private:
   int memory_tag_ = 0;
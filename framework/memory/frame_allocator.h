@@ -14,6 +14,8 @@ namespace gdm {
 template <size_t Size>
 struct FrameAllocator
 {
+  using Marker = size_t;
+
   FrameAllocator() = default;
 
   template <class T>
@@ -22,13 +24,18 @@ struct FrameAllocator
   static auto Allocate(size_t count, size_t alignment) -> void*;
 
   static void Deallocate();
+  static void Deallocate(void* ptr, size_t bytes);
+  static auto GetMarker() -> Marker { return offset_; }
+  static void FreeToMarker(Marker marker);
   static void Reset();
   static auto GetFreeSize() -> size_t;
 
+ private:
+  static auto GetRoundedSize(size_t bytes) -> size_t;
+
  private:
   static char buffer_[Size];
   static size_t offset_;
-  static uintptr_t last_alloc_;
 
 }; // struct FrameAllocator
 
@@ -39,8 +46,8 @@ struct FrameAllocatorTyped
   using BaseAllocator = ::gdm::FrameAllocator<Size>;
 
   FrameAllocatorTyped() = default;
-  template<class U, size_t Size>
-  FrameAllocatorTyped(const FrameAllocatorTyped<U,Size>&) noexcept { }
+  template<class U, size_t OtherSize>
+  FrameAllocatorTyped(const FrameAllocatorTyped<U,OtherSize>&) noexcept { }
 
   // stl stuff
 
@@ -50,9 +57,26 @@ struct FrameAllocatorTyped
     using other = FrameAllocatorTyped<U, Size>;
   };
 
-  auto allocate(size_t num);
-  void deallocate(T* ptr, size_t);
-};
+  auto allocate(size_t num) -> T*;
+  void deallocate(T* ptr, size_t num);
+
+}; // struct FrameAllocatorTyped
+
+// Restores marker of frame allocator on scope exit, so temporaries allocated
+//  inside the scope are released in bulk
+
+template <size_t Size>
+struct FrameScope
+{
+  FrameScope() : marker_{FrameAllocator<Size>::GetMarker()} { }
+  FrameScope(const FrameScope&) = delete;
+  FrameScope& operator=(const FrameScope&) = delete;
+  ~FrameScope() { FrameAllocator<Size>::FreeToMarker(marker_); }
+
+private:
+  typename FrameAllocator<Size>::Marker marker_;
+
+}; // struct FrameScope
 
 } // namespace gdm
 
@@ -7,6 +7,8 @@
 #include "frame_allocator.h"
 
 #include <type_traits>
+#include <new>
+#include <cstring>
 
 #include "math/general.h"
 #include "system/assert_utils.h"
@@ -20,9 +22,6 @@ char gdm::FrameAllocator<Size>::buffer_[Size] = {};
 template <size_t Size>
 size_t gdm::FrameAllocator<Size>::offset_ = 0;
 
-template <size_t Size>
-uintptr_t gdm::FrameAllocator<Size>::last_alloc_ = 0;
-
 // --public
 
 template <size_t Size>
@@ -42,18 +41,15 @@ void* gdm::FrameAllocator<Size>::Allocate(size_t count, size_t alignment)
 
   ASSERTF(math::IsPowerOfTwo(alignment), "Alignment %zu is not power of 2", alignment);
 
-  size_t size = sizeof(T) * count;
-  void* raw = &buffer_[offset_];
-  uintptr_t uraw = mem::PtrToUptr(raw);
-  size_t mask = alignment - 1;
-  uintptr_t uptr = (uraw + mask) & ~mask;
+  size_t size = GetRoundedSize(sizeof(T) * count);
+  uintptr_t ubase = mem::PtrToUptr(buffer_);
+  uintptr_t uptr = mem::AlignAddress(ubase + offset_, alignment);
+  size_t end = uptr - ubase + size;
 
-  offset_ += size + (uptr - uraw);
-  
-  if (offset_ >= Size)
+  if (end > Size)
     return nullptr;
 
-  last_alloc_ = uptr;
+  offset_ = end;
   return mem::UptrToPtr(uptr);
 }
 
@@ -61,11 +57,40 @@ template <size_t Size>
 void gdm::FrameAllocator<Size>::Deallocate()
 { }
 
+// Only the last allocation is released, so freeing in reverse order releases
+//  all of them. Others stay till marker or reset
+
+template <size_t Size>
+void gdm::FrameAllocator<Size>::Deallocate(void* ptr, size_t bytes)
+{
+  if (static_cast<char*>(ptr) + GetRoundedSize(bytes) == buffer_ + offset_)
+    offset_ = static_cast<size_t>(static_cast<char*>(ptr) - buffer_);
+}
+
+template <size_t Size>
+void gdm::FrameAllocator<Size>::FreeToMarker(Marker marker)
+{
+  ASSERTF(marker <= offset_, "Marker %zu is above the top %zu", marker, offset_);
+#ifndef NDEBUG
+  memset(buffer_ + marker, 0xcd, offset_ - marker);
+#endif
+  offset_ = marker;
+}
+
+// Sizes are rounded to default alignment, so allocations of types aligned
+//  not stricter are adjacent and may be freed one by one in reverse order
+
+template <size_t Size>
+size_t gdm::FrameAllocator<Size>::GetRoundedSize(size_t bytes)
+{
+  const size_t mask = MemoryManager::GetDefaultAlignment() - 1;
+  return (bytes + mask) & ~mask;
+}
+
 template <size_t Size>
 void gdm::FrameAllocator<Size>::Reset()
 {
-  offset_ = 0;
-  memset(buffer_, 0, Size);
+  FreeToMarker(0);
 }
 
 template <size_t Size>
@@ -88,18 +113,36 @@ constexpr bool operator!=(const gdm::FrameAllocator<T1>&, const gdm::FrameAlloca
 
 // --stl
 
+// All typed allocators of the same size share one static buffer, so they are
+//  interchangeable and always compare equal
+
 template <class T, size_t Size>
-auto gdm::FrameAllocatorTyped<T, Size>::allocate(size_t num)
+auto gdm::FrameAllocatorTyped<T, Size>::allocate(size_t num) -> T*
 {
-  // TODO: what about shared states, interchangable and so on?
-
-  void* ptr = BaseAllocator::template Allocate<T>(sizeof(T) * num);
-  uintptr_t uptr = mem::PtrToUptr(ptr);
+  void* ptr = BaseAllocator::template Allocate<T>(num, alignof(T));
+  if (!ptr)
+    throw std::bad_alloc{};
   return static_cast<T*>(ptr);
 }
 
 template <class T, size_t Size>
-void gdm::FrameAllocatorTyped<T, Size>::deallocate(T* ptr, size_t)
+void gdm::FrameAllocatorTyped<T, Size>::deallocate(T* ptr, size_t num)
 {
-  // TODO: track last ptr (marker) and deallocate if needed
+  BaseAllocator::Deallocate(ptr, sizeof(T) * num);
 }
+
+namespace gdm {
+
+template<class T1, class T2, size_t S1, size_t S2>
+constexpr bool operator==(const FrameAllocatorTyped<T1, S1>&, const FrameAllocatorTyped<T2, S2>&) noexcept
+{
+  return S1 == S2;
+}
+
+template<class T1, class T2, size_t S1, size_t S2>
+constexpr bool operator!=(const FrameAllocatorTyped<T1, S1>&, const FrameAllocatorTyped<T2, S2>&) noexcept
+{
+  return S1 != S2;
+}
+
+} // namespace gdm
@@ -0,0 +1,84 @@
+// *************************************************************
+// File:    growable_buffer.h
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#ifndef AH_GDM_GROWABLE_BUFFER_H
+#define AH_GDM_GROWABLE_BUFFER_H
+
+#include "memory/virtual_arena.h"
+#include "memory/memory_tag_value.h"
+
+namespace gdm {
+
+// Array over virtual arena reserved for at least given max count. Growth
+//  commits new pages after the last element, so elements are never copied
+//  and pointers to them stay valid, and peak memory is the size of data.
+//  Interface repeats std::vector to replace it in loaders
+
+template <class T>
+struct GrowableBuffer
+{
+  explicit GrowableBuffer(size_t max_count, MemoryTagValue tag = 0, VirtualArena::EPages pages = VirtualArena::PAGES_DEFAULT);
+  GrowableBuffer(GrowableBuffer&& other) noexcept;
+  GrowableBuffer& operator=(GrowableBuffer&& other) noexcept;
+  GrowableBuffer(const GrowableBuffer&) = delete;
+  GrowableBuffer& operator=(const GrowableBuffer&) = delete;
+  ~GrowableBuffer();
+
+  void ShrinkToFit();
+  auto GetArena() const -> const VirtualArena& { return arena_; }
+
+private:
+  void Grow(size_t count);
+  static auto GetReserveSize(size_t max_count) -> size_t;
+
+private:
+  VirtualArena arena_;
+  size_t count_;
+
+  // stl stuff
+
+public:
+  using value_type = T;
+  using iterator = T*;
+  using const_iterator = const T*;
+
+  void reserve(size_t count);
+  void resize(size_t count);
+  void resize(size_t count, const T& value);
+  void clear();
+
+  template <class...Args>
+  auto emplace_back(Args&&...args) -> T&;
+  void push_back(const T& value) { emplace_back(value); }
+  void push_back(T&& value) { emplace_back(std::move(value)); }
+  void pop_back();
+
+  auto operator[](size_t index) -> T& { return data()[index]; }
+  auto operator[](size_t index) const -> const T& { return data()[index]; }
+  auto front() -> T& { return data()[0]; }
+  auto front() const -> const T& { return data()[0]; }
+  auto back() -> T& { return data()[count_ - 1]; }
+  auto back() const -> const T& { return data()[count_ - 1]; }
+
+  auto data() -> T* { return reinterpret_cast<T*>(arena_.GetData()); }
+  auto data() const -> const T* { return reinterpret_cast<const T*>(arena_.GetData()); }
+  auto begin() -> T* { return data(); }
+  auto end() -> T* { return data() + count_; }
+  auto begin() const -> const T* { return data(); }
+  auto end() const -> const T* { return data() + count_; }
+
+  auto size() const -> size_t { return count_; }
+  auto capacity() const -> size_t { return arena_.GetCommitted() / sizeof(T); }
+  auto max_size() const -> size_t { return arena_.GetReserved() / sizeof(T); }
+  bool empty() const { return count_ == 0; }
+
+}; // struct GrowableBuffer
+
+} // namespace gdm
+
+#include "memory/growable_buffer.inl"
+
+#endif // AH_GDM_GROWABLE_BUFFER_H
@@ -0,0 +1,131 @@
+// *************************************************************
+// File:    growable_buffer.inl
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#include "memory/growable_buffer.h"
+
+#include <new>
+#include <memory>
+#include <limits>
+#include <utility>
+#include <type_traits>
+
+// --public
+
+template <class T>
+gdm::GrowableBuffer<T>::GrowableBuffer(size_t max_count, MemoryTagValue tag, VirtualArena::EPages pages)
+  : arena_(GetReserveSize(max_count), tag, pages)
+  , count_{0}
+{ }
+
+template <class T>
+gdm::GrowableBuffer<T>::GrowableBuffer(GrowableBuffer&& other) noexcept
+  : arena_(std::move(other.arena_))
+  , count_{std::exchange(other.count_, 0)}
+{ }
+
+template <class T>
+gdm::GrowableBuffer<T>& gdm::GrowableBuffer<T>::operator=(GrowableBuffer&& other) noexcept
+{
+  if (this != &other)
+  {
+    clear();
+    arena_ = std::move(other.arena_);
+    count_ = std::exchange(other.count_, 0);
+  }
+  return *this;
+}
+
+template <class T>
+gdm::GrowableBuffer<T>::~GrowableBuffer()
+{
+  clear();
+}
+
+// Gives back committed pages which are not used by elements
+
+template <class T>
+void gdm::GrowableBuffer<T>::ShrinkToFit()
+{
+  arena_.SetUsed(count_ * sizeof(T));
+  arena_.Decommit();
+}
+
+// --private
+
+template <class T>
+void gdm::GrowableBuffer<T>::Grow(size_t count)
+{
+  if (count > max_size() || !arena_.Commit(count * sizeof(T)))
+    throw std::bad_alloc{};
+}
+
+template <class T>
+auto gdm::GrowableBuffer<T>::GetReserveSize(size_t max_count) -> size_t
+{
+  if (max_count > std::numeric_limits<size_t>::max() / sizeof(T))
+    throw std::bad_alloc{};
+  return max_count * sizeof(T);
+}
+
+// --public stl
+
+template <class T>
+void gdm::GrowableBuffer<T>::reserve(size_t count)
+{
+  Grow(count);
+}
+
+template <class T>
+void gdm::GrowableBuffer<T>::resize(size_t count)
+{
+  if (count < count_)
+    std::destroy(begin() + count, end());
+  else
+  {
+    Grow(count);
+    std::uninitialized_value_construct(end(), begin() + count);
+  }
+  count_ = count;
+}
+
+template <class T>
+void gdm::GrowableBuffer<T>::resize(size_t count, const T& value)
+{
+  if (count < count_)
+    std::destroy(begin() + count, end());
+  else
+  {
+    Grow(count);
+    std::uninitialized_fill(end(), begin() + count, value);
+  }
+  count_ = count;
+}
+
+template <class T>
+void gdm::GrowableBuffer<T>::clear()
+{
+  std::destroy(begin(), end());
+  count_ = 0;
+}
+
+// Argument may refer to own element, since elements never move
+
+template <class T>
+template <class...Args>
+auto gdm::GrowableBuffer<T>::emplace_back(Args&&...args) -> T&
+{
+  if (count_ == capacity())
+    Grow(count_ + 1);
+  T* ptr = new (data() + count_) T(std::forward<Args>(args)...);
+  ++count_;
+  return *ptr;
+}
+
+template <class T>
+void gdm::GrowableBuffer<T>::pop_back()
+{
+  std::destroy_at(data() + --count_);
+}
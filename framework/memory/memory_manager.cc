@@ -7,15 +7,185 @@
 #include "memory_manager.h"
 
 #include <memory/memory_tracker.h>
+#include <memory/tlsf_heap.h>
 #include <memory/defines.h>
 #include <math/general.h>
 #include <system/assert_utils.h>
 
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <utility>
+
 #if defined (_WIN32)
 #include <malloc.h>
+#elif defined (__GLIBC__)
+#include <malloc.h>
+#endif
+
+//--private
+
+namespace gdm::_private {
+
+  // Header right before the user pointer. Offset is counted from the start of
+  //  block returned by malloc or heap, so any alignment is served by plain
+  //  allocation of the block, and size and tag are known without asking the
+  //  system
+
+  struct AllocationHeader
+  {
+    size_t size_;
+    uint32_t offset_ : 28;
+    uint32_t heap_ : 4;
+    MemoryTagValue tag_;
+  };
+
+  // Heaps are kept in slots and header stores the slot of block, zero slot
+  //  means malloc. Every slot has own lock, so thread which allocates from
+  //  own heap contends only with frees of its blocks from other threads
+
+  constexpr uint32_t v_max_heaps = 15;
+
+  struct HeapSlot
+  {
+    std::mutex lock_;
+    std::atomic<TlsfHeap*> heap_ {nullptr};
+  };
+
+  static HeapSlot s_heaps[v_max_heaps + 1];
+  static std::mutex s_slots_lock;
+  static std::atomic<uint32_t> s_heap {0};
+  static thread_local uint32_t t_heap {0};
+  static std::atomic<size_t> s_heap_fallbacks {0};
+
+  static auto GetHeader(void* ptr) -> AllocationHeader*
+  {
+    return static_cast<AllocationHeader*>(ptr) - 1;
+  }
+
+  static auto GetBlock(void* ptr) -> char*
+  {
+    return static_cast<char*>(ptr) - GetHeader(ptr)->offset_;
+  }
+
+  static auto AlignUp(uintptr_t address, size_t align) -> uintptr_t
+  {
+    return (address + align - 1) & ~(static_cast<uintptr_t>(align) - 1);
+  }
+
+  // Worst case distance from block start to the user pointer
+
+  static auto GetOverhead(size_t align) -> size_t
+  {
+    const size_t block_align = MemoryManager::GetDefaultAlignment();
+    return AlignUp(sizeof(AllocationHeader), block_align) + align - block_align;
+  }
+
+  // Bytes which really may be used in block, zero if system doesn't tell
+
+  static auto GetUsableSize(void* block) -> size_t
+  {
+#if defined (_WIN32)
+    return _msize(block);
+#elif defined (__GLIBC__)
+    return malloc_usable_size(block);
 #else
-#include <cstdlib>
+    (void)block;
+    return 0;
 #endif
+  }
+
+  static auto PlaceHeader(char* block, size_t bytes, size_t align, MemoryTagValue tag, uint32_t heap) -> void*
+  {
+    char* ptr = reinterpret_cast<char*>(AlignUp(reinterpret_cast<uintptr_t>(block) + sizeof(AllocationHeader), align));
+    AllocationHeader* header = GetHeader(ptr);
+    header->size_ = bytes;
+    header->offset_ = static_cast<uint32_t>(ptr - block);
+    header->heap_ = heap;
+    header->tag_ = tag;
+    return ptr;
+  }
+
+  // Heap of calling thread is used first, then the global one. Slot is left
+  //  zero when heap had no space, such fallbacks to malloc are counted
+
+  static auto AllocateBlock(size_t bytes, MemoryTagValue tag, uint32_t& heap) -> char*
+  {
+    heap = t_heap ? t_heap : s_heap.load(std::memory_order_acquire);
+    if (heap)
+    {
+      HeapSlot& slot = s_heaps[heap];
+      std::lock_guard<std::mutex> lock(slot.lock_);
+      if (TlsfHeap* tlsf = slot.heap_.load(std::memory_order_relaxed))
+      {
+        if (void* block = tlsf->Allocate(bytes, MemoryManager::GetDefaultAlignment(), tag))
+          return static_cast<char*>(block);
+        s_heap_fallbacks.fetch_add(1, std::memory_order_relaxed);
+      }
+      heap = 0;
+    }
+    return static_cast<char*>(std::malloc(bytes));
+  }
+
+  static void DeallocateBlock(char* block, const AllocationHeader* header)
+  {
+    if (!header->heap_)
+      return std::free(block);
+
+    HeapSlot& slot = s_heaps[header->heap_];
+    std::lock_guard<std::mutex> lock(slot.lock_);
+    TlsfHeap* tlsf = slot.heap_.load(std::memory_order_relaxed);
+    ASSERTF(tlsf && tlsf->Contains(block), "Block %p is not from heap %u", static_cast<void*>(block), header->heap_);
+    tlsf->Deallocate(block, header->tag_);
+  }
+
+  static auto GetBlockSize(char* block, const AllocationHeader* header) -> size_t
+  {
+    if (!header->heap_)
+      return GetUsableSize(block);
+
+    HeapSlot& slot = s_heaps[header->heap_];
+    std::lock_guard<std::mutex> lock(slot.lock_);
+    return slot.heap_.load(std::memory_order_relaxed)->GetBlockSize(block);
+  }
+
+  // Heap gets a free slot, zero is returned when all slots are taken
+
+  static auto AcquireSlot(TlsfHeap* heap) -> uint32_t
+  {
+    std::lock_guard<std::mutex> guard(s_slots_lock);
+    for (uint32_t i = 1; i <= v_max_heaps; ++i)
+    {
+      HeapSlot& slot = s_heaps[i];
+      std::lock_guard<std::mutex> lock(slot.lock_);
+      if (!slot.heap_.load(std::memory_order_relaxed))
+      {
+        slot.heap_.store(heap, std::memory_order_release);
+        return i;
+      }
+    }
+    ASSERTF(false, "No free slot for heap %p, max is %u", static_cast<void*>(heap), v_max_heaps);
+    return 0;
+  }
+
+  // Manager forgets the heap, so no block of it may be alive
+
+  static void ReleaseSlot(uint32_t i)
+  {
+    if (!i)
+      return;
+
+    std::lock_guard<std::mutex> guard(s_slots_lock);
+    HeapSlot& slot = s_heaps[i];
+    std::lock_guard<std::mutex> lock(slot.lock_);
+    [[maybe_unused]] TlsfHeap* heap = slot.heap_.exchange(nullptr, std::memory_order_acq_rel);
+    ASSERTF(heap->GetStats().used_blocks_ == 0, "Heap %p is reset with %zu alive blocks", static_cast<void*>(heap), heap->GetStats().used_blocks_);
+  }
+
+} // namespace gdm::_private
 
 // --public
 
@@ -29,14 +199,17 @@ void* gdm::MemoryManager::AllocateAligned(size_t bytes, size_t align, MemoryTagV
   align = math::Max(align, GetDefaultAlignment());
   ASSERTF(math::IsPowerOfTwo(align), "Alignment %zu is not power of 2", align);
 
-#if defined (_WIN32)
-  void* ptr = _aligned_malloc(bytes, align);
-#else
-  void* ptr = std::aligned_alloc(size, align);
-#endif
+  const size_t overhead = _private::GetOverhead(align);
+  if (bytes > SIZE_MAX - overhead)
+    return nullptr;
 
-  MemoryTracker::GetInstance().AddUsage(tag, GetPointerSize(ptr, align));
-  return ptr;
+  uint32_t heap = 0;
+  char* block = _private::AllocateBlock(bytes + overhead, tag, heap);
+  if (!block)
+    return nullptr;
+
+  MemoryTracker::GetInstance().AddUsage(tag, bytes);
+  return _private::PlaceHeader(block, bytes, align, tag, heap);
 }
 
 void* gdm::MemoryManager::Reallocate(void* ptr, size_t new_bytes, MemoryTagValue tag)
@@ -44,23 +217,58 @@ void* gdm::MemoryManager::Reallocate(void* ptr, size_t new_bytes, MemoryTagValue
   return ReallocateAligned(ptr, new_bytes, GetDefaultAlignment(), tag);
 }
 
+// Tag of allocation is kept. Block is grown in place if it has enough usable
+//  space, otherwise it's reallocated and data is moved only if alignment
+//  offset in the new block differs. Heap blocks are moved to a new block
+
 void* gdm::MemoryManager::ReallocateAligned(void* ptr, size_t new_bytes, size_t align, MemoryTagValue tag)
 {
+  if (!ptr)
+    return AllocateAligned(new_bytes, align, tag);
+
   align = math::Max(align, GetDefaultAlignment());
   ASSERTF(math::IsPowerOfTwo(align), "Alignment %zu is not power of 2", align);
 
-#if defined (_WIN32)
-  MemoryTracker::GetInstance().SubUsage(tag, GetPointerSize(ptr, align));
-  void* new_ptr = _aligned_realloc(ptr, new_bytes, align);
-  MemoryTracker::GetInstance().AddUsage(tag, GetPointerSize(new_ptr, align));
-#else
-  void* new_ptr = Allocate(new_bytes, align);
-  memcpy(new_mem, ptr, GetPointerSize(ptr, align));
-  Deallocate(ptr, align);
-#endif
+  _private::AllocationHeader* header = _private::GetHeader(ptr);
+  const size_t old_bytes = header->size_;
+  const size_t old_offset = header->offset_;
+  tag = header->tag_;
+  char* block = _private::GetBlock(ptr);
 
-  MemoryTracker::GetInstance().AddUsage(tag, GetPointerSize(new_ptr, align));
-  return new_ptr;
+  MemoryTracker::GetInstance().SubUsage(tag, old_bytes);
+  if (reinterpret_cast<uintptr_t>(ptr) % align == 0 && old_offset + new_bytes <= _private::GetBlockSize(block, header))
+  {
+    header->size_ = new_bytes;
+    MemoryTracker::GetInstance().AddUsage(tag, new_bytes);
+    return ptr;
+  }
+
+  if (header->heap_)
+  {
+    MemoryTracker::GetInstance().AddUsage(tag, old_bytes);
+    void* new_ptr = AllocateAligned(new_bytes, align, tag);
+    if (new_ptr)
+    {
+      memcpy(new_ptr, ptr, std::min(old_bytes, new_bytes));
+      DeallocateAligned(ptr, align, tag);
+    }
+    return new_ptr;
+  }
+
+  const size_t overhead = std::max(_private::GetOverhead(align), old_offset);
+  char* new_block = static_cast<char*>(std::realloc(block, new_bytes + overhead));
+  if (!new_block)
+  {
+    MemoryTracker::GetInstance().AddUsage(tag, old_bytes);
+    return nullptr;
+  }
+
+  char* new_ptr = reinterpret_cast<char*>(_private::AlignUp(reinterpret_cast<uintptr_t>(new_block) + sizeof(_private::AllocationHeader), align));
+  if (static_cast<size_t>(new_ptr - new_block) != old_offset)
+    memmove(new_ptr, new_block + old_offset, std::min(old_bytes, new_bytes));
+
+  MemoryTracker::GetInstance().AddUsage(tag, new_bytes);
+  return _private::PlaceHeader(new_block, new_bytes, align, tag, 0);
 }
 
 void gdm::MemoryManager::Deallocate(void* ptr, MemoryTagValue tag)
@@ -68,29 +276,26 @@ void gdm::MemoryManager::Deallocate(void* ptr, MemoryTagValue tag)
   DeallocateAligned(ptr, GetDefaultAlignment(), tag);
 }
 
-void gdm::MemoryManager::DeallocateAligned(void* ptr, size_t align, MemoryTagValue tag)
+// Alignment and tag are taken from the header, arguments are kept for
+//  symmetry with allocation
+
+void gdm::MemoryManager::DeallocateAligned(void* ptr, size_t, MemoryTagValue)
 {
-  MemoryTracker::GetInstance().SubUsage(tag, GetPointerSize(ptr, align));
-#if defined (_WIN32)
-  _aligned_free(ptr);
-#else
-  std::free(mem);
-#endif
+  if (!ptr)
+    return;
+
+  const _private::AllocationHeader* header = _private::GetHeader(ptr);
+  MemoryTracker::GetInstance().SubUsage(header->tag_, header->size_);
+  _private::DeallocateBlock(_private::GetBlock(ptr), header);
 }
 
-size_t gdm::MemoryManager::GetPointerSize(void* ptr, size_t align)
+// Requested size of allocation, not the size of underlying block
+
+size_t gdm::MemoryManager::GetPointerSize(void* ptr, size_t)
 {
   if (!ptr)
     return 0;
-
-  align = math::Max(align, GetDefaultAlignment());
-  ASSERTF(math::IsPowerOfTwo(align), "Alignment %zu is not power of 2", align);
-
-#if defined(_WIN32)
-  return _aligned_msize(ptr, align, 0);
-#else
-  return malloc_usabe_size(ptr);
-#endif
+  return _private::GetHeader(ptr)->size_;
 }
 
 auto gdm::MemoryManager::GetTagUsage(MemoryTagValue tag) -> size_t
@@ -102,3 +307,39 @@ auto gdm::MemoryManager::GetTagName(MemoryTagValue tag) -> const char*
 {
   return MemoryTracker::GetInstance().GetTagName(tag);
 }
+
+// Heap is not owned and is forgotten on reset, so all its blocks must be
+//  freed before. Another heap may be set at any time, blocks keep the slot
+//  of heap they came from
+
+void gdm::MemoryManager::SetHeap(TlsfHeap* heap)
+{
+  const uint32_t slot = heap ? _private::AcquireSlot(heap) : 0;
+  _private::ReleaseSlot(_private::s_heap.exchange(slot, std::memory_order_acq_rel));
+}
+
+auto gdm::MemoryManager::GetHeap() -> TlsfHeap*
+{
+  return _private::s_heaps[_private::s_heap.load(std::memory_order_acquire)].heap_.load(std::memory_order_acquire);
+}
+
+// Same rules as for global heap. Thread must reset its heap before exit,
+//  otherwise heap keeps the slot
+
+void gdm::MemoryManager::SetThreadHeap(TlsfHeap* heap)
+{
+  const uint32_t slot = heap ? _private::AcquireSlot(heap) : 0;
+  _private::ReleaseSlot(std::exchange(_private::t_heap, slot));
+}
+
+auto gdm::MemoryManager::GetThreadHeap() -> TlsfHeap*
+{
+  return _private::s_heaps[_private::t_heap].heap_.load(std::memory_order_acquire);
+}
+
+// Allocations which were taken by malloc since heap had no space
+
+auto gdm::MemoryManager::GetHeapFallbacks() -> size_t
+{
+  return _private::s_heap_fallbacks.load(std::memory_order_relaxed);
+}
@@ -15,6 +15,18 @@ using std::size_t;
 
 namespace gdm {
 
+struct TlsfHeap;
+
+// Every allocation has small header before the pointer with requested size,
+//  tag and alignment offset, so size and tag accounting don't ask the system.
+//  Deallocation and reallocation use the tag stored in header.
+//
+// Blocks are taken by malloc, or from tlsf heap when it's set. Thread may
+//  set own heap which is used before the global one. Header tells where
+//  the block came from, so blocks taken before heap was set are freed to
+//  the system. When heap is exhausted allocation falls back to malloc and
+//  the fallback is counted, see GetHeapFallbacks()
+
 struct MemoryManager
 {
   static auto Allocate(size_t bytes, MemoryTagValue tag = 0) -> void*;
@@ -29,6 +41,13 @@ public:
   static auto GetTagUsage(MemoryTagValue tag) -> size_t;
   static auto GetTagName(MemoryTagValue tag) -> const char*;
 
+public:
+  static void SetHeap(TlsfHeap* heap);
+  static auto GetHeap() -> TlsfHeap*;
+  static void SetThreadHeap(TlsfHeap* heap);
+  static auto GetThreadHeap() -> TlsfHeap*;
+  static auto GetHeapFallbacks() -> size_t;
+
 public:
   constexpr static auto GetDefaultAlignment() -> size_t { return alignof(std::max_align_t); }
 
@@ -15,10 +15,18 @@
 namespace gdm {
 
 struct MemoryManager;
+struct VirtualArena;
+
+namespace _private {
+
+  struct PoolCache;
+
+} // namespace _private
 
 struct MemoryTracker
 {
   static auto GetInstance() -> MemoryTracker&;
+  constexpr static auto GetMaxTags() -> int { return v_max_tags_; }
 
 private:
   auto RegisterTag(const char* name) -> size_t;
@@ -35,6 +43,8 @@ private:
 
 private:
   friend struct MemoryManager;
+  friend struct VirtualArena;
+  friend struct _private::PoolCache;
 
 #ifndef NDEBUG
   template <size_t Value>
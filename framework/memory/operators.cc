@@ -6,10 +6,36 @@
 
 #include "operators.h"
 
+#include <new>
+
 #include "memory/memory_manager.h"
 #include "memory/memory_tag.h"
 
+// All plain forms are replaced, since memory from the manager has a header
+//  and can't be freed by the system (and vice versa)
+
+// Throwing forms never return null, only nothrow forms do
+
 void* operator new(std::size_t size)
+{
+  if (void* ptr = gdm::MemoryManager::Allocate(size))
+    return ptr;
+  throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size)
+{
+  if (void* ptr = gdm::MemoryManager::Allocate(size))
+    return ptr;
+  throw std::bad_alloc{};
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+  return gdm::MemoryManager::Allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
 {
   return gdm::MemoryManager::Allocate(size);
 }
@@ -19,11 +45,36 @@ void* operator new(std::size_t size, gdm::MemoryTagValue tag) noexcept
   return gdm::MemoryManager::Allocate(size, tag);
 }
 
+void operator delete(void* ptr) noexcept
+{
+  return gdm::MemoryManager::Deallocate(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+  return gdm::MemoryManager::Deallocate(ptr);
+}
+
 void operator delete(void* ptr, std::size_t size) noexcept
 {
   return gdm::MemoryManager::Deallocate(ptr);
 }
 
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+  return gdm::MemoryManager::Deallocate(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+  return gdm::MemoryManager::Deallocate(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+  return gdm::MemoryManager::Deallocate(ptr);
+}
+
 void operator delete(void* ptr, std::size_t size, gdm::MemoryTagValue tag) noexcept
 {
   return gdm::MemoryManager::Deallocate(ptr, tag);
@@ -0,0 +1,289 @@
+// *************************************************************
+// File:    pool_allocator.cc
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#include "pool_allocator.h"
+
+#include <memory/memory_tracker.h>
+#include <system/assert_utils.h>
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <cstdlib>
+#include <cstdint>
+#include <algorithm>
+#include <bit>
+#include <utility>
+
+//--private
+
+namespace gdm::_private {
+
+  // Free block keeps the link to the next one in own memory
+
+  struct PoolBlock
+  {
+    PoolBlock* next_;
+  };
+
+  struct PoolList
+  {
+    PoolBlock* head_ = nullptr;
+    uint32_t count_ = 0;
+  };
+
+  constexpr size_t v_pool_step = 16;
+  constexpr size_t v_pool_slab_size = 64 * 1024;
+  constexpr std::array<size_t, 16> v_pool_classes { 16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512 };
+
+  static_assert(v_pool_classes.back() == PoolAllocator::v_max_size);
+
+  // Class index by size rounded up to step, so lookup is one load
+
+  constexpr auto MakeClassIndices()
+  {
+    std::array<uint8_t, PoolAllocator::v_max_size / v_pool_step + 1> indices {};
+    size_t cls = 0;
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+      while (v_pool_classes[cls] < i * v_pool_step)
+        ++cls;
+      indices[i] = static_cast<uint8_t>(cls);
+    }
+    return indices;
+  }
+
+  constexpr auto v_pool_indices = MakeClassIndices();
+
+  static auto GetClassIndex(size_t bytes) -> size_t
+  {
+    return v_pool_indices[(bytes + v_pool_step - 1) / v_pool_step];
+  }
+
+  // Small classes move more blocks at once, about 8 kb per batch
+
+  constexpr auto MakeBatchSizes()
+  {
+    std::array<uint32_t, v_pool_classes.size()> sizes {};
+    for (size_t cls = 0; cls < sizes.size(); ++cls)
+      sizes[cls] = static_cast<uint32_t>(std::clamp<size_t>(8192 / v_pool_classes[cls], 8, 64));
+    return sizes;
+  }
+
+  constexpr auto v_pool_batch_sizes = MakeBatchSizes();
+
+  static auto GetBatchSize(size_t cls) -> uint32_t
+  {
+    return v_pool_batch_sizes[cls];
+  }
+
+  // Global storage of one class. Batches are lists of blocks returned by
+  //  threads or carved from new slab
+
+  struct PoolDepot
+  {
+    std::mutex lock_;
+    std::vector<PoolList> batches_;
+    std::vector<void*> slabs_;
+  };
+
+  struct PoolDepots
+  {
+    std::array<PoolDepot, v_pool_classes.size()> depots_;
+    std::atomic<size_t> reserved_ {0};
+  };
+
+  // Never destroyed, since thread caches return blocks at thread exit which
+  //  may happen after static destructors
+
+  static auto GetDepots() -> PoolDepots&
+  {
+    static PoolDepots* s_depots = new PoolDepots();
+    return *s_depots;
+  }
+
+  static void CarveSlab(PoolDepots& depots, size_t cls)
+  {
+    const size_t size = v_pool_classes[cls];
+    const uint32_t batch = GetBatchSize(cls);
+    const size_t slab_size = std::max(v_pool_slab_size, size * batch);
+    char* slab = static_cast<char*>(std::malloc(slab_size));
+    ASSERTF(slab, "Failed to allocate pool slab of %zu bytes", slab_size);
+
+    PoolDepot& depot = depots.depots_[cls];
+    depot.slabs_.push_back(slab);
+    depots.reserved_.fetch_add(slab_size, std::memory_order_relaxed);
+
+    PoolList list {};
+    for (size_t offset = slab_size / size * size; offset != 0; offset -= size)
+    {
+      PoolBlock* block = reinterpret_cast<PoolBlock*>(slab + offset - size);
+      block->next_ = list.head_;
+      list.head_ = block;
+      if (++list.count_ == batch)
+      {
+        depot.batches_.push_back(list);
+        list = {};
+      }
+    }
+    if (list.count_)
+      depot.batches_.push_back(list);
+  }
+
+  static auto FetchBatch(size_t cls) -> PoolList
+  {
+    PoolDepots& depots = GetDepots();
+    PoolDepot& depot = depots.depots_[cls];
+    std::lock_guard<std::mutex> lock(depot.lock_);
+    if (depot.batches_.empty())
+      CarveSlab(depots, cls);
+    PoolList batch = depot.batches_.back();
+    depot.batches_.pop_back();
+    return batch;
+  }
+
+  static void ReturnBatch(size_t cls, PoolList batch)
+  {
+    PoolDepot& depot = GetDepots().depots_[cls];
+    std::lock_guard<std::mutex> lock(depot.lock_);
+    depot.batches_.push_back(batch);
+  }
+
+  // Thread cache keeps up to two batches per class, so alloc/free ping-pong
+  //  on the batch border doesn't touch the depot each time. Tag usage is
+  //  accumulated here too and goes to shared tracker only with batches
+
+  struct PoolCache
+  {
+    ~PoolCache() { Flush(); }
+
+    auto Pop(size_t cls) -> PoolBlock*
+    {
+      PoolList& list = lists_[cls];
+      if (!list.head_)
+      {
+        FlushUsage();
+        list = FetchBatch(cls);
+      }
+      PoolBlock* block = list.head_;
+      list.head_ = block->next_;
+      --list.count_;
+      return block;
+    }
+
+    void Push(size_t cls, PoolBlock* block)
+    {
+      PoolList& list = lists_[cls];
+      block->next_ = list.head_;
+      list.head_ = block;
+      const uint32_t batch = GetBatchSize(cls);
+      if (++list.count_ < batch * 2)
+        return;
+
+      PoolList surplus { list.head_, batch };
+      PoolBlock* last = list.head_;
+      for (uint32_t i = 1; i < batch; ++i)
+        last = last->next_;
+      list.head_ = last->next_;
+      list.count_ -= batch;
+      last->next_ = nullptr;
+      FlushUsage();
+      ReturnBatch(cls, surplus);
+    }
+
+    void Flush()
+    {
+      FlushUsage();
+      for (size_t cls = 0; cls < lists_.size(); ++cls)
+      {
+        if (lists_[cls].head_)
+          ReturnBatch(cls, lists_[cls]);
+        lists_[cls] = {};
+      }
+    }
+
+    // Delta may be negative when thread frees blocks allocated by others
+
+    void AddUsage(MemoryTagValue tag, int64_t bytes)
+    {
+      ASSERTF(tag >= 0 && tag < MemoryTracker::GetMaxTags(), "Invalid memory tag %d", tag);
+      usage_[tag] += bytes;
+      dirty_tags_ |= 1u << tag;
+    }
+
+    void FlushUsage()
+    {
+      MemoryTracker& tracker = MemoryTracker::GetInstance();
+      for (; dirty_tags_; dirty_tags_ &= dirty_tags_ - 1)
+      {
+        const int tag = std::countr_zero(dirty_tags_);
+        const int64_t bytes = std::exchange(usage_[tag], 0);
+        if (bytes > 0)
+          tracker.AddUsage(tag, static_cast<size_t>(bytes));
+        else if (bytes < 0)
+          tracker.SubUsage(tag, static_cast<size_t>(-bytes));
+      }
+    }
+
+    std::array<PoolList, v_pool_classes.size()> lists_ {};
+    std::array<int64_t, MemoryTracker::GetMaxTags()> usage_ {};
+    uint32_t dirty_tags_ = 0;
+  };
+
+  static_assert(MemoryTracker::GetMaxTags() <= 32, "Dirty tags should fit into mask");
+
+  static thread_local PoolCache t_pool_cache;
+
+} // namespace gdm::_private
+
+// --public
+
+void* gdm::PoolAllocator::Allocate(size_t bytes, MemoryTagValue tag)
+{
+  if (bytes > v_max_size)
+    return MemoryManager::Allocate(bytes, tag);
+
+  const size_t cls = _private::GetClassIndex(bytes);
+  _private::t_pool_cache.AddUsage(tag, static_cast<int64_t>(_private::v_pool_classes[cls]));
+  return _private::t_pool_cache.Pop(cls);
+}
+
+// Block may be freed by any thread, it goes to the cache of freeing one
+
+void gdm::PoolAllocator::Deallocate(void* ptr, size_t bytes, MemoryTagValue tag)
+{
+  if (!ptr)
+    return;
+  if (bytes > v_max_size)
+    return MemoryManager::Deallocate(ptr, tag);
+
+  const size_t cls = _private::GetClassIndex(bytes);
+  _private::t_pool_cache.AddUsage(tag, -static_cast<int64_t>(_private::v_pool_classes[cls]));
+  _private::t_pool_cache.Push(cls, static_cast<_private::PoolBlock*>(ptr));
+}
+
+void gdm::PoolAllocator::FlushThreadCache()
+{
+  _private::t_pool_cache.Flush();
+}
+
+void gdm::PoolAllocator::FlushTagUsage()
+{
+  _private::t_pool_cache.FlushUsage();
+}
+
+// Zero when size isn't served by pool
+
+size_t gdm::PoolAllocator::GetClassSize(size_t bytes)
+{
+  return bytes > v_max_size ? 0 : _private::v_pool_classes[_private::GetClassIndex(bytes)];
+}
+
+size_t gdm::PoolAllocator::GetReservedSize()
+{
+  return _private::GetDepots().reserved_.load(std::memory_order_relaxed);
+}
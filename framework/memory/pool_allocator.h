@@ -0,0 +1,74 @@
+// *************************************************************
+// File:    pool_allocator.h
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#ifndef AH_GDM_POOL_ALLOCATOR_H
+#define AH_GDM_POOL_ALLOCATOR_H
+
+#include "memory/memory_manager.h"
+#include "memory/memory_tag_value.h"
+
+namespace gdm {
+
+// Allocator of small objects with size classes. Each thread takes blocks from
+//  own cache without locks, cache is refilled from global depot and returns
+//  surplus to it by batches. Memory is taken by slabs and is never returned
+//  to the system. Requests bigger than max class go to memory manager.
+//  Blocks have default alignment, usage is counted in tags by class size.
+//  Thread keeps usage deltas in own cache and passes them to tracker with
+//  batch transfers, FlushTagUsage() makes tags of the thread exact
+
+struct PoolAllocator
+{
+  static auto Allocate(size_t bytes, MemoryTagValue tag = 0) -> void*;
+  static void Deallocate(void* ptr, size_t bytes, MemoryTagValue tag = 0);
+
+  template <class T, class...Args>
+  static auto New(MemoryTagValue tag, Args&&...args) -> T*;
+  template <class T>
+  static void Delete(T* ptr, MemoryTagValue tag = 0);
+
+  static void FlushThreadCache();
+  static void FlushTagUsage();
+  static auto GetClassSize(size_t bytes) -> size_t;
+  static auto GetReservedSize() -> size_t;
+
+  constexpr static size_t v_max_size = 512;
+
+}; // struct PoolAllocator
+
+template <class T>
+struct PoolAllocatorTyped
+{
+  PoolAllocatorTyped(MemoryTagValue tag = 0) noexcept : tag_{tag} { }
+  template <class U>
+  PoolAllocatorTyped(const PoolAllocatorTyped<U>& other) noexcept : tag_{other.GetTag()} { }
+
+  auto GetTag() const -> MemoryTagValue { return tag_; }
+
+private:
+  MemoryTagValue tag_;
+
+  // stl stuff
+
+public:
+  using value_type = T;
+
+  template <class U>
+  struct rebind
+  {
+    using other = PoolAllocatorTyped<U>;
+  };
+
+  auto allocate(size_t num) -> T*;
+  void deallocate(T* ptr, size_t num);
+
+}; // struct PoolAllocatorTyped
+
+} // namespace gdm
+
+#include "memory/pool_allocator.inl"
+
+#endif // AH_GDM_POOL_ALLOCATOR_H
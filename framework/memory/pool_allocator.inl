@@ -0,0 +1,62 @@
+// *************************************************************
+// File:    pool_allocator.inl
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#include "memory/pool_allocator.h"
+
+#include <new>
+#include <utility>
+
+// --public
+
+template <class T, class...Args>
+inline auto gdm::PoolAllocator::New(MemoryTagValue tag, Args&&...args) -> T*
+{
+  static_assert(alignof(T) <= MemoryManager::GetDefaultAlignment());
+
+  void* ptr = Allocate(sizeof(T), tag);
+  return new (ptr) T(std::forward<Args>(args)...);
+}
+
+template <class T>
+inline void gdm::PoolAllocator::Delete(T* ptr, MemoryTagValue tag)
+{
+  if (!ptr)
+    return;
+  ptr->~T();
+  Deallocate(ptr, sizeof(T), tag);
+}
+
+// --public stl
+
+template <class T>
+auto gdm::PoolAllocatorTyped<T>::allocate(size_t num) -> T*
+{
+  static_assert(alignof(T) <= MemoryManager::GetDefaultAlignment());
+
+  return static_cast<T*>(PoolAllocator::Allocate(sizeof(T) * num, tag_));
+}
+
+template <class T>
+void gdm::PoolAllocatorTyped<T>::deallocate(T* ptr, size_t num)
+{
+  PoolAllocator::Deallocate(ptr, sizeof(T) * num, tag_);
+}
+
+namespace gdm {
+
+template<class T1, class T2>
+bool operator==(const PoolAllocatorTyped<T1>& lhs, const PoolAllocatorTyped<T2>& rhs) noexcept
+{
+  return lhs.GetTag() == rhs.GetTag();
+}
+
+template<class T1, class T2>
+bool operator!=(const PoolAllocatorTyped<T1>& lhs, const PoolAllocatorTyped<T2>& rhs) noexcept
+{
+  return lhs.GetTag() != rhs.GetTag();
+}
+
+} // namespace gdm
@@ -0,0 +1,76 @@
+// *************************************************************
+// File:    stack_allocator.cc
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#include "stack_allocator.h"
+
+#include <cstring>
+
+#include "math/general.h"
+#include "system/assert_utils.h"
+#include "memory/helpers.h"
+
+// --private
+
+namespace gdm::_private {
+
+  static auto GetRoundedSize(size_t bytes) -> size_t
+  {
+    const size_t mask = MemoryManager::GetDefaultAlignment() - 1;
+    return (bytes + mask) & ~mask;
+  }
+
+} // namespace gdm::_private
+
+using gdm::_private::GetRoundedSize;
+
+// --public
+
+gdm::StackAllocator::StackAllocator(size_t size, MemoryTagValue tag)
+  : buffer_{static_cast<char*>(MemoryManager::AllocateAligned(size, 64, tag))}
+  , size_{size}
+  , offset_{0}
+  , tag_{tag}
+{ }
+
+gdm::StackAllocator::~StackAllocator()
+{
+  MemoryManager::DeallocateAligned(buffer_, 64, tag_);
+}
+
+// Returns nullptr when there is no space left. Size is rounded up to default
+//  alignment, so following allocation starts right at the end of this one
+
+void* gdm::StackAllocator::Allocate(size_t bytes, size_t align)
+{
+  ASSERTF(math::IsPowerOfTwo(align), "Alignment %zu is not power of 2", align);
+
+  const uintptr_t base = mem::PtrToUptr(buffer_);
+  const uintptr_t ptr = mem::AlignAddress(base + offset_, align);
+  const size_t end = ptr - base + GetRoundedSize(bytes);
+  if (end > size_)
+    return nullptr;
+
+  offset_ = end;
+  return mem::UptrToPtr(ptr);
+}
+
+// Only the top allocation is released. Padding of over aligned allocation
+//  stays till marker
+
+void gdm::StackAllocator::Deallocate(void* ptr, size_t bytes)
+{
+  if (static_cast<char*>(ptr) + GetRoundedSize(bytes) == buffer_ + offset_)
+    offset_ = static_cast<size_t>(static_cast<char*>(ptr) - buffer_);
+}
+
+void gdm::StackAllocator::FreeToMarker(Marker marker)
+{
+  ASSERTF(marker <= offset_, "Marker %zu is above the top %zu", marker, offset_);
+#ifndef NDEBUG
+  memset(buffer_ + marker, 0xcd, offset_ - marker);
+#endif
+  offset_ = marker;
+}
@@ -0,0 +1,92 @@
+// *************************************************************
+// File:    stack_allocator.h
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#ifndef AH_GDM_STACK_ALLOCATOR_H
+#define AH_GDM_STACK_ALLOCATOR_H
+
+#include "memory/memory_manager.h"
+
+namespace gdm {
+
+// Bump allocator over one buffer. Memory is released in bulk by returning to
+//  saved marker, the top allocation may be freed separately (so freeing in
+//  reverse order releases everything), others are freed with their marker
+
+struct StackAllocator
+{
+  using Marker = size_t;
+
+  explicit StackAllocator(size_t size, MemoryTagValue tag = 0);
+  StackAllocator(const StackAllocator&) = delete;
+  StackAllocator& operator=(const StackAllocator&) = delete;
+  ~StackAllocator();
+
+  auto Allocate(size_t bytes, size_t align = MemoryManager::GetDefaultAlignment()) -> void*;
+  void Deallocate(void* ptr, size_t bytes);
+  auto GetMarker() const -> Marker { return offset_; }
+  void FreeToMarker(Marker marker);
+  void Reset() { FreeToMarker(0); }
+
+  auto GetUsed() const -> size_t { return offset_; }
+  auto GetSize() const -> size_t { return size_; }
+
+private:
+  char* buffer_;
+  size_t size_;
+  size_t offset_;
+  MemoryTagValue tag_;
+
+}; // struct StackAllocator
+
+// Saves marker on construction and frees everything allocated after it on
+//  destruction
+
+struct StackScope
+{
+  explicit StackScope(StackAllocator& stack) : stack_{stack}, marker_{stack.GetMarker()} { }
+  StackScope(const StackScope&) = delete;
+  StackScope& operator=(const StackScope&) = delete;
+  ~StackScope() { stack_.FreeToMarker(marker_); }
+
+private:
+  StackAllocator& stack_;
+  StackAllocator::Marker marker_;
+
+}; // struct StackScope
+
+template <class T>
+struct StackAllocatorTyped
+{
+  StackAllocatorTyped(StackAllocator& stack) noexcept : stack_{&stack} { }
+  template <class U>
+  StackAllocatorTyped(const StackAllocatorTyped<U>& other) noexcept : stack_{other.GetStack()} { }
+
+  auto GetStack() const -> StackAllocator* { return stack_; }
+
+private:
+  StackAllocator* stack_;
+
+  // stl stuff
+
+public:
+  using value_type = T;
+
+  template <class U>
+  struct rebind
+  {
+    using other = StackAllocatorTyped<U>;
+  };
+
+  auto allocate(size_t num) -> T*;
+  void deallocate(T* ptr, size_t num);
+
+}; // struct StackAllocatorTyped
+
+} // namespace gdm
+
+#include "memory/stack_allocator.inl"
+
+#endif // AH_GDM_STACK_ALLOCATOR_H
@@ -0,0 +1,42 @@
+// *************************************************************
+// File:    stack_allocator.inl
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#include "memory/stack_allocator.h"
+
+#include <new>
+
+// --public stl
+
+template <class T>
+auto gdm::StackAllocatorTyped<T>::allocate(size_t num) -> T*
+{
+  void* ptr = stack_->Allocate(sizeof(T) * num, alignof(T));
+  if (!ptr)
+    throw std::bad_alloc{};
+  return static_cast<T*>(ptr);
+}
+
+template <class T>
+void gdm::StackAllocatorTyped<T>::deallocate(T* ptr, size_t num)
+{
+  stack_->Deallocate(ptr, sizeof(T) * num);
+}
+
+namespace gdm {
+
+template<class T1, class T2>
+bool operator==(const StackAllocatorTyped<T1>& lhs, const StackAllocatorTyped<T2>& rhs) noexcept
+{
+  return lhs.GetStack() == rhs.GetStack();
+}
+
+template<class T1, class T2>
+bool operator!=(const StackAllocatorTyped<T1>& lhs, const StackAllocatorTyped<T2>& rhs) noexcept
+{
+  return lhs.GetStack() != rhs.GetStack();
+}
+
+} // namespace gdm
@@ -0,0 +1,341 @@
+// *************************************************************
+// File:    tlsf_heap.cc
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#include "tlsf_heap.h"
+
+#include <system/assert_utils.h>
+#include <math/general.h>
+#include <memory/helpers.h>
+
+#include <bit>
+#include <cstdlib>
+#include <algorithm>
+
+//--private
+
+namespace gdm::_private {
+
+  // Header of physical block. Size is of payload, lowest bit marks free
+  //  block. Free block keeps links of its size class list in the payload
+
+  struct TlsfBlock
+  {
+    size_t size_;
+    TlsfBlock* prev_phys_;
+    TlsfBlock* next_free_;
+    TlsfBlock* prev_free_;
+  };
+
+  constexpr size_t v_tlsf_align = MemoryManager::GetDefaultAlignment();
+  constexpr size_t v_tlsf_header = offsetof(TlsfBlock, next_free_);
+  constexpr size_t v_tlsf_min_payload = sizeof(TlsfBlock) - v_tlsf_header;
+  constexpr size_t v_tlsf_free_bit = 1;
+
+  static_assert(v_tlsf_header % v_tlsf_align == 0);
+  static_assert(v_tlsf_min_payload % v_tlsf_align == 0);
+
+  static auto AlignSize(size_t size) -> size_t
+  {
+    return (size + v_tlsf_align - 1) & ~(v_tlsf_align - 1);
+  }
+
+  static auto GetSize(const TlsfBlock* block) -> size_t
+  {
+    return block->size_ & ~v_tlsf_free_bit;
+  }
+
+  static bool IsFree(const TlsfBlock* block)
+  {
+    return block->size_ & v_tlsf_free_bit;
+  }
+
+  static void SetSize(TlsfBlock* block, size_t size, bool free)
+  {
+    block->size_ = size | (free ? v_tlsf_free_bit : 0);
+  }
+
+  static auto GetPayload(TlsfBlock* block) -> char*
+  {
+    return reinterpret_cast<char*>(block) + v_tlsf_header;
+  }
+
+  static auto GetBlock(void* ptr) -> TlsfBlock*
+  {
+    return reinterpret_cast<TlsfBlock*>(static_cast<char*>(ptr) - v_tlsf_header);
+  }
+
+  static auto GetNext(TlsfBlock* block) -> TlsfBlock*
+  {
+    return reinterpret_cast<TlsfBlock*>(GetPayload(block) + GetSize(block));
+  }
+
+  // Block goes after the previous one, so the next one points back to it
+
+  static auto MergeNext(TlsfBlock* block) -> TlsfBlock*
+  {
+    TlsfBlock* next = GetNext(block);
+    SetSize(block, GetSize(block) + v_tlsf_header + GetSize(next), IsFree(block));
+    GetNext(block)->prev_phys_ = block;
+    return block;
+  }
+
+} // namespace gdm::_private
+
+// Pool ends with sentinel block of zero size which is never free, so the
+//  last real block always has the next one
+
+gdm::TlsfHeap::TlsfHeap(size_t size)
+  : memory_{static_cast<char*>(std::malloc(size))}
+  , size_{size}
+  , first_{nullptr}
+  , fl_bitmap_{0}
+  , sl_bitmaps_{}
+  , blocks_{}
+  , tag_usage_{}
+{
+  using namespace _private;
+
+  ASSERTF(memory_, "Failed to allocate heap of %zu bytes", size);
+  ASSERTF(size >= 4 * sizeof(TlsfBlock), "Heap size %zu is too small", size);
+
+  char* begin = reinterpret_cast<char*>(AlignSize(reinterpret_cast<uintptr_t>(memory_)));
+  char* end = reinterpret_cast<char*>(reinterpret_cast<uintptr_t>(memory_ + size) & ~(v_tlsf_align - 1));
+  const size_t payload = std::min<size_t>(end - begin - 2 * v_tlsf_header, (size_t{1} << v_fl_max) - v_tlsf_align);
+
+  first_ = reinterpret_cast<TlsfBlock*>(begin);
+  first_->prev_phys_ = nullptr;
+  SetSize(first_, payload, true);
+
+  TlsfBlock* sentinel = GetNext(first_);
+  sentinel->prev_phys_ = first_;
+  SetSize(sentinel, 0, false);
+
+  Insert(first_);
+}
+
+gdm::TlsfHeap::~TlsfHeap()
+{
+  std::free(memory_);
+}
+
+// Alignment bigger than default is served by taking bigger block and cutting
+//  off its front, which must be big enough to be a free block itself
+
+void* gdm::TlsfHeap::Allocate(size_t bytes, size_t align, MemoryTagValue tag)
+{
+  using namespace _private;
+
+  ASSERTF(math::IsPowerOfTwo(align), "Alignment %zu is not power of 2", align);
+
+  const size_t size = std::max(AlignSize(bytes), v_tlsf_min_payload);
+  const size_t min_gap = v_tlsf_header + v_tlsf_min_payload;
+  const bool over_aligned = align > v_tlsf_align;
+
+  TlsfBlock* block = FindFree(over_aligned ? size + align + min_gap : size);
+  if (!block)
+    return nullptr;
+  Remove(block);
+
+  if (over_aligned)
+  {
+    const uintptr_t payload = reinterpret_cast<uintptr_t>(GetPayload(block));
+    size_t gap = mem::AlignAddress(payload, align) - payload;
+    if (gap && gap < min_gap)
+      gap = mem::AlignAddress(payload + min_gap, align) - payload;
+    if (gap)
+      block = SplitFront(block, gap);
+  }
+  SplitBack(block, size);
+  SetSize(block, GetSize(block), false);
+
+  ASSERTF(tag < static_cast<MemoryTagValue>(tag_usage_.size()), "Tag %d is out of range", tag);
+  tag_usage_[tag] += GetSize(block);
+  return GetPayload(block);
+}
+
+void gdm::TlsfHeap::Deallocate(void* ptr, MemoryTagValue tag)
+{
+  using namespace _private;
+
+  if (!ptr)
+    return;
+
+  TlsfBlock* block = GetBlock(ptr);
+  ASSERTF(!IsFree(block), "Double free of %p", ptr);
+  ASSERTF(tag < static_cast<MemoryTagValue>(tag_usage_.size()), "Tag %d is out of range", tag);
+  tag_usage_[tag] -= GetSize(block);
+  SetSize(block, GetSize(block), true);
+
+  TlsfBlock* prev = block->prev_phys_;
+  if (prev && IsFree(prev))
+  {
+    Remove(prev);
+    block = MergeNext(prev);
+  }
+  TlsfBlock* next = GetNext(block);
+  if (IsFree(next))
+  {
+    Remove(next);
+    MergeNext(block);
+  }
+  Insert(block);
+}
+
+// Payload size of block, may be bigger than requested
+
+size_t gdm::TlsfHeap::GetBlockSize(void* ptr) const
+{
+  return _private::GetSize(_private::GetBlock(ptr));
+}
+
+size_t gdm::TlsfHeap::GetTagUsage(MemoryTagValue tag) const
+{
+  return tag_usage_[tag];
+}
+
+// Walks all blocks, fragmentation is the part of free memory that can't be
+//  taken by one allocation
+
+auto gdm::TlsfHeap::GetStats() const -> TlsfStats
+{
+  using namespace _private;
+
+  TlsfStats stats {};
+  for (TlsfBlock* block = first_; GetSize(block); block = GetNext(block))
+  {
+    const size_t size = GetSize(block);
+    stats.size_ += size;
+    if (IsFree(block))
+    {
+      stats.free_ += size;
+      stats.largest_free_ = std::max(stats.largest_free_, size);
+      ++stats.free_blocks_;
+    }
+    else
+    {
+      stats.used_ += size;
+      ++stats.used_blocks_;
+    }
+  }
+  stats.fragmentation_ = stats.free_ ? 1.f - float(stats.largest_free_) / float(stats.free_) : 0.f;
+  return stats;
+}
+
+bool gdm::TlsfHeap::Contains(void* ptr) const
+{
+  return static_cast<char*>(ptr) >= memory_ && static_cast<char*>(ptr) < memory_ + size_;
+}
+
+// --private
+
+// Sizes less than the first level shift are split linearly by alignment step
+
+void gdm::TlsfHeap::GetIndices(size_t size, int& fl, int& sl)
+{
+  if (size < (size_t{1} << v_fl_shift))
+  {
+    fl = 0;
+    sl = static_cast<int>(size >> v_align_log2);
+  }
+  else
+  {
+    const int bit = static_cast<int>(std::bit_width(size)) - 1;
+    fl = bit - v_fl_shift + 1;
+    sl = static_cast<int>(size >> (bit - v_sl_log2)) ^ v_sl_count;
+  }
+}
+
+void gdm::TlsfHeap::Insert(_private::TlsfBlock* block)
+{
+  int fl, sl;
+  GetIndices(_private::GetSize(block), fl, sl);
+
+  _private::TlsfBlock* head = blocks_[fl][sl];
+  block->prev_free_ = nullptr;
+  block->next_free_ = head;
+  if (head)
+    head->prev_free_ = block;
+  blocks_[fl][sl] = block;
+  fl_bitmap_ |= 1u << fl;
+  sl_bitmaps_[fl] |= 1u << sl;
+}
+
+void gdm::TlsfHeap::Remove(_private::TlsfBlock* block)
+{
+  int fl, sl;
+  GetIndices(_private::GetSize(block), fl, sl);
+
+  if (block->prev_free_)
+    block->prev_free_->next_free_ = block->next_free_;
+  else
+    blocks_[fl][sl] = block->next_free_;
+  if (block->next_free_)
+    block->next_free_->prev_free_ = block->prev_free_;
+
+  if (!blocks_[fl][sl])
+  {
+    sl_bitmaps_[fl] &= ~(1u << sl);
+    if (!sl_bitmaps_[fl])
+      fl_bitmap_ &= ~(1u << fl);
+  }
+}
+
+// Size is rounded up to the next class, so any block of found class fits
+//  and there is no search inside the list
+
+auto gdm::TlsfHeap::FindFree(size_t size) -> _private::TlsfBlock*
+{
+  if (size >= (size_t{1} << v_fl_shift))
+    size += (size_t{1} << (std::bit_width(size) - 1 - v_sl_log2)) - 1;
+  if (size >= (size_t{1} << v_fl_max))
+    return nullptr;
+
+  int fl, sl;
+  GetIndices(size, fl, sl);
+
+  uint32_t sl_map = sl_bitmaps_[fl] & (~0u << sl);
+  if (!sl_map)
+  {
+    const uint32_t fl_map = fl + 1 < 32 ? fl_bitmap_ & (~0u << (fl + 1)) : 0;
+    if (!fl_map)
+      return nullptr;
+    fl = std::countr_zero(fl_map);
+    sl_map = sl_bitmaps_[fl];
+  }
+  return blocks_[fl][std::countr_zero(sl_map)];
+}
+
+// Tail which is big enough to be a block is returned to the free lists. Next
+//  block is never free here, since free neighbours are always merged
+
+void gdm::TlsfHeap::SplitBack(_private::TlsfBlock* block, size_t size)
+{
+  using namespace _private;
+
+  const size_t block_size = GetSize(block);
+  if (block_size < size + v_tlsf_header + v_tlsf_min_payload)
+    return;
+
+  TlsfBlock* rest = reinterpret_cast<TlsfBlock*>(GetPayload(block) + size);
+  rest->prev_phys_ = block;
+  SetSize(rest, block_size - size - v_tlsf_header, true);
+  GetNext(rest)->prev_phys_ = rest;
+  SetSize(block, size, IsFree(block));
+  Insert(rest);
+}
+
+auto gdm::TlsfHeap::SplitFront(_private::TlsfBlock* block, size_t gap) -> _private::TlsfBlock*
+{
+  using namespace _private;
+
+  TlsfBlock* rest = reinterpret_cast<TlsfBlock*>(reinterpret_cast<char*>(block) + gap);
+  rest->prev_phys_ = block;
+  SetSize(rest, GetSize(block) - gap, true);
+  GetNext(rest)->prev_phys_ = rest;
+  SetSize(block, gap - v_tlsf_header, true);
+  Insert(block);
+  return rest;
+}
@@ -0,0 +1,85 @@
+// *************************************************************
+// File:    tlsf_heap.h
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#ifndef AH_GDM_TLSF_HEAP_H
+#define AH_GDM_TLSF_HEAP_H
+
+#include <array>
+#include <cstdint>
+
+#include "memory/memory_manager.h"
+#include "memory/memory_tracker.h"
+#include "memory/memory_tag_value.h"
+
+namespace gdm {
+
+namespace _private {
+
+  struct TlsfBlock;
+
+} // namespace _private
+
+struct TlsfStats
+{
+  size_t size_;
+  size_t used_;
+  size_t free_;
+  size_t largest_free_;
+  size_t used_blocks_;
+  size_t free_blocks_;
+  float fragmentation_;
+
+}; // struct TlsfStats
+
+// Two level segregated fit heap over one fixed block of memory. Free blocks
+//  are kept in lists by size class, first level is power of two and second
+//  splits it linearly, so allocation and deallocation are O(1) by bitmap
+//  search. Neighbour free blocks are merged immediately. Not thread safe
+
+struct TlsfHeap
+{
+  explicit TlsfHeap(size_t size);
+  TlsfHeap(const TlsfHeap&) = delete;
+  TlsfHeap& operator=(const TlsfHeap&) = delete;
+  ~TlsfHeap();
+
+  auto Allocate(size_t bytes, size_t align = MemoryManager::GetDefaultAlignment(), MemoryTagValue tag = 0) -> void*;
+  void Deallocate(void* ptr, MemoryTagValue tag = 0);
+
+  auto GetBlockSize(void* ptr) const -> size_t;
+  auto GetTagUsage(MemoryTagValue tag) const -> size_t;
+  auto GetStats() const -> TlsfStats;
+  bool Contains(void* ptr) const;
+
+private:
+  constexpr static int v_align_log2 = 4;
+  constexpr static int v_sl_log2 = 5;
+  constexpr static int v_sl_count = 1 << v_sl_log2;
+  constexpr static int v_fl_shift = v_sl_log2 + v_align_log2;
+  constexpr static int v_fl_max = 40;
+  constexpr static int v_fl_count = v_fl_max - v_fl_shift + 1;
+
+  static void GetIndices(size_t size, int& fl, int& sl);
+  void Insert(_private::TlsfBlock* block);
+  void Remove(_private::TlsfBlock* block);
+  auto FindFree(size_t size) -> _private::TlsfBlock*;
+  void SplitBack(_private::TlsfBlock* block, size_t size);
+  auto SplitFront(_private::TlsfBlock* block, size_t gap) -> _private::TlsfBlock*;
+
+private:
+  char* memory_;
+  size_t size_;
+  _private::TlsfBlock* first_;
+  uint32_t fl_bitmap_;
+  std::array<uint32_t, v_fl_count> sl_bitmaps_;
+  std::array<std::array<_private::TlsfBlock*, v_sl_count>, v_fl_count> blocks_;
+  std::array<size_t, MemoryTracker::GetMaxTags()> tag_usage_;
+
+}; // struct TlsfHeap
+
+} // namespace gdm
+
+#endif // AH_GDM_TLSF_HEAP_H
@@ -0,0 +1,243 @@
+// *************************************************************
+// File:    huge_bench.cc
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+// Usage: huge_bench [arena_mb] [repeats] [accesses_m]
+
+// Random access over big arena with default and huge pages. Pointer chase
+//  measures latency, random gather measures throughput. Tlb misses per access
+//  are read from perf counters when they are available (-1 otherwise), and
+//  huge_kb is how much of arena kernel really backed by huge pages
+
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#if defined (__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "memory/virtual_arena.h"
+
+struct BenchSettings
+{
+  size_t arena_mb = 1024;
+  int repeats = 5;
+  size_t accesses = 1 << 24;
+} g_bench_settings;
+
+struct Sample
+{
+  double ns_;
+  double tlb_misses_;
+};
+
+static double TIME_NOW_NS()
+{
+  return std::chrono::duration<double, std::nano>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static const char* PAGES_NAME(gdm::VirtualArena::EPages pages)
+{
+  switch (pages)
+  {
+    case gdm::VirtualArena::PAGES_HUGE : return "huge";
+    case gdm::VirtualArena::PAGES_TRANSPARENT_HUGE : return "transparent";
+    default : return "default";
+  }
+}
+
+// Counter of data tlb read misses of this thread, -1 if perf is not allowed
+
+struct TlbCounter
+{
+  TlbCounter()
+  {
+#if defined (__linux__)
+    perf_event_attr attr {};
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+  }
+
+  ~TlbCounter()
+  {
+#if defined (__linux__)
+    if (fd_ >= 0)
+      close(fd_);
+#endif
+  }
+
+  void Start()
+  {
+#if defined (__linux__)
+    if (fd_ >= 0)
+    {
+      ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+  }
+
+  auto Stop() -> long long
+  {
+    long long count = -1;
+#if defined (__linux__)
+    if (fd_ >= 0)
+    {
+      ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+      if (read(fd_, &count, sizeof(count)) != sizeof(count))
+        count = -1;
+    }
+#endif
+    return count;
+  }
+
+  int fd_ = -1;
+};
+
+// Sum of AnonHugePages of mappings inside the range
+
+static auto GetHugeKb(const char* begin, size_t size) -> long long
+{
+  long long total = -1;
+#if defined (__linux__)
+  FILE* file = fopen("/proc/self/smaps", "r");
+  if (!file)
+    return total;
+  total = 0;
+  char line[256];
+  bool inside = false;
+  while (fgets(line, sizeof(line), file))
+  {
+    uintptr_t from = 0, to = 0;
+    long long kb = 0;
+    if (sscanf(line, "%lx-%lx ", &from, &to) == 2)
+      inside = from >= reinterpret_cast<uintptr_t>(begin) && to <= reinterpret_cast<uintptr_t>(begin) + size;
+    else if (inside && sscanf(line, "AnonHugePages: %lld kB", &kb) == 1)
+      total += kb;
+  }
+  fclose(file);
+#endif
+  (void)begin;
+  (void)size;
+  return total;
+}
+
+// Single cycle over all cache lines, so every step is a miss in random page
+
+static void FillChase(uint64_t* data, size_t count)
+{
+  const size_t step = 64 / sizeof(uint64_t);
+  const size_t lines = count / step;
+  std::vector<uint32_t> order (lines);
+  std::iota(order.begin(), order.end(), 0);
+  std::mt19937_64 rng (42);
+  for (size_t i = lines - 1; i > 0; --i)
+    std::swap(order[i], order[rng() % i]);
+  for (size_t i = 0; i < lines; ++i)
+    data[order[i] * step] = static_cast<uint64_t>(order[(i + 1) % lines]) * step;
+}
+
+static auto sample_chase(const uint64_t* data, TlbCounter& tlb) -> Sample
+{
+  uint64_t index = 0;
+  tlb.Start();
+  const double start = TIME_NOW_NS();
+  for (size_t i = 0; i < g_bench_settings.accesses; ++i)
+    index = data[index];
+  const double ns = TIME_NOW_NS() - start;
+  const long long misses = tlb.Stop();
+  if (index == ~0ull)
+    printf("unreachable\n");
+  return { ns / g_bench_settings.accesses, misses < 0 ? -1.0 : double(misses) / g_bench_settings.accesses };
+}
+
+// Independent reads, so several misses are in flight at once
+
+static auto sample_gather(const uint64_t* data, size_t count, TlbCounter& tlb) -> Sample
+{
+  const uint64_t mask = count - 1;
+  uint64_t sum = 0;
+  uint64_t state = 12345;
+  tlb.Start();
+  const double start = TIME_NOW_NS();
+  for (size_t i = 0; i < g_bench_settings.accesses; ++i)
+  {
+    state = state * 6364136223846793005ull + 1442695040888963407ull;
+    sum += data[(state >> 20) & mask];
+  }
+  const double ns = TIME_NOW_NS() - start;
+  const long long misses = tlb.Stop();
+  if (sum == 42)
+    printf("unreachable\n");
+  return { ns / g_bench_settings.accesses, misses < 0 ? -1.0 : double(misses) / g_bench_settings.accesses };
+}
+
+template <class Fn>
+static void run(const char* scenario, gdm::VirtualArena& arena, Fn&& fn)
+{
+  std::vector<Sample> samples;
+  for (int i = 0; i < g_bench_settings.repeats; ++i)
+    samples.push_back(fn());
+  std::sort(samples.begin(), samples.end(), [](const Sample& a, const Sample& b){ return a.ns_ < b.ns_; });
+  const Sample& median = samples[samples.size() / 2];
+  printf("%s,%s,%zu,%d,%.3f,%.3f,%.2f,%.4f,%lld\n", scenario, PAGES_NAME(arena.GetPages()), g_bench_settings.arena_mb,
+    static_cast<int>(samples.size()), samples.front().ns_, median.ns_, 1000.0 / median.ns_, median.tlb_misses_,
+    GetHugeKb(arena.GetData(), arena.GetReserved()));
+  fflush(stdout);
+}
+
+static void run_pages(gdm::VirtualArena::EPages pages)
+{
+  const size_t bytes = g_bench_settings.arena_mb << 20;
+  const size_t count = bytes / sizeof(uint64_t);
+  gdm::VirtualArena arena (bytes, 0, pages);
+  uint64_t* data = static_cast<uint64_t*>(arena.Allocate(bytes, 64));
+  if (!data)
+  {
+    printf("# failed to allocate %zu mb\n", g_bench_settings.arena_mb);
+    return;
+  }
+  FillChase(data, count);
+
+  TlbCounter tlb;
+  run("pointer_chase", arena, [&](){ return sample_chase(data, tlb); });
+  run("random_gather", arena, [&](){ return sample_gather(data, count, tlb); });
+}
+
+int main(int argc, const char** argv)
+{
+  g_bench_settings.arena_mb = argc > 1 ? std::max(1, atoi(argv[1])) : g_bench_settings.arena_mb;
+  g_bench_settings.repeats = argc > 2 ? std::max(1, atoi(argv[2])) : g_bench_settings.repeats;
+  g_bench_settings.accesses = argc > 3 ? std::max(1, atoi(argv[3])) * size_t{1000000} : g_bench_settings.accesses;
+
+  size_t pow2 = 1;
+  while (pow2 * 2 <= g_bench_settings.arena_mb)
+    pow2 *= 2;
+  g_bench_settings.arena_mb = pow2;
+
+  printf("scenario,pages,arena_mb,samples,min_ns,median_ns,m_per_sec,tlb_misses_per_access,huge_kb\n");
+  run_pages(gdm::VirtualArena::PAGES_DEFAULT);
+  run_pages(gdm::VirtualArena::PAGES_HUGE);
+  return 0;
+}
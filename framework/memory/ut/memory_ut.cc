@@ -6,6 +6,13 @@
 
 #include "3rdparty/catch/catch.hpp"
 #include <vector>
+#include <list>
+#include <thread>
+#include <set>
+#include <random>
+#include <string>
+#include <algorithm>
+#include <limits>
 
 #include <memory/aligned_allocator.h>
 #include <memory/defines.h>
@@ -15,6 +22,11 @@
 #include <memory/memory_tag.h>
 #include <memory/memory_tracker.h>
 #include <memory/operators.h>
+#include <memory/stack_allocator.h>
+#include <memory/pool_allocator.h>
+#include <memory/tlsf_heap.h>
+#include <memory/virtual_arena.h>
+#include <memory/growable_buffer.h>
 
 #include <system/hash_utils.h>
 
@@ -35,7 +47,7 @@ struct Big
   int value = 42;
 };
 
-__declspec(align(128)) struct Align128
+struct alignas(128) Align128
 { };
 
 TEST_CASE("Memory")
@@ -83,6 +95,39 @@ TEST_CASE("Memory")
     CHECK(mem::IsAligned(ptr, 32));
     CHECK(MemoryManager::GetPointerSize(ptr) >= 64);
     CHECK(MemoryManager::GetPointerSize(ptr) < 64 + 32);
+
+    MemoryManager::DeallocateAligned(ptr, 32);
+  }
+
+  SECTION("Reallocation keeps data and tag")
+  {
+    const MemoryTagValue tag = MEMORY_TAG("R0");
+    const size_t usage = MemoryManager::GetTagUsage(tag);
+
+    char* ptr = static_cast<char*>(MemoryManager::AllocateAligned(100, 64, tag));
+    for (int i = 0; i < 100; ++i)
+      ptr[i] = static_cast<char>(i);
+    CHECK(MemoryManager::GetPointerSize(ptr) == 100);
+    CHECK(MemoryManager::GetTagUsage(tag) == usage + 100);
+
+    ptr = static_cast<char*>(MemoryManager::ReallocateAligned(ptr, 104, 64));
+    CHECK(mem::IsAligned(ptr, 64));
+    ptr = static_cast<char*>(MemoryManager::ReallocateAligned(ptr, 1 << 20, 128));
+    CHECK(mem::IsAligned(ptr, 128));
+    CHECK(MemoryManager::GetPointerSize(ptr) == 1 << 20);
+    CHECK(MemoryManager::GetTagUsage(tag) == usage + (1 << 20));
+
+    bool same = true;
+    for (int i = 0; i < 100; ++i)
+      same &= ptr[i] == static_cast<char>(i);
+    CHECK(same);
+
+    ptr = static_cast<char*>(MemoryManager::ReallocateAligned(ptr, 50, 16));
+    CHECK(MemoryManager::GetTagUsage(tag) == usage + 50);
+    CHECK(ptr[49] == 49);
+
+    MemoryManager::Deallocate(ptr);
+    CHECK(MemoryManager::GetTagUsage(tag) == usage);
   }
 
   SECTION("Aligned struct")
@@ -151,6 +196,422 @@ TEST_CASE("Memory")
     v.emplace_back();
   }
 
+  SECTION("Frame allocator - typed allocate and lifo free")
+  {
+    using Frame = FrameAllocator<16384>;
+    Frame::Reset();
+
+    FrameAllocatorTyped<int, 16384> alloc;
+    int* a = alloc.allocate(16);
+    CHECK(Frame::GetFreeSize() == 16384 - sizeof(int) * 16);
+    int* b = alloc.allocate(8);
+    alloc.deallocate(a, 16);
+    CHECK(Frame::GetFreeSize() == 16384 - sizeof(int) * 24);
+    alloc.deallocate(b, 8);
+    alloc.deallocate(a, 16);
+    CHECK(Frame::GetFreeSize() == 16384);
+
+    {
+      FrameScope<16384> scope;
+      std::vector<int, FrameAllocatorTyped<int, 16384>> v;
+      for (int i = 0; i < 100; ++i)
+        v.push_back(i);
+      CHECK(v[99] == 99);
+    }
+    CHECK(Frame::GetFreeSize() == 16384);
+    CHECK(Frame::Allocate<Big>(16384) == nullptr);
+    CHECK(Frame::GetFreeSize() == 16384);
+  }
+
+  SECTION("Stack allocator - markers and lifo free")
+  {
+    StackAllocator stack (1024);
+    void* a = stack.Allocate(100);
+    void* b = stack.Allocate(64, 64);
+    CHECK(mem::IsAligned(b, 64));
+    CHECK(stack.GetUsed() == 128 + 64);
+
+    const StackAllocator::Marker marker = stack.GetMarker();
+    void* c = stack.Allocate(200);
+    void* d = stack.Allocate(10);
+    stack.Deallocate(c, 200);
+    CHECK(stack.GetUsed() == marker + 208 + 16);
+    stack.Deallocate(d, 10);
+    stack.Deallocate(c, 200);
+    CHECK(stack.GetUsed() == marker);
+
+    void* e = stack.Allocate(300);
+    stack.FreeToMarker(marker);
+    CHECK(stack.GetUsed() == marker);
+    CHECK(stack.Allocate(2048) == nullptr);
+    CHECK(stack.GetUsed() == marker);
+
+    stack.Deallocate(b, 64);
+    CHECK(stack.GetUsed() == 128);
+    stack.Deallocate(a, 100);
+    CHECK(stack.GetUsed() == 128);
+    stack.Reset();
+    CHECK(stack.GetUsed() == 0);
+    CHECK(stack.Allocate(100) == a);
+    CHECK(e == c);
+  }
+
+  SECTION("Stack allocator - scoped containers")
+  {
+    StackAllocator stack (4096, MEMORY_TAG("Stack"));
+    CHECK(MemoryManager::GetTagUsage(MEMORY_TAG("Stack")) == 4096);
+    {
+      StackScope scope (stack);
+      std::vector<float, StackAllocatorTyped<float>> v (stack);
+      v.reserve(64);
+      for (int i = 0; i < 64; ++i)
+        v.push_back(static_cast<float>(i));
+      std::vector<Small, StackAllocatorTyped<Small>> s (4, Small{}, stack);
+      CHECK(v[63] == 63.f);
+      CHECK(stack.GetUsed() >= sizeof(float) * 64 + sizeof(Small) * 4);
+    }
+    CHECK(stack.GetUsed() == 0);
+
+    StackAllocatorTyped<int> ints (stack);
+    StackAllocatorTyped<char> chars (ints);
+    CHECK(ints == chars);
+    CHECK_THROWS_AS(ints.allocate(4096), std::bad_alloc);
+  }
+
+  SECTION("Pool allocator - size classes")
+  {
+    CHECK(PoolAllocator::GetClassSize(0) == 16);
+    CHECK(PoolAllocator::GetClassSize(1) == 16);
+    CHECK(PoolAllocator::GetClassSize(16) == 16);
+    CHECK(PoolAllocator::GetClassSize(17) == 32);
+    CHECK(PoolAllocator::GetClassSize(129) == 160);
+    CHECK(PoolAllocator::GetClassSize(512) == 512);
+    CHECK(PoolAllocator::GetClassSize(513) == 0);
+  }
+
+  SECTION("Pool allocator - reuse and tags")
+  {
+    Big* big = PoolAllocator::New<Big>(MEMORY_TAG("Pool"), 42);
+    CHECK(big->value == 42);
+    CHECK(mem::IsAligned(big, MemoryManager::GetDefaultAlignment()));
+    PoolAllocator::FlushTagUsage();
+    CHECK(MemoryManager::GetTagUsage(MEMORY_TAG("Pool")) == PoolAllocator::GetClassSize(sizeof(Big)));
+    PoolAllocator::Delete(big, MEMORY_TAG("Pool"));
+    PoolAllocator::FlushTagUsage();
+    CHECK(MemoryManager::GetTagUsage(MEMORY_TAG("Pool")) == 0);
+    CHECK(PoolAllocator::New<Big>(MEMORY_TAG("Pool"), 43) == big);
+    PoolAllocator::Delete(big, MEMORY_TAG("Pool"));
+
+    void* large = PoolAllocator::Allocate(1000, MEMORY_TAG("Pool"));
+    CHECK(MemoryManager::GetTagUsage(MEMORY_TAG("Pool")) == 1000);
+    PoolAllocator::Deallocate(large, 1000, MEMORY_TAG("Pool"));
+    CHECK(MemoryManager::GetTagUsage(MEMORY_TAG("Pool")) == 0);
+  }
+
+  SECTION("Pool allocator - churn over batches and threads")
+  {
+    std::vector<Small*> objects;
+    for (int i = 0; i < 5000; ++i)
+      objects.push_back(PoolAllocator::New<Small>(0));
+    CHECK(std::set<Small*>(objects.begin(), objects.end()).size() == objects.size());
+    CHECK(PoolAllocator::GetReservedSize() >= sizeof(Small) * objects.size());
+
+    std::thread other ([&objects]()
+    {
+      for (size_t i = 0; i < objects.size(); i += 2)
+        PoolAllocator::Delete(objects[i]);
+    });
+    other.join();
+    for (size_t i = 1; i < objects.size(); i += 2)
+      PoolAllocator::Delete(objects[i]);
+    PoolAllocator::FlushThreadCache();
+
+    const size_t reserved = PoolAllocator::GetReservedSize();
+    for (int i = 0; i < 5000; ++i)
+      objects[i] = PoolAllocator::New<Small>(0);
+    CHECK(PoolAllocator::GetReservedSize() == reserved);
+    for (Small* object : objects)
+      PoolAllocator::Delete(object);
+  }
+
+  SECTION("Pool allocator - container usage")
+  {
+    {
+      std::list<int, PoolAllocatorTyped<int>> l (PoolAllocatorTyped<int>{MEMORY_TAG("PoolList")});
+      for (int i = 0; i < 100; ++i)
+        l.push_back(i);
+      CHECK(l.back() == 99);
+      PoolAllocator::FlushTagUsage();
+      CHECK(MemoryManager::GetTagUsage(MEMORY_TAG("PoolList")) == 100 * PoolAllocator::GetClassSize(sizeof(int) + 2 * sizeof(void*)));
+    }
+    PoolAllocator::FlushTagUsage();
+    CHECK(MemoryManager::GetTagUsage(MEMORY_TAG("PoolList")) == 0);
+  }
+
+  SECTION("Pool allocator - tag usage of other thread")
+  {
+    std::vector<Small*> objects;
+    for (int i = 0; i < 1000; ++i)
+      objects.push_back(PoolAllocator::New<Small>(MEMORY_TAG("PoolShared")));
+    PoolAllocator::FlushTagUsage();
+    CHECK(MemoryManager::GetTagUsage(MEMORY_TAG("PoolShared")) == 1000 * PoolAllocator::GetClassSize(sizeof(Small)));
+
+    std::thread other ([&objects]()
+    {
+      for (Small* object : objects)
+        PoolAllocator::Delete(object, MEMORY_TAG("PoolShared"));
+    });
+    other.join();
+    CHECK(MemoryManager::GetTagUsage(MEMORY_TAG("PoolShared")) == 0);
+  }
+
+  SECTION("TLSF heap - random churn and merge")
+  {
+    TlsfHeap heap (1 << 20);
+    const TlsfStats initial = heap.GetStats();
+    CHECK(initial.free_blocks_ == 1);
+    CHECK(initial.used_ == 0);
+    CHECK(initial.fragmentation_ == 0.f);
+
+    struct Live { char* ptr_; size_t size_; char fill_; };
+    std::vector<Live> live;
+    std::mt19937 rng (42);
+    bool valid = true;
+    for (int round = 0; round < 4000; ++round)
+    {
+      if (live.empty() || rng() % 3)
+      {
+        const size_t size = 1 + rng() % 2048;
+        const size_t align = size_t{16} << (rng() % 4);
+        char* ptr = static_cast<char*>(heap.Allocate(size, align, MEMORY_TAG("Tlsf")));
+        if (!ptr)
+          continue;
+        valid &= mem::IsAligned(ptr, align) && heap.GetBlockSize(ptr) >= size;
+        const char fill = static_cast<char>(round);
+        memset(ptr, fill, size);
+        live.push_back({ptr, size, fill});
+      }
+      else
+      {
+        const size_t index = rng() % live.size();
+        Live item = live[index];
+        valid &= std::all_of(item.ptr_, item.ptr_ + item.size_, [&item](char c){ return c == item.fill_; });
+        heap.Deallocate(item.ptr_, MEMORY_TAG("Tlsf"));
+        live[index] = live.back();
+        live.pop_back();
+      }
+    }
+    CHECK(valid);
+    CHECK(heap.GetStats().used_blocks_ == live.size());
+
+    std::sort(live.begin(), live.end(), [](const Live& a, const Live& b){ return a.ptr_ < b.ptr_; });
+    for (size_t i = 1; i < live.size(); ++i)
+      valid &= live[i - 1].ptr_ + heap.GetBlockSize(live[i - 1].ptr_) <= live[i].ptr_;
+    CHECK(valid);
+
+    for (const Live& item : live)
+      heap.Deallocate(item.ptr_, MEMORY_TAG("Tlsf"));
+    const TlsfStats stats = heap.GetStats();
+    CHECK(stats.free_blocks_ == 1);
+    CHECK(stats.free_ == initial.free_);
+    CHECK(stats.fragmentation_ == 0.f);
+    CHECK(heap.GetTagUsage(MEMORY_TAG("Tlsf")) == 0);
+  }
+
+  SECTION("TLSF heap - fragmentation and exhaustion")
+  {
+    TlsfHeap heap (1 << 16);
+    std::vector<void*> blocks;
+    while (void* ptr = heap.Allocate(1000))
+      blocks.push_back(ptr);
+    CHECK(blocks.size() >= 60);
+    CHECK(heap.GetStats().free_ < 1024);
+
+    size_t freed = 0;
+    for (size_t i = 0; i + 1 < blocks.size(); i += 2, ++freed)
+      heap.Deallocate(blocks[i]);
+    const TlsfStats stats = heap.GetStats();
+    CHECK(stats.free_blocks_ >= freed);
+    CHECK(stats.used_blocks_ == blocks.size() - freed);
+    CHECK(stats.fragmentation_ > 0.9f);
+    CHECK(heap.Allocate(2000) == nullptr);
+    CHECK(heap.Allocate(1000) != nullptr);
+  }
+
+  SECTION("Memory manager - tlsf backend")
+  {
+    static TlsfHeap heap (1 << 20);
+    void* system = MemoryManager::Allocate(64);
+
+    MemoryManager::SetHeap(&heap);
+    char* ptr = static_cast<char*>(MemoryManager::AllocateAligned(100, 64, MEMORY_TAG("Heap")));
+    memset(ptr, 7, 100);
+    const bool from_heap = heap.Contains(ptr);
+    const size_t heap_usage = heap.GetTagUsage(MEMORY_TAG("Heap"));
+    ptr = static_cast<char*>(MemoryManager::ReallocateAligned(ptr, 5000, 64, MEMORY_TAG("Heap")));
+    const bool moved = heap.Contains(ptr) && ptr[0] == 7 && ptr[99] == 7;
+    const size_t fallbacks = MemoryManager::GetHeapFallbacks();
+    void* fallback = MemoryManager::Allocate(2 << 20);
+    const bool fallback_system = !heap.Contains(fallback);
+    const size_t fallbacks_after = MemoryManager::GetHeapFallbacks();
+    MemoryManager::Deallocate(system);
+
+    CHECK(from_heap);
+    CHECK(heap_usage >= 100);
+    CHECK(moved);
+    CHECK(fallback_system);
+    CHECK(fallbacks_after == fallbacks + 1);
+    CHECK(MemoryManager::GetTagUsage(MEMORY_TAG("Heap")) == 5000);
+    CHECK(MemoryManager::GetPointerSize(ptr) == 5000);
+
+    MemoryManager::Deallocate(ptr);
+    MemoryManager::SetHeap(nullptr);
+    MemoryManager::Deallocate(fallback);
+    CHECK(MemoryManager::GetHeap() == nullptr);
+    CHECK(heap.GetTagUsage(MEMORY_TAG("Heap")) == 0);
+    CHECK(MemoryManager::GetTagUsage(MEMORY_TAG("Heap")) == 0);
+  }
+
+  SECTION("Memory manager - thread heaps")
+  {
+    static TlsfHeap global (1 << 16);
+    MemoryManager::SetHeap(&global);
+
+    bool own_heap = true;
+    void* cross = nullptr;
+    std::thread worker ([&own_heap, &cross]()
+    {
+      TlsfHeap local (1 << 16);
+      MemoryManager::SetThreadHeap(&local);
+      own_heap = MemoryManager::GetThreadHeap() == &local;
+      for (int i = 0; i < 100; ++i)
+      {
+        void* ptr = MemoryManager::Allocate(64, MEMORY_TAG("Thread"));
+        own_heap &= local.Contains(ptr);
+        MemoryManager::Deallocate(ptr);
+      }
+      MemoryManager::SetThreadHeap(nullptr);
+      own_heap &= MemoryManager::GetThreadHeap() == nullptr;
+      cross = MemoryManager::Allocate(64, MEMORY_TAG("Thread"));
+      own_heap &= global.Contains(cross);
+    });
+    void* ptr = MemoryManager::Allocate(64);
+    const bool from_global = global.Contains(ptr);
+    worker.join();
+
+    CHECK(from_global);
+    CHECK(own_heap);
+    MemoryManager::Deallocate(ptr);
+    MemoryManager::Deallocate(cross);
+    MemoryManager::SetHeap(nullptr);
+    CHECK(global.GetStats().used_blocks_ == 0);
+  }
+
+  SECTION("Virtual arena - commit on demand")
+  {
+    VirtualArena arena (size_t{1} << 32, MEMORY_TAG("Arena"));
+    CHECK(arena.GetReserved() == size_t{1} << 32);
+    CHECK(arena.GetCommitted() == 0);
+
+    char* small = static_cast<char*>(arena.Allocate(100));
+    CHECK(small == arena.GetData());
+    CHECK(arena.GetCommitted() == VirtualArena::v_commit_step);
+
+    char* big = static_cast<char*>(arena.Allocate(10 << 20, 4096));
+    CHECK(mem::IsAligned(big, 4096));
+    memset(big, 1, 10 << 20);
+    small[99] = 2;
+    CHECK(arena.GetCommitted() >= arena.GetUsed());
+    CHECK(MemoryManager::GetTagUsage(MEMORY_TAG("Arena")) == arena.GetCommitted());
+
+    CHECK(arena.Allocate(size_t{1} << 33) == nullptr);
+    arena.Reset();
+    arena.Decommit();
+    CHECK(arena.GetCommitted() == 0);
+    CHECK(MemoryManager::GetTagUsage(MEMORY_TAG("Arena")) == 0);
+    CHECK(arena.Allocate(16) == arena.GetData());
+  }
+
+  SECTION("Virtual arena - huge pages")
+  {
+    VirtualArena arena (3 << 20, MEMORY_TAG("Huge"), VirtualArena::PAGES_HUGE);
+    const size_t huge = VirtualArena::GetHugePageSize();
+    CHECK(arena.GetReserved() % huge == 0);
+    CHECK(arena.GetReserved() >= 3 << 20);
+
+    char* ptr = static_cast<char*>(arena.Allocate(100));
+    memset(ptr, 3, 100);
+    if (arena.GetPages() != VirtualArena::PAGES_DEFAULT)
+    {
+      CHECK(mem::IsAligned(ptr, huge));
+      CHECK(arena.GetCommitted() == huge);
+    }
+    CHECK(MemoryManager::GetTagUsage(MEMORY_TAG("Huge")) == arena.GetCommitted());
+
+    VirtualArena plain (3 << 20, 0, VirtualArena::PAGES_DEFAULT);
+    CHECK(plain.GetPages() == VirtualArena::PAGES_DEFAULT);
+    CHECK(plain.GetCommitStep() == VirtualArena::v_commit_step);
+
+    GrowableBuffer<float> floats (1 << 20, 0, VirtualArena::PAGES_TRANSPARENT_HUGE);
+    floats.resize(1 << 20, 1.f);
+    CHECK(floats.GetArena().GetPages() != VirtualArena::PAGES_HUGE);
+    CHECK(floats[(1 << 20) - 1] == 1.f);
+  }
+
+  SECTION("Growable buffer - growth without copy")
+  {
+    GrowableBuffer<int> ints (size_t{1} << 28, MEMORY_TAG("Growable"));
+    ints.push_back(0);
+    const int* first = ints.data();
+    for (int i = 1; i < (1 << 20); ++i)
+      ints.push_back(i);
+    CHECK(ints.data() == first);
+    CHECK(ints.size() == 1 << 20);
+    CHECK(ints[12345] == 12345);
+    CHECK(ints.back() == (1 << 20) - 1);
+    CHECK(ints.capacity() >= ints.size());
+    CHECK(MemoryManager::GetTagUsage(MEMORY_TAG("Growable")) == ints.capacity() * sizeof(int));
+
+    ints.resize(1000);
+    ints.ShrinkToFit();
+    CHECK(ints.capacity() < 1 << 20);
+    CHECK(ints[999] == 999);
+
+    GrowableBuffer<int> small (16);
+    small.resize(small.max_size(), 7);
+    CHECK(small.max_size() >= 16);
+    CHECK_THROWS_AS(small.push_back(1), std::bad_alloc);
+    CHECK_THROWS_AS(GrowableBuffer<int>(std::numeric_limits<size_t>::max() / 2), std::bad_alloc);
+
+    const GrowableBuffer<int>& view = small;
+    CHECK(view.front() == 7);
+    CHECK(&view.back() == view.data() + view.size() - 1);
+  }
+
+  SECTION("Growable buffer - non trivial elements")
+  {
+    GrowableBuffer<std::string> strings (1024);
+    for (int i = 0; i < 100; ++i)
+      strings.emplace_back(64, static_cast<char>('a' + i % 26));
+    strings.push_back(strings[0]);
+    CHECK(strings.back() == strings.front());
+    strings.pop_back();
+    strings.resize(50);
+
+    GrowableBuffer<std::string> moved (std::move(strings));
+    CHECK(moved.size() == 50);
+    CHECK(strings.empty());
+    CHECK(moved[49][0] == 'a' + 49 % 26);
+  }
+
+  SECTION("Operators - failed allocation")
+  {
+    volatile size_t huge = SIZE_MAX - 8;
+    CHECK(MemoryManager::Allocate(huge) == nullptr);
+    CHECK(new (std::nothrow) char[huge] == nullptr);
+    CHECK_THROWS_AS(new char[huge], std::bad_alloc);
+  }
+
   SECTION("Tracked allocation")
   {
     void* p00 = MemoryManager::Allocate(sizeof(int) * 1, MEMORY_TAG("P0"));
@@ -171,6 +632,7 @@ TEST_CASE("Memory")
 
     {
       std::vector<int, AlignedAllocator<int>> v (AlignedAllocator<int>(MEMORY_TAG("P0")));
+      v.reserve(3);
       v.push_back(0);
       v.push_back(1);
       v.push_back(2);
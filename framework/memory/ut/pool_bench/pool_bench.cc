@@ -0,0 +1,164 @@
+// *************************************************************
+// File:    pool_bench.cc
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+// Usage: pool_bench [max_threads] [repeats] [ops_per_thread]
+
+// Alloc/free churn of small objects, pool allocator and tlsf heap against
+//  malloc. Output is csv, one row per scenario with summary of samples in
+//  millions ops/sec
+
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <numeric>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "memory/pool_allocator.h"
+#include "memory/tlsf_heap.h"
+
+struct BenchSettings
+{
+  unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+  int repeats = 9;
+  int warmups = 1;
+  int ops = 1 << 21;
+  int live = 4096;
+} g_bench_settings;
+
+struct MallocAlloc
+{
+  static const char* GetName() { return "malloc"; }
+  static void* Allocate(size_t bytes) { return malloc(bytes); }
+  static void Deallocate(void* ptr, size_t) { free(ptr); }
+};
+
+struct PoolAlloc
+{
+  static const char* GetName() { return "pool"; }
+  static void* Allocate(size_t bytes) { return gdm::PoolAllocator::Allocate(bytes); }
+  static void Deallocate(void* ptr, size_t bytes) { gdm::PoolAllocator::Deallocate(ptr, bytes); }
+};
+
+// Heap isn't thread safe, so each thread churns in own one
+
+struct TlsfAlloc
+{
+  static const char* GetName() { return "tlsf"; }
+  static void* Allocate(size_t bytes) { return GetHeap().Allocate(bytes); }
+  static void Deallocate(void* ptr, size_t) { GetHeap().Deallocate(ptr); }
+  static gdm::TlsfHeap& GetHeap() { thread_local gdm::TlsfHeap heap (64 << 20); return heap; }
+};
+
+struct Slot
+{
+  void* ptr_;
+  size_t size_;
+};
+
+static double TIME_NOW_US()
+{
+  return std::chrono::duration<double, std::micro>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Random slot is freed and allocated again with random size, as mesh and
+//  resource objects are created and destroyed in random order
+
+template <class Alloc>
+static void churn_random(unsigned seed)
+{
+  std::mt19937 rng (seed);
+  std::vector<Slot> slots (g_bench_settings.live);
+  std::vector<uint32_t> picks (g_bench_settings.ops);
+  for (uint32_t& pick : picks)
+    pick = rng();
+
+  for (Slot& slot : slots)
+    slot = { Alloc::Allocate(16), 16 };
+  for (uint32_t pick : picks)
+  {
+    Slot& slot = slots[pick % slots.size()];
+    Alloc::Deallocate(slot.ptr_, slot.size_);
+    slot.size_ = 16 + (pick >> 24) % 240;
+    slot.ptr_ = Alloc::Allocate(slot.size_);
+    *static_cast<char*>(slot.ptr_) = 1;
+  }
+  for (Slot& slot : slots)
+    Alloc::Deallocate(slot.ptr_, slot.size_);
+}
+
+// Per frame temporaries: burst of allocations freed in the same order
+
+template <class Alloc>
+static void churn_burst(unsigned)
+{
+  std::vector<void*> ptrs (g_bench_settings.live);
+  for (int k = 0; k < g_bench_settings.ops / g_bench_settings.live; ++k)
+  {
+    for (void*& ptr : ptrs)
+    {
+      ptr = Alloc::Allocate(64);
+      *static_cast<char*>(ptr) = 1;
+    }
+    for (void* ptr : ptrs)
+      Alloc::Deallocate(ptr, 64);
+  }
+}
+
+template <class Fn>
+static double sample(Fn&& fn, unsigned threads)
+{
+  std::vector<std::thread> workers;
+  const double start = TIME_NOW_US();
+  for (unsigned i = 0; i < threads; ++i)
+    workers.emplace_back([&fn, i](){ fn(i + 1); });
+  for (std::thread& worker : workers)
+    worker.join();
+  return double(g_bench_settings.ops) * threads / (TIME_NOW_US() - start);
+}
+
+template <class Fn>
+static void run(const char* scenario, const char* allocator, Fn&& fn, unsigned threads)
+{
+  for (int i = 0; i < g_bench_settings.warmups; ++i)
+    sample(fn, threads);
+  std::vector<double> samples;
+  for (int i = 0; i < g_bench_settings.repeats; ++i)
+    samples.push_back(sample(fn, threads));
+  std::sort(samples.begin(), samples.end());
+  const double mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+  printf("%s,%s,%u,Mops/s,%zu,%.3f,%.3f,%.3f,%.3f\n", scenario, allocator, threads, samples.size(),
+    samples.front(), samples[samples.size() / 2], mean, samples.back());
+  fflush(stdout);
+}
+
+template <class Alloc>
+static void run_allocator(unsigned threads)
+{
+  run("churn_random", Alloc::GetName(), churn_random<Alloc>, threads);
+  run("churn_burst", Alloc::GetName(), churn_burst<Alloc>, threads);
+}
+
+int main(int argc, const char** argv)
+{
+  g_bench_settings.max_threads = argc > 1 ? std::max(1, atoi(argv[1])) : g_bench_settings.max_threads;
+  g_bench_settings.repeats = argc > 2 ? std::max(1, atoi(argv[2])) : g_bench_settings.repeats;
+  g_bench_settings.ops = argc > 3 ? std::max(g_bench_settings.live, atoi(argv[3])) : g_bench_settings.ops;
+
+  printf("scenario,allocator,threads,unit,samples,min,median,mean,max\n");
+  for (unsigned threads = 1; threads <= g_bench_settings.max_threads; threads *= 2)
+  {
+    run_allocator<MallocAlloc>(threads);
+    run_allocator<PoolAlloc>(threads);
+    run_allocator<TlsfAlloc>(threads);
+  }
+  return 0;
+}
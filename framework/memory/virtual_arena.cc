@@ -0,0 +1,290 @@
+// *************************************************************
+// File:    virtual_arena.cc
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#include "virtual_arena.h"
+
+#include <memory/memory_tracker.h>
+#include <memory/helpers.h>
+#include <math/general.h>
+#include <system/assert_utils.h>
+
+#include <utility>
+#include <cstdio>
+
+#if defined (_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+//--private
+
+namespace gdm::_private {
+
+  static auto AlignUp(size_t size, size_t align) -> size_t
+  {
+    return (size + align - 1) & ~(align - 1);
+  }
+
+  static auto ReserveRange(size_t bytes) -> char*
+  {
+#if defined (_WIN32)
+    return static_cast<char*>(VirtualAlloc(nullptr, bytes, MEM_RESERVE, PAGE_NOACCESS));
+#else
+    void* ptr = mmap(nullptr, bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    return ptr == MAP_FAILED ? nullptr : static_cast<char*>(ptr);
+#endif
+  }
+
+  // Huge pages are reserved from the pool without noreserve flag, so mmap
+  //  fails right here instead of SIGBUS on the first touch when pool is empty
+
+  static auto ReserveHugeRange(size_t bytes) -> char*
+  {
+#if defined (MAP_HUGETLB)
+    void* ptr = mmap(nullptr, bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    return ptr == MAP_FAILED ? nullptr : static_cast<char*>(ptr);
+#else
+    (void)bytes;
+    return nullptr;
+#endif
+  }
+
+  // Range is aligned to huge page by reserving more and cutting off the ends,
+  //  otherwise kernel can't place huge pages at its borders
+
+  static auto ReserveTransparentRange(size_t bytes, size_t huge_size, bool& advised) -> char*
+  {
+    advised = false;
+#if defined (_WIN32)
+    // No transparent huge pages, large pages need privilege and can't be
+    //  committed by parts, so default pages are used
+    (void)huge_size;
+    return ReserveRange(bytes);
+#else
+    char* raw = ReserveRange(bytes + huge_size);
+    if (!raw)
+      return nullptr;
+
+    char* ptr = reinterpret_cast<char*>(AlignUp(reinterpret_cast<uintptr_t>(raw), huge_size));
+    if (ptr != raw)
+      munmap(raw, ptr - raw);
+    if (ptr + bytes != raw + bytes + huge_size)
+      munmap(ptr + bytes, raw + bytes + huge_size - (ptr + bytes));
+#if defined (MADV_HUGEPAGE)
+    advised = madvise(ptr, bytes, MADV_HUGEPAGE) == 0;
+#endif
+    return ptr;
+#endif
+  }
+
+  static void ReleaseRange(char* ptr, size_t bytes)
+  {
+#if defined (_WIN32)
+    (void)bytes;
+    VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+    munmap(ptr, bytes);
+#endif
+  }
+
+  static bool CommitRange(char* ptr, size_t bytes)
+  {
+#if defined (_WIN32)
+    return VirtualAlloc(ptr, bytes, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+#else
+    return mprotect(ptr, bytes, PROT_READ | PROT_WRITE) == 0;
+#endif
+  }
+
+  // Physical pages are given back, range stays reserved
+
+  static void DecommitRange(char* ptr, size_t bytes)
+  {
+#if defined (_WIN32)
+    VirtualFree(ptr, bytes, MEM_DECOMMIT);
+#else
+    madvise(ptr, bytes, MADV_DONTNEED);
+    mprotect(ptr, bytes, PROT_NONE);
+#endif
+  }
+
+} // namespace gdm::_private
+
+// --public
+
+// Pages which were really given may be checked by GetPages(), it's default
+//  ones when system has no huge pages at all
+
+gdm::VirtualArena::VirtualArena(size_t reserve, MemoryTagValue tag, EPages pages)
+  : base_{nullptr}
+  , reserved_{_private::AlignUp(reserve, pages == PAGES_DEFAULT ? GetPageSize() : GetHugePageSize())}
+  , committed_{0}
+  , used_{0}
+  , tag_{tag}
+  , pages_{PAGES_DEFAULT}
+{
+  if (reserved_ && pages == PAGES_HUGE)
+  {
+    base_ = _private::ReserveHugeRange(reserved_);
+    pages_ = base_ ? PAGES_HUGE : PAGES_DEFAULT;
+  }
+  if (reserved_ && !base_ && pages != PAGES_DEFAULT)
+  {
+    bool advised = false;
+    base_ = _private::ReserveTransparentRange(reserved_, GetHugePageSize(), advised);
+    pages_ = advised ? PAGES_TRANSPARENT_HUGE : PAGES_DEFAULT;
+  }
+  if (reserved_ && !base_)
+    base_ = _private::ReserveRange(reserved_);
+
+  ASSERTF(base_ || !reserved_, "Failed to reserve %zu bytes of address space", reserved_);
+  if (!base_)
+    reserved_ = 0;
+}
+
+gdm::VirtualArena::VirtualArena(VirtualArena&& other) noexcept
+  : base_{std::exchange(other.base_, nullptr)}
+  , reserved_{std::exchange(other.reserved_, 0)}
+  , committed_{std::exchange(other.committed_, 0)}
+  , used_{std::exchange(other.used_, 0)}
+  , tag_{other.tag_}
+  , pages_{other.pages_}
+{ }
+
+gdm::VirtualArena& gdm::VirtualArena::operator=(VirtualArena&& other) noexcept
+{
+  if (this != &other)
+  {
+    Release();
+    base_ = std::exchange(other.base_, nullptr);
+    reserved_ = std::exchange(other.reserved_, 0);
+    committed_ = std::exchange(other.committed_, 0);
+    used_ = std::exchange(other.used_, 0);
+    tag_ = other.tag_;
+    pages_ = other.pages_;
+  }
+  return *this;
+}
+
+gdm::VirtualArena::~VirtualArena()
+{
+  Release();
+}
+
+// Returns nullptr when reserved range is over or system refused to commit
+
+void* gdm::VirtualArena::Allocate(size_t bytes, size_t align)
+{
+  ASSERTF(math::IsPowerOfTwo(align), "Alignment %zu is not power of 2", align);
+
+  const size_t offset = _private::AlignUp(used_, align);
+  if (offset > reserved_ || bytes > reserved_ - offset || !Commit(offset + bytes))
+    return nullptr;
+
+  used_ = offset + bytes;
+  return base_ + offset;
+}
+
+// Commits at least given bytes from the start of range. Growth is done by
+//  steps to not call the system on each small allocation
+
+bool gdm::VirtualArena::Commit(size_t bytes)
+{
+  if (bytes <= committed_)
+    return true;
+  if (bytes > reserved_)
+    return false;
+
+  const size_t target = math::Min(_private::AlignUp(bytes, GetCommitStep()), reserved_);
+  if (!_private::CommitRange(base_ + committed_, target - committed_))
+    return false;
+
+  MemoryTracker::GetInstance().AddUsage(tag_, target - committed_);
+  committed_ = target;
+  return true;
+}
+
+// Gives back committed pages above the used part
+
+void gdm::VirtualArena::Decommit()
+{
+  const size_t keep = _private::AlignUp(used_, pages_ == PAGES_DEFAULT ? GetPageSize() : GetHugePageSize());
+  if (keep >= committed_)
+    return;
+
+  _private::DecommitRange(base_ + keep, committed_ - keep);
+  MemoryTracker::GetInstance().SubUsage(tag_, committed_ - keep);
+  committed_ = keep;
+}
+
+// Used part may be only shrunk, or grown within committed range
+
+void gdm::VirtualArena::SetUsed(size_t used)
+{
+  ASSERTF(used <= committed_, "Used size %zu is above committed %zu", used, committed_);
+  used_ = used;
+}
+
+// Huge pages are committed whole, since part of it can't be backed
+
+size_t gdm::VirtualArena::GetCommitStep() const
+{
+  return pages_ == PAGES_DEFAULT ? v_commit_step : math::Max(v_commit_step, GetHugePageSize());
+}
+
+size_t gdm::VirtualArena::GetPageSize()
+{
+#if defined (_WIN32)
+  static const size_t s_page_size = []()
+  {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return static_cast<size_t>(info.dwAllocationGranularity);
+  }();
+#else
+  static const size_t s_page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+  return s_page_size;
+}
+
+// Default size of huge page of the system
+
+size_t gdm::VirtualArena::GetHugePageSize()
+{
+#if defined (_WIN32)
+  static const size_t s_huge_page_size = math::Max<size_t>(GetLargePageMinimum(), GetPageSize());
+#else
+  static const size_t s_huge_page_size = []()
+  {
+    size_t kb = 2048;
+    if (FILE* file = fopen("/proc/meminfo", "r"))
+    {
+      char line[128];
+      while (fgets(line, sizeof(line), file))
+        if (sscanf(line, "Hugepagesize: %zu kB", &kb) == 1)
+          break;
+      fclose(file);
+    }
+    return kb * 1024;
+  }();
+#endif
+  return s_huge_page_size;
+}
+
+// --private
+
+void gdm::VirtualArena::Release()
+{
+  if (!base_)
+    return;
+
+  MemoryTracker::GetInstance().SubUsage(tag_, committed_);
+  _private::ReleaseRange(base_, reserved_);
+  base_ = nullptr;
+  reserved_ = committed_ = used_ = 0;
+}
@@ -0,0 +1,75 @@
+// *************************************************************
+// File:    virtual_arena.h
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#ifndef AH_GDM_VIRTUAL_ARENA_H
+#define AH_GDM_VIRTUAL_ARENA_H
+
+#include <cstddef>
+
+#include "memory/memory_manager.h"
+#include "memory/memory_tag_value.h"
+
+namespace gdm {
+
+// Bump allocator over reserved range of address space. Pages are committed
+//  on demand when allocation reaches them, so arena grows in place and its
+//  pointers stay valid. Only committed memory is counted in tag.
+//
+// Big arenas which are touched randomly may ask for huge pages to have less
+//  tlb misses. Explicit huge pages are taken from system pool for the whole
+//  range at once, if pool has not enough of them the range is advised for
+//  transparent huge pages. Then range is aligned and committed by huge page
+
+struct VirtualArena
+{
+  enum EPages : unsigned
+  {
+    PAGES_DEFAULT = 0,                  // system pages
+    PAGES_TRANSPARENT_HUGE = 1 << 1,    // advise kernel to back range with huge pages
+    PAGES_HUGE = 1 << 2,                // explicit huge pages, or transparent ones as fallback
+  };
+
+  explicit VirtualArena(size_t reserve, MemoryTagValue tag = 0, EPages pages = PAGES_DEFAULT);
+  VirtualArena(VirtualArena&& other) noexcept;
+  VirtualArena& operator=(VirtualArena&& other) noexcept;
+  VirtualArena(const VirtualArena&) = delete;
+  VirtualArena& operator=(const VirtualArena&) = delete;
+  ~VirtualArena();
+
+  auto Allocate(size_t bytes, size_t align = MemoryManager::GetDefaultAlignment()) -> void*;
+  bool Commit(size_t bytes);
+  void Decommit();
+  void Reset() { used_ = 0; }
+  void SetUsed(size_t used);
+
+  auto GetData() const -> char* { return base_; }
+  auto GetUsed() const -> size_t { return used_; }
+  auto GetCommitted() const -> size_t { return committed_; }
+  auto GetReserved() const -> size_t { return reserved_; }
+  auto GetPages() const -> EPages { return pages_; }
+  auto GetCommitStep() const -> size_t;
+
+  static auto GetPageSize() -> size_t;
+  static auto GetHugePageSize() -> size_t;
+
+  constexpr static size_t v_commit_step = 64 * 1024;
+
+private:
+  void Release();
+
+private:
+  char* base_;
+  size_t reserved_;
+  size_t committed_;
+  size_t used_;
+  MemoryTagValue tag_;
+  EPages pages_;
+
+}; // struct VirtualArena
+
+} // namespace gdm
+
+#endif // AH_GDM_VIRTUAL_ARENA_H
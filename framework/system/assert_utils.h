@@ -78,7 +78,11 @@ void AssertImpl(const char* msg);
 #   define LOGFM(fmt, ...) { char s[CA_SZ]; sprintf(s, CTXT("LOG: %s:%d %s(): ") CTXT(fmt), __FILENAME__, __LINE__, __func__, ##__VA_ARGS__); print(s); }
 #   define LOGFF(fmt, ...) { char s[CA_SZ]; sprintf(s, CTXT("LOG: %s:%d %s(): ") CTXT(fmt), __FILE__, __LINE__, __func__, ##__VA_ARGS__); print(s); }
 #   define ENSUREF(A, M, ...) { if (!(A)) { char s[CA_SZ]; sprintf(s, CTXT(M), ##__VA_ARGS__); print(s); }
-#   define ASSERTF(A, M, ...) if (!(A)) { char s[CA_SZ]; memset(s, 0, CA_SZ); sprintf(s, CTXT("%s\nMessage: ") CTXT(M), CTXT(#A), ##__VA_ARGS__); assert(s, CTXT(__FILE__), (unsigned)__LINE__); }
+# if !defined(NDEBUG)
+#   define ASSERTF(A, M, ...) { if (!(A)) { char s[CA_SZ]; memset(s, 0, CA_SZ); sprintf(s, CTXT("%s\nMessage: ") CTXT(M), CTXT(#A), ##__VA_ARGS__); gdm::AssertImpl(s); } }
+# else
+#   define ASSERTF(...)
+# endif // NDEBUG
 #   define ASSERT(A) { assert(A); }
 #   define SASSERT(A) { static_assert(A); }
 #   define VEREFY(A) { if (!(A)) { char s[CA_SZ]; sprintf(s, #A); print(nullptr, s, CTXT("Verefy",) MB_OK); std::abort(); } }
@@ -26,7 +26,11 @@ namespace gdm::_private
 inline void gdm::AssertImpl(const char* msg)
 {
 #if not defined(GDM_UNIT_TEST)
+#if defined(_WIN32)
   MessageBoxA(nullptr, msg, "Assertf", MB_OK);
+#else
+  fprintf(stderr, "Assertf: %s\n", msg);
+#endif
 
   if (debug::IsDebuggerAttached())
     debug::DebugBreak();
@@ -10,6 +10,7 @@
 #pragma warning(disable: 4244)
 
 #include <stdint.h>
+#include <stddef.h>
 
 #define GDM_HASH(x) ::gdm::hash::Djb2CompileTime(x)
 #define GDM_HASH_N(x,n) { ::gdm::hash::CombinedHashSimple<GDM_HASH(x)>(n) }
@@ -0,0 +1,35 @@
+// *************************************************************
+// File:    backoff.h
+// Author:  Novoselov Anton @ 2018
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#ifndef AH_GDM_BACKOFF_H
+#define AH_GDM_BACKOFF_H
+
+namespace gdm {
+
+// Exponential backoff for spin loops: each Spin() pauses twice longer than
+//  previous one and returns false when spinning is not worth it anymore
+
+struct Backoff
+{
+  constexpr static unsigned v_max_pauses = 1024;
+
+  Backoff();
+
+  bool Spin();
+  void Reset();
+
+  static void Pause();
+
+private:
+  unsigned pauses_;
+
+}; // struct Backoff
+
+} // namespace gdm
+
+#include "backoff.inl"
+
+#endif // AH_GDM_BACKOFF_H
@@ -0,0 +1,43 @@
+// *************************************************************
+// File:    backoff.inl
+// Author:  Novoselov Anton @ 2018
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#include "backoff.h"
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// --public
+
+inline gdm::Backoff::Backoff()
+  : pauses_{1}
+{ }
+
+inline bool gdm::Backoff::Spin()
+{
+  if (pauses_ > v_max_pauses)
+    return false;
+  for (unsigned i = 0; i < pauses_; ++i)
+    Pause();
+  pauses_ *= 2;
+  return true;
+}
+
+inline void gdm::Backoff::Reset()
+{
+  pauses_ = 1;
+}
+
+inline void gdm::Backoff::Pause()
+{
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+  _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  asm volatile("yield");
+#endif
+}
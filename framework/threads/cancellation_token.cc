@@ -0,0 +1,103 @@
+// *************************************************************
+// File:    cancellation_token.cc
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#include "cancellation_token.h"
+
+#include <chrono>
+#include <utility>
+
+//--private
+
+namespace gdm::_private {
+
+  static uint64_t GetTokenTimeNs()
+  {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count());
+  }
+
+} // namespace gdm::_private
+
+// --public
+
+gdm::CancellationToken::CancellationToken() noexcept
+  : state_{nullptr}
+{ }
+
+gdm::CancellationToken::CancellationToken(const CancellationToken& other) noexcept
+  : state_{other.state_}
+{
+  if (state_)
+    state_->refs_.fetch_add(1, std::memory_order_relaxed);
+}
+
+gdm::CancellationToken::CancellationToken(CancellationToken&& other) noexcept
+  : state_{std::exchange(other.state_, nullptr)}
+{ }
+
+gdm::CancellationToken& gdm::CancellationToken::operator=(const CancellationToken& other) noexcept
+{
+  if (state_ == other.state_)
+    return *this;
+
+  Release();
+  state_ = other.state_;
+  if (state_)
+    state_->refs_.fetch_add(1, std::memory_order_relaxed);
+  return *this;
+}
+
+gdm::CancellationToken& gdm::CancellationToken::operator=(CancellationToken&& other) noexcept
+{
+  if (this == &other)
+    return *this;
+
+  Release();
+  state_ = std::exchange(other.state_, nullptr);
+  return *this;
+}
+
+gdm::CancellationToken::~CancellationToken()
+{
+  Release();
+}
+
+void gdm::CancellationToken::Cancel() const
+{
+  if (state_)
+    state_->cancelled_.store(true, std::memory_order_relaxed);
+}
+
+// Clock is read only for tokens with timeout, once expired token is
+//  remembered as cancelled
+
+bool gdm::CancellationToken::IsCancelled() const
+{
+  if (!state_)
+    return false;
+  if (state_->cancelled_.load(std::memory_order_relaxed))
+    return true;
+  if (!state_->deadline_ns_ || _private::GetTokenTimeNs() < state_->deadline_ns_)
+    return false;
+  state_->cancelled_.store(true, std::memory_order_relaxed);
+  return true;
+}
+
+gdm::CancellationToken gdm::CancellationToken::Create(unsigned timeout_us)
+{
+  CancellationToken token;
+  token.state_ = new State{{false}, {1}, timeout_us ? _private::GetTokenTimeNs() + timeout_us * 1000ull : 0};
+  return token;
+}
+
+// --private
+
+void gdm::CancellationToken::Release() noexcept
+{
+  if (state_ && state_->refs_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    delete state_;
+  state_ = nullptr;
+}
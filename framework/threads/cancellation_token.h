@@ -0,0 +1,53 @@
+// *************************************************************
+// File:    cancellation_token.h
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#ifndef AH_GDM_CANCELLATION_TOKEN_H
+#define AH_GDM_CANCELLATION_TOKEN_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace gdm {
+
+// Handle to shared cancel flag, copies share the same flag. Token created
+// with timeout also expires by itself. Jobs pushed with cancelled or expired
+// token are dropped when taken from queue, their counters are completed as
+// usual. Running job may check the token to stop early. Empty token is never
+// cancelled
+
+struct CancellationToken
+{
+  CancellationToken() noexcept;
+  CancellationToken(const CancellationToken& other) noexcept;
+  CancellationToken(CancellationToken&& other) noexcept;
+  CancellationToken& operator=(const CancellationToken& other) noexcept;
+  CancellationToken& operator=(CancellationToken&& other) noexcept;
+  ~CancellationToken();
+
+  void Cancel() const;
+  bool IsCancelled() const;
+  explicit operator bool() const noexcept { return state_ != nullptr; }
+
+  static auto Create(unsigned timeout_us = 0) -> CancellationToken;
+
+private:
+  struct State
+  {
+    std::atomic<bool> cancelled_;
+    std::atomic<int> refs_;
+    uint64_t deadline_ns_;
+  };
+
+  void Release() noexcept;
+
+private:
+  State* state_;
+
+}; // struct CancellationToken
+
+} // namespace gdm
+
+#endif // AH_GDM_CANCELLATION_TOKEN_H
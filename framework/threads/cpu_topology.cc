@@ -0,0 +1,217 @@
+// *************************************************************
+// File:    cpu_topology.cc
+// Author:  Novoselov Anton @ 2018
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#include "cpu_topology.h"
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <Windows.h>
+#elif defined(__unix__)
+#include <sched.h>
+#include <dirent.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <thread>
+#include <tuple>
+#include <algorithm>
+
+//--private
+
+namespace gdm::_private
+{
+#if defined(__unix__)
+
+  static bool ReadLine(const char* path, char* buffer, int size)
+  {
+    FILE* file = fopen(path, "r");
+    if (!file)
+      return false;
+    bool done = fgets(buffer, size, file) != nullptr;
+    fclose(file);
+    return done;
+  }
+
+  static unsigned ReadUnsigned(const char* path, unsigned fallback)
+  {
+    char buffer[64];
+    return ReadLine(path, buffer, sizeof(buffer)) ? static_cast<unsigned>(strtoul(buffer, nullptr, 10)) : fallback;
+  }
+
+  // Parses lists like "0-3,8,10-11"
+
+  static std::vector<unsigned> ReadCpuList(const char* path)
+  {
+    std::vector<unsigned> cpus;
+    char buffer[1024];
+    if (!ReadLine(path, buffer, sizeof(buffer)))
+      return cpus;
+
+    for (char* str = buffer; *str && *str != '\n';)
+    {
+      char* end = nullptr;
+      unsigned first = static_cast<unsigned>(strtoul(str, &end, 10));
+      unsigned last = first;
+      if (*end == '-')
+        last = static_cast<unsigned>(strtoul(end + 1, &end, 10));
+      for (unsigned cpu = first; cpu <= last; ++cpu)
+        cpus.push_back(cpu);
+      if (end == str || *end != ',')
+        break;
+      str = end + 1;
+    }
+    return cpus;
+  }
+
+  static unsigned ReadNode(const char* cpu_dir)
+  {
+    DIR* dir = opendir(cpu_dir);
+    if (!dir)
+      return 0;
+
+    unsigned node = 0;
+    while (dirent* entry = readdir(dir))
+    {
+      if (strncmp(entry->d_name, "node", 4) == 0)
+      {
+        node = static_cast<unsigned>(strtoul(entry->d_name + 4, nullptr, 10));
+        break;
+      }
+    }
+    closedir(dir);
+    return node;
+  }
+
+  // Without cache info package plays L3 role
+
+  static unsigned ReadL3(const char* cpu_dir, unsigned package)
+  {
+    char path[256];
+    for (int index = 0; index < 8; ++index)
+    {
+      snprintf(path, sizeof(path), "%scache/index%d/level", cpu_dir, index);
+      if (ReadUnsigned(path, 0) != 3)
+        continue;
+      snprintf(path, sizeof(path), "%scache/index%d/shared_cpu_list", cpu_dir, index);
+      std::vector<unsigned> shared = ReadCpuList(path);
+      if (!shared.empty())
+        return *std::min_element(shared.begin(), shared.end());
+    }
+    return package;
+  }
+
+#endif
+
+} // namespace gdm::_private
+
+// --public static
+
+gdm::CpuTopology gdm::CpuTopology::Probe()
+{
+  CpuTopology topology;
+
+#if defined(__unix__)
+  char cpu_dir[128];
+  char path[256];
+  for (unsigned id : _private::ReadCpuList("/sys/devices/system/cpu/online"))
+  {
+    snprintf(cpu_dir, sizeof(cpu_dir), "/sys/devices/system/cpu/cpu%u/", id);
+
+    Cpu cpu {};
+    cpu.id_ = id;
+    snprintf(path, sizeof(path), "%stopology/core_id", cpu_dir);
+    cpu.core_ = _private::ReadUnsigned(path, id);
+    snprintf(path, sizeof(path), "%stopology/physical_package_id", cpu_dir);
+    cpu.package_ = _private::ReadUnsigned(path, 0);
+    cpu.node_ = _private::ReadNode(cpu_dir);
+    cpu.l3_ = _private::ReadL3(cpu_dir, cpu.package_);
+
+    snprintf(path, sizeof(path), "%stopology/thread_siblings_list", cpu_dir);
+    std::vector<unsigned> siblings = _private::ReadCpuList(path);
+    auto sibling = std::find(siblings.begin(), siblings.end(), id);
+    cpu.smt_index_ = sibling != siblings.end() ? static_cast<unsigned>(sibling - siblings.begin()) : 0;
+
+    topology.cpus_.push_back(cpu);
+  }
+#endif
+
+  if (topology.cpus_.empty())
+  {
+    const unsigned count = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned id = 0; id < count; ++id)
+      topology.cpus_.push_back(Cpu{id, id, 0, 0, 0, 0});
+  }
+  return topology;
+}
+
+unsigned gdm::CpuTopology::GetCurrentCpu()
+{
+#if defined(_WIN32) || defined(_WIN64)
+  return static_cast<unsigned>(::GetCurrentProcessorNumber());
+#elif defined(__unix__)
+  int cpu = sched_getcpu();
+  return cpu < 0 ? 0 : static_cast<unsigned>(cpu);
+#else
+  return 0;
+#endif
+}
+
+// --public
+
+unsigned gdm::CpuTopology::GetCoresCount() const
+{
+  return static_cast<unsigned>(std::count_if(cpus_.begin(), cpus_.end(), [](const Cpu& cpu){ return cpu.smt_index_ == 0; }));
+}
+
+unsigned gdm::CpuTopology::GetNodesCount() const
+{
+  unsigned nodes = 0;
+  for (const Cpu& cpu : cpus_)
+    nodes = std::max(nodes, cpu.node_ + 1);
+  return nodes;
+}
+
+auto gdm::CpuTopology::FindCpu(unsigned id) const -> const Cpu*
+{
+  auto cpu = std::find_if(cpus_.begin(), cpus_.end(), [id](const Cpu& cpu){ return cpu.id_ == id; });
+  return cpu != cpus_.end() ? &*cpu : nullptr;
+}
+
+// Returns cpu for each worker or empty vector if workers shouldn't be pinned.
+//  Main thread cpu goes last, when there are more workers than cpus they wrap
+
+std::vector<unsigned> gdm::CpuTopology::MakePlacement(core::Placement policy, unsigned workers_count, unsigned main_cpu) const
+{
+  std::vector<unsigned> placement;
+  if ((policy & core::PLACE_ANY) || cpus_.empty())
+    return placement;
+
+  std::vector<const Cpu*> order;
+  for (const Cpu& cpu : cpus_)
+    order.push_back(&cpu);
+
+  const Cpu* main = FindCpu(main_cpu);
+  if ((policy & core::PLACE_L3_DOMAIN) && main)
+  {
+    auto other_l3 = std::remove_if(order.begin(), order.end(), [main](const Cpu* cpu){ return cpu->l3_ != main->l3_; });
+    order.erase(other_l3, order.end());
+  }
+
+  if (!(policy & core::PLACE_SEQUENTIAL))
+  {
+    std::stable_sort(order.begin(), order.end(), [main_cpu](const Cpu* lhs, const Cpu* rhs)
+    {
+      return std::make_tuple(lhs->id_ == main_cpu, lhs->smt_index_, lhs->package_, lhs->core_) <
+             std::make_tuple(rhs->id_ == main_cpu, rhs->smt_index_, rhs->package_, rhs->core_);
+    });
+  }
+
+  for (unsigned i = 0; i < workers_count; ++i)
+    placement.push_back(order[i % order.size()]->id_);
+  return placement;
+}
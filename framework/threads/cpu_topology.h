@@ -0,0 +1,65 @@
+// *************************************************************
+// File:    cpu_topology.h
+// Author:  Novoselov Anton @ 2018
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#ifndef AH_GDM_CPU_TOPOLOGY_H
+#define AH_GDM_CPU_TOPOLOGY_H
+
+#include <vector>
+
+namespace gdm {
+
+namespace core {
+
+  // Values are bits to be passed with JobManagerProps
+
+  enum EPlacement : unsigned
+  {
+    PLACE_PHYSICAL_CORES = 0,     // one worker per physical core, smt siblings last
+    PLACE_L3_DOMAIN = 1 << 8,     // as above, but only cpus sharing L3 with main thread
+    PLACE_SEQUENTIAL = 1 << 9,    // worker i to logical cpu i
+    PLACE_ANY = 1 << 10,          // don't pin, let os decide
+    PLACE_MASK = PLACE_L3_DOMAIN | PLACE_SEQUENTIAL | PLACE_ANY
+
+  }; // enum EPlacement
+
+  using Placement = unsigned;
+
+} // namespace core
+
+// Logical cpus as os sees them. On linux it's read from /sys/devices/system/cpu,
+// when it's not available every cpu is treated as separate core
+
+struct CpuTopology
+{
+  struct Cpu
+  {
+    unsigned id_;
+    unsigned core_;         // core id, unique inside package
+    unsigned package_;
+    unsigned node_;         // numa node
+    unsigned l3_;           // lowest cpu id sharing the same L3
+    unsigned smt_index_;    // 0 for first hw thread of core
+
+  }; // struct Cpu
+
+  static auto Probe() -> CpuTopology;
+  static auto GetCurrentCpu() -> unsigned;
+
+  auto GetCpus() const -> const std::vector<Cpu>& { return cpus_; }
+  auto GetCpusCount() const -> unsigned { return static_cast<unsigned>(cpus_.size()); }
+  auto GetCoresCount() const -> unsigned;
+  auto GetNodesCount() const -> unsigned;
+  auto FindCpu(unsigned id) const -> const Cpu*;
+  auto MakePlacement(core::Placement policy, unsigned workers_count, unsigned main_cpu) const -> std::vector<unsigned>;
+
+private:
+  std::vector<Cpu> cpus_;
+
+}; // struct CpuTopology
+
+} // namespace gdm
+
+#endif // AH_GDM_CPU_TOPOLOGY_H
@@ -6,17 +6,33 @@
 
 #include "fence.h"
 
+#include "futex.h"
+
 //--public
 
 gdm::Fence::Fence()
   : value_{0}
-  , cv_{}
-  , mx_{}
+  , waiters_{0}
 { }
 
+// Waiters may wait for different values, so all are woken and those
+//  which are not satisfied go back to sleep
+
+void gdm::Fence::Signal(int value)
+{
+  assert(value >= value_.load(std::memory_order_relaxed) && "Fence value should not decrease");
+  value_.store(value, std::memory_order_seq_cst);
+  if (waiters_.load(std::memory_order_seq_cst) > 0)
+    futex::WakeAll(value_);
+}
+
 void gdm::Fence::WaitOnValue(int value)
 {
-  std::unique_lock<std::mutex> lock(mx_);
-  if (value_ < value)
-    cv_.wait(lock, [this, value](){ return value_ >= value; });
+  if (value_.load(std::memory_order_acquire) >= value)
+    return;
+
+  waiters_.fetch_add(1, std::memory_order_seq_cst);
+  for (int current = value_.load(std::memory_order_seq_cst); current < value; current = value_.load(std::memory_order_seq_cst))
+    futex::Wait(value_, current);
+  waiters_.fetch_sub(1, std::memory_order_relaxed);
 }
@@ -9,22 +9,23 @@
 
 #include <assert.h>
 #include <atomic>
-#include <mutex>
-#include <condition_variable>
 
 namespace gdm {
 
+// Monotonic value to wait on, like gpu timeline fence. Waiting on already
+//  reached value is one load, signal enters kernel only if somebody sleeps
+
 struct Fence
 {
   Fence();
 
-  auto GetValue() const -> int { return value_; };
+  auto GetValue() const -> int { return value_.load(std::memory_order_acquire); };
+  void Signal(int value);
   void WaitOnValue(int value);
 
 private:
-  std::atomic_int value_;
-  std::condition_variable cv_;
-  std::mutex mx_;
+  std::atomic<int> value_;
+  std::atomic<int> waiters_;
 
 }; // struct Fence
 
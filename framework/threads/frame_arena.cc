@@ -0,0 +1,138 @@
+// *************************************************************
+// File:    frame_arena.cc
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#include "frame_arena.h"
+
+#include <new>
+#include <string.h>
+
+//--private
+
+namespace gdm::_private {
+
+  constexpr std::size_t v_arena_align = 64;
+
+  static std::atomic<uint64_t> s_arenas_ids {1};
+
+  // Last arenas used by thread, id is checked before the slot is touched, so
+  //  stale entry of destroyed owner is never dereferenced
+
+  static thread_local struct
+  {
+    uint64_t owner_id;
+    void* slot;
+  } s_arenas_cache {0, nullptr};
+
+} // namespace gdm::_private
+
+// --public
+
+gdm::FrameArena::FrameArena(std::size_t size)
+  : buffers_{}
+  , used_{0, 0}
+  , size_{size}
+  , current_{0}
+{
+  unsigned char* memory = static_cast<unsigned char*>(::operator new(size * 2, std::align_val_t{_private::v_arena_align}));
+  buffers_[0] = memory;
+  buffers_[1] = memory + size;
+}
+
+gdm::FrameArena::~FrameArena()
+{
+  ::operator delete(buffers_[0], std::align_val_t{_private::v_arena_align});
+}
+
+// Returns nullptr when the half is out of space
+
+void* gdm::FrameArena::Allocate(std::size_t bytes, std::size_t align)
+{
+  const uintptr_t base = reinterpret_cast<uintptr_t>(buffers_[current_]);
+  const uintptr_t ptr = (base + used_[current_] + align - 1) & ~(static_cast<uintptr_t>(align) - 1);
+  const std::size_t end = ptr - base + bytes;
+  if (end > size_)
+    return nullptr;
+
+  used_[current_] = end;
+  return reinterpret_cast<void*>(ptr);
+}
+
+void gdm::FrameArena::Flip()
+{
+  current_ ^= 1;
+#ifndef NDEBUG
+  memset(buffers_[current_], v_poison, used_[current_]);
+#endif
+  used_[current_] = 0;
+}
+
+gdm::FrameArenas::FrameArenas(std::size_t size)
+  : id_{_private::s_arenas_ids.fetch_add(1, std::memory_order_relaxed)}
+  , frame_{0}
+  , size_{size}
+  , lock_{}
+  , slots_{}
+{ }
+
+// Arena which wasn't used for two frames or more is rewinded fully
+
+gdm::FrameArena& gdm::FrameArenas::GetLocal()
+{
+  Slot* slot = FindSlot();
+  const uint64_t frame = frame_.load(std::memory_order_acquire);
+  if (slot->frame_ != frame)
+  {
+    slot->arena_.Flip();
+    if (frame - slot->frame_ > 1)
+      slot->arena_.Flip();
+    slot->frame_ = frame;
+  }
+  return slot->arena_;
+}
+
+void gdm::FrameArenas::BeginFrame()
+{
+  frame_.fetch_add(1, std::memory_order_acq_rel);
+}
+
+// Affects only arenas of threads which didn't allocate yet
+
+void gdm::FrameArenas::SetSize(std::size_t size)
+{
+  std::lock_guard<std::mutex> lock(lock_);
+  size_ = size;
+}
+
+std::size_t gdm::FrameArenas::GetArenasCount() const
+{
+  std::lock_guard<std::mutex> lock(lock_);
+  return slots_.size();
+}
+
+// --private
+
+auto gdm::FrameArenas::FindSlot() -> Slot*
+{
+  if (_private::s_arenas_cache.owner_id == id_)
+    return static_cast<Slot*>(_private::s_arenas_cache.slot);
+
+  const std::thread::id thread = std::this_thread::get_id();
+  Slot* slot = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    for (const std::unique_ptr<Slot>& existing : slots_)
+      if (existing->thread_ == thread)
+        slot = existing.get();
+    if (!slot)
+    {
+      slots_.push_back(std::unique_ptr<Slot>(new Slot{thread, frame_.load(std::memory_order_acquire), FrameArena{size_}}));
+      slot = slots_.back().get();
+    }
+  }
+  _private::s_arenas_cache.owner_id = id_;
+  _private::s_arenas_cache.slot = slot;
+  return slot;
+}
@@ -0,0 +1,92 @@
+// *************************************************************
+// File:    frame_arena.h
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#ifndef AH_GDM_FRAME_ARENA_H
+#define AH_GDM_FRAME_ARENA_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <thread>
+#include <cstdint>
+#include <cstddef>
+
+namespace gdm {
+
+// Double buffered bump allocator of one thread. Allocations of the current
+//  frame go to one half, flip makes the other half current and rewinds it,
+//  so data of the previous frame is still readable. Rewind doesn't touch
+//  memory, debug build poisons used part to catch stale pointers
+
+struct FrameArena
+{
+  explicit FrameArena(std::size_t size);
+  FrameArena(const FrameArena&) = delete;
+  FrameArena& operator=(const FrameArena&) = delete;
+  ~FrameArena();
+
+  auto Allocate(std::size_t bytes, std::size_t align = alignof(std::max_align_t)) -> void*;
+  template <class T>
+  auto Allocate(std::size_t count) -> T*;
+  void Flip();
+
+  auto GetUsed() const -> std::size_t { return used_[current_]; }
+  auto GetSize() const -> std::size_t { return size_; }
+
+  constexpr static unsigned char v_poison = 0xcd;
+
+private:
+  unsigned char* buffers_[2];
+  std::size_t used_[2];
+  std::size_t size_;
+  int current_;
+
+}; // struct FrameArena
+
+// Per thread arenas of one owner (i.e. job manager). Each thread gets own
+//  arena on the first request, so workers allocate without locks. Arena of
+//  thread is flipped lazily when it's used in a new frame, data allocated in
+//  frame N is valid till the end of frame N + 1
+
+struct FrameArenas
+{
+  explicit FrameArenas(std::size_t size);
+  FrameArenas(const FrameArenas&) = delete;
+  FrameArenas& operator=(const FrameArenas&) = delete;
+
+  auto GetLocal() -> FrameArena&;
+  void BeginFrame();
+  void SetSize(std::size_t size);
+  auto GetFrame() const -> uint64_t { return frame_.load(std::memory_order_acquire); }
+  auto GetArenasCount() const -> std::size_t;
+
+  constexpr static std::size_t v_default_size = 1 << 20;
+
+private:
+  struct Slot
+  {
+    std::thread::id thread_;
+    uint64_t frame_;
+    FrameArena arena_;
+  };
+
+  auto FindSlot() -> Slot*;
+
+private:
+  uint64_t id_;
+  std::atomic<uint64_t> frame_;
+  std::size_t size_;
+  mutable std::mutex lock_;
+  std::vector<std::unique_ptr<Slot>> slots_;
+
+}; // struct FrameArenas
+
+} // namespace gdm
+
+#include "frame_arena.inl"
+
+#endif // AH_GDM_FRAME_ARENA_H
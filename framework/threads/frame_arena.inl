@@ -0,0 +1,18 @@
+// *************************************************************
+// File:    frame_arena.inl
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#include "frame_arena.h"
+
+#include <type_traits>
+
+// Objects are never destroyed by arena, so only trivial types are allowed
+
+template <class T>
+inline auto gdm::FrameArena::Allocate(std::size_t count) -> T*
+{
+  static_assert(std::is_trivially_destructible_v<T>);
+  return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+}
@@ -0,0 +1,69 @@
+// *************************************************************
+// File:    futex.cc
+// Author:  Novoselov Anton @ 2018
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#include "futex.h"
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <Windows.h>  // WaitOnAddress, links with Synchronization.lib
+#elif defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <limits.h>
+#else
+#include <thread>
+#endif
+
+static_assert(sizeof(std::atomic<int>) == sizeof(int), "Futex word should be plain int");
+
+// --public
+
+void gdm::futex::Wait(std::atomic<int>& word, int expected)
+{
+#if defined(_WIN32) || defined(_WIN64)
+  ::WaitOnAddress(&word, &expected, sizeof(int), INFINITE);
+#elif defined(__linux__)
+  syscall(SYS_futex, reinterpret_cast<int*>(&word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+#else
+  if (word.load(std::memory_order_relaxed) == expected)
+    std::this_thread::yield();
+#endif
+}
+
+void gdm::futex::WakeOne(std::atomic<int>& word)
+{
+#if defined(_WIN32) || defined(_WIN64)
+  ::WakeByAddressSingle(&word);
+#elif defined(__linux__)
+  syscall(SYS_futex, reinterpret_cast<int*>(&word), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#else
+  (void)word;
+#endif
+}
+
+void gdm::futex::Wake(std::atomic<int>& word, int count)
+{
+#if defined(_WIN32) || defined(_WIN64)
+  for (int i = 0; i < count; ++i)
+    ::WakeByAddressSingle(&word);
+#elif defined(__linux__)
+  syscall(SYS_futex, reinterpret_cast<int*>(&word), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+#else
+  (void)word;
+  (void)count;
+#endif
+}
+
+void gdm::futex::WakeAll(std::atomic<int>& word)
+{
+#if defined(_WIN32) || defined(_WIN64)
+  ::WakeByAddressAll(&word);
+#elif defined(__linux__)
+  syscall(SYS_futex, reinterpret_cast<int*>(&word), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#else
+  (void)word;
+#endif
+}
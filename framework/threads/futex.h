@@ -0,0 +1,24 @@
+// *************************************************************
+// File:    futex.h
+// Author:  Novoselov Anton @ 2018
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#ifndef AH_GDM_FUTEX_H
+#define AH_GDM_FUTEX_H
+
+#include <atomic>
+
+namespace gdm::futex {
+
+  // Sleeps while word equals to expected value. May return spuriously,
+  //  so caller should check the word in a loop
+
+  void Wait(std::atomic<int>& word, int expected);
+  void WakeOne(std::atomic<int>& word);
+  void Wake(std::atomic<int>& word, int count);
+  void WakeAll(std::atomic<int>& word);
+
+} // namespace gdm::futex
+
+#endif // AH_GDM_FUTEX_H
@@ -0,0 +1,528 @@
+// *************************************************************
+// File:    io_service.cc
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#include "io_service.h"
+
+#include <errno.h>
+#include <string.h>
+#include <algorithm>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <Windows.h>
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define GDM_IO_URING 1
+#endif
+
+#include "threads/job_manager.h"
+#include "threads/futex.h"
+
+//--private
+
+namespace gdm::_private {
+
+  static void CloseFile(int fd)
+  {
+#if defined(_WIN32) || defined(_WIN64)
+    _close(fd);
+#else
+    close(fd);
+#endif
+  }
+
+  // Returns descriptor or -errno
+
+  static int OpenFile(const char* path, std::size_t& size)
+  {
+#if defined(_WIN32) || defined(_WIN64)
+    int fd = _open(path, _O_RDONLY | _O_BINARY);
+    struct _stat64 st;
+    if (fd >= 0 && _fstat64(fd, &st) == 0)
+#else
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (fd >= 0 && fstat(fd, &st) == 0)
+#endif
+    {
+      size = static_cast<std::size_t>(st.st_size);
+      return fd;
+    }
+    const int error = errno ? errno : EIO;
+    if (fd >= 0)
+      CloseFile(fd);
+    return -error;
+  }
+
+  // Returns read bytes or -errno, doesn't move file position
+
+  static long long ReadFileAt(int fd, void* buffer, std::size_t size, std::size_t offset)
+  {
+#if defined(_WIN32) || defined(_WIN64)
+    OVERLAPPED overlapped {};
+    overlapped.Offset = static_cast<DWORD>(offset);
+    overlapped.OffsetHigh = static_cast<DWORD>(static_cast<unsigned long long>(offset) >> 32);
+    DWORD read = 0;
+    DWORD to_read = static_cast<DWORD>(std::min<std::size_t>(size, 1u << 30));
+    if (!::ReadFile(reinterpret_cast<HANDLE>(_get_osfhandle(fd)), buffer, to_read, &read, &overlapped))
+      return ::GetLastError() == ERROR_HANDLE_EOF ? 0 : -EIO;
+    return read;
+#else
+    ssize_t read = 0;
+    do
+      read = pread(fd, buffer, size, static_cast<off_t>(offset));
+    while (read < 0 && errno == EINTR);
+    return read < 0 ? -errno : read;
+#endif
+  }
+
+#if defined(GDM_IO_URING)
+
+  // Minimal io_uring without liburing. Submission side is used under service
+  //  lock, completion side only by service thread
+
+  struct IoRing
+  {
+    ~IoRing();
+
+    auto GetSqe() -> io_uring_sqe*;
+    int Submit();
+    int Wait();
+    auto PeekCqe() -> io_uring_cqe*;
+    void SeenCqe();
+
+    static auto Create(unsigned entries) -> std::unique_ptr<IoRing>;
+
+    int fd_ = -1;
+    unsigned entries_ = 0;
+    void* sq_ptr_ = MAP_FAILED;
+    std::size_t sq_size_ = 0;
+    void* cq_ptr_ = MAP_FAILED;
+    std::size_t cq_size_ = 0;
+    io_uring_sqe* sqes_ = static_cast<io_uring_sqe*>(MAP_FAILED);
+    std::size_t sqes_size_ = 0;
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_mask_ = nullptr;
+    unsigned* sq_array_ = nullptr;
+    unsigned local_tail_ = 0;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned* cq_mask_ = nullptr;
+    io_uring_cqe* cqes_ = nullptr;
+
+  }; // struct IoRing
+
+  static unsigned LoadAcquire(unsigned* word)
+  {
+    return __atomic_load_n(word, __ATOMIC_ACQUIRE);
+  }
+
+  static void StoreRelease(unsigned* word, unsigned value)
+  {
+    __atomic_store_n(word, value, __ATOMIC_RELEASE);
+  }
+
+  IoRing::~IoRing()
+  {
+    if (sqes_ != MAP_FAILED)
+      munmap(sqes_, sqes_size_);
+    if (cq_ptr_ != MAP_FAILED && cq_ptr_ != sq_ptr_)
+      munmap(cq_ptr_, cq_size_);
+    if (sq_ptr_ != MAP_FAILED)
+      munmap(sq_ptr_, sq_size_);
+    if (fd_ >= 0)
+      close(fd_);
+  }
+
+  // Returns nullptr if io_uring is not available or can't read, so caller
+  //  falls back to threads
+
+  auto IoRing::Create(unsigned entries) -> std::unique_ptr<IoRing>
+  {
+    io_uring_params params {};
+    const int fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (fd < 0)
+      return nullptr;
+
+    std::unique_ptr<IoRing> ring = std::make_unique<IoRing>();
+    ring->fd_ = fd;
+    ring->entries_ = params.sq_entries;
+
+    constexpr int ops_count = IORING_OP_READ + 1;
+    alignas(io_uring_probe) unsigned char probe_data[sizeof(io_uring_probe) + ops_count * sizeof(io_uring_probe_op)] {};
+    io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(probe_data);
+    if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, ops_count) < 0 ||
+        probe->last_op < IORING_OP_READ || !(probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED))
+      return nullptr;
+
+    ring->sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+      ring->sq_size_ = ring->cq_size_ = std::max(ring->sq_size_, ring->cq_size_);
+
+    ring->sq_ptr_ = mmap(nullptr, ring->sq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ptr_ == MAP_FAILED)
+      return nullptr;
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+      ring->cq_ptr_ = ring->sq_ptr_;
+    else
+      ring->cq_ptr_ = mmap(nullptr, ring->cq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    if (ring->cq_ptr_ == MAP_FAILED)
+      return nullptr;
+    ring->sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    ring->sqes_ = static_cast<io_uring_sqe*>(mmap(nullptr, ring->sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+    if (ring->sqes_ == MAP_FAILED)
+      return nullptr;
+
+    unsigned char* sq = static_cast<unsigned char*>(ring->sq_ptr_);
+    ring->sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    ring->sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    ring->sq_mask_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    ring->sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    ring->local_tail_ = *ring->sq_tail_;
+    unsigned char* cq = static_cast<unsigned char*>(ring->cq_ptr_);
+    ring->cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    ring->cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    ring->cq_mask_ = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    ring->cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    return ring;
+  }
+
+  // Entries are published to kernel by the next Submit()
+
+  auto IoRing::GetSqe() -> io_uring_sqe*
+  {
+    if (local_tail_ - LoadAcquire(sq_head_) >= entries_)
+      return nullptr;
+
+    const unsigned index = local_tail_ & *sq_mask_;
+    sq_array_[index] = index;
+    ++local_tail_;
+    io_uring_sqe* sqe = &sqes_[index];
+    memset(sqe, 0, sizeof(io_uring_sqe));
+    return sqe;
+  }
+
+  // Kernel consumes everything between head and tail, so entries left after
+  //  failed call are submitted by the next one
+
+  int IoRing::Submit()
+  {
+    StoreRelease(sq_tail_, local_tail_);
+    int res = 0;
+    do
+    {
+      const unsigned count = local_tail_ - LoadAcquire(sq_head_);
+      if (!count)
+        return 0;
+      res = static_cast<int>(syscall(__NR_io_uring_enter, fd_, count, 0, 0, nullptr, 0));
+    } while (res < 0 && errno == EINTR);
+    return res < 0 ? -errno : res;
+  }
+
+  int IoRing::Wait()
+  {
+    const int res = static_cast<int>(syscall(__NR_io_uring_enter, fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0));
+    return res < 0 ? -errno : res;
+  }
+
+  auto IoRing::PeekCqe() -> io_uring_cqe*
+  {
+    const unsigned head = *cq_head_;
+    if (head == LoadAcquire(cq_tail_))
+      return nullptr;
+    return &cqes_[head & *cq_mask_];
+  }
+
+  void IoRing::SeenCqe()
+  {
+    StoreRelease(cq_head_, *cq_head_ + 1);
+  }
+
+#else
+
+  struct IoRing
+  {
+    static auto Create(unsigned) -> std::unique_ptr<IoRing> { return nullptr; }
+
+  }; // struct IoRing
+
+#endif // GDM_IO_URING
+
+} // namespace gdm::_private
+
+// --public
+
+gdm::IoService::IoService(JobManager& mgr, unsigned queue_depth, unsigned fallback_threads, bool allow_uring)
+  : mgr_{mgr}
+  , ring_{allow_uring ? _private::IoRing::Create(std::max(queue_depth, 1u)) : nullptr}
+  , threads_{}
+  , lock_{}
+  , pending_{}
+  , pending_count_{0}
+  , in_flight_{0}
+  , files_{0}
+  , running_{true}
+{
+  threads_.reserve(ring_ ? 1 : std::max(fallback_threads, 1u));
+  if (ring_)
+    threads_.emplace_back(RingFunc, this);
+  else
+    for (unsigned i = 0; i < std::max(fallback_threads, 1u); ++i)
+      threads_.emplace_back(FallbackFunc, this);
+}
+
+// Waits for all requests, then stops threads. Ring thread is woken by nop
+//  with empty user data, fallback threads by empty ops
+
+gdm::IoService::~IoService()
+{
+  for (int files = files_.load(std::memory_order_acquire); files; files = files_.load(std::memory_order_acquire))
+    futex::Wait(files_, files);
+
+  running_.store(false, std::memory_order_release);
+#if defined(GDM_IO_URING)
+  if (ring_)
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    io_uring_sqe* sqe = ring_->GetSqe();
+    sqe->opcode = IORING_OP_NOP;
+    sqe->user_data = 0;
+    ring_->Submit();
+  }
+  else
+#endif
+  {
+    {
+      std::lock_guard<std::mutex> lock(lock_);
+      pending_.insert(pending_.end(), threads_.size(), nullptr);
+    }
+    pending_count_.Post(static_cast<int>(threads_.size()));
+  }
+  for (Thread& thread : threads_)
+    thread.Join();
+}
+
+void gdm::IoService::Read(IoRequest* requests, std::size_t count, JobCounter& counter)
+{
+  if (!count)
+    return;
+  if (!counter)
+    counter = JobCounter::Create();
+  counter.Add(static_cast<int>(count));
+
+  std::vector<Op*> ops;
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    IoRequest& request = requests[i];
+    request.error_ = 0;
+
+    File* file = new File{&request, -1, {0}, {0}, counter, {}};
+    files_.fetch_add(1, std::memory_order_relaxed);
+    std::size_t size = 0;
+    file->fd_ = _private::OpenFile(request.path_.c_str(), size);
+    if (file->fd_ < 0)
+    {
+      FinishFile(file, -file->fd_);
+      continue;
+    }
+    request.data_.resize(size);
+    if (!size)
+    {
+      FinishFile(file, 0);
+      continue;
+    }
+
+    const std::size_t chunks = (size + v_chunk_size - 1) / v_chunk_size;
+    file->chunks_.reserve(chunks);
+    for (std::size_t offset = 0; offset < size; offset += v_chunk_size)
+      file->chunks_.push_back(Op{file, offset, std::min(v_chunk_size, size - offset)});
+    file->ops_.store(static_cast<int>(chunks), std::memory_order_relaxed);
+    for (Op& op : file->chunks_)
+      ops.push_back(&op);
+  }
+  Enqueue(ops);
+}
+
+gdm::JobCounter gdm::IoService::Read(IoRequest* requests, std::size_t count)
+{
+  JobCounter counter;
+  Read(requests, count, counter);
+  return counter;
+}
+
+// --private
+
+void gdm::IoService::Enqueue(std::vector<Op*>& ops)
+{
+  if (ops.empty())
+    return;
+
+  std::lock_guard<std::mutex> lock(lock_);
+  pending_.insert(pending_.end(), ops.begin(), ops.end());
+  if (ring_)
+    SubmitPending();
+  else
+    pending_count_.Post(static_cast<int>(ops.size()));
+}
+
+void gdm::IoService::FinishOp(Op* op, int error)
+{
+  File* file = op->file_;
+  if (error)
+  {
+    int expected = 0;
+    file->error_.compare_exchange_strong(expected, error, std::memory_order_relaxed);
+  }
+  if (file->ops_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    FinishFile(file, file->error_.load(std::memory_order_relaxed));
+}
+
+// Continuation is pushed with the same counter, so counter is not done
+//  before it's finished
+
+void gdm::IoService::FinishFile(File* file, int error)
+{
+  IoRequest& request = *file->request_;
+  if (file->fd_ >= 0)
+    _private::CloseFile(file->fd_);
+  request.error_ = error;
+  if (error)
+    request.data_.clear();
+  if (request.on_done_)
+    mgr_.GetJobQueue().PushJobTS(std::move(request.on_done_), file->counter_);
+  JobCounter::Sub(file->counter_.state_, 1);
+  delete file;
+
+  if (files_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    futex::WakeAll(files_);
+}
+
+// Called under lock. Not more ops than ring size are in flight, so
+//  completion queue (which is twice bigger) never overflows
+
+void gdm::IoService::SubmitPending()
+{
+#if defined(GDM_IO_URING)
+  while (!pending_.empty() && in_flight_ < ring_->entries_)
+  {
+    io_uring_sqe* sqe = ring_->GetSqe();
+    if (!sqe)
+      break;
+    Op* op = pending_.front();
+    pending_.pop_front();
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = op->file_->fd_;
+    sqe->off = op->offset_;
+    sqe->addr = reinterpret_cast<uint64_t>(op->file_->request_->data_.data() + op->offset_);
+    sqe->len = static_cast<unsigned>(op->size_);
+    sqe->user_data = reinterpret_cast<uint64_t>(op);
+    ++in_flight_;
+  }
+  ring_->Submit();
+#endif
+}
+
+// Short reads are resubmitted for the rest of chunk, zero read means that
+//  file was truncated meanwhile
+
+void gdm::IoService::ReapCompletions()
+{
+#if defined(GDM_IO_URING)
+  std::vector<Op*> resubmit;
+  while (running_.load(std::memory_order_acquire) || files_.load(std::memory_order_acquire))
+  {
+    unsigned reaped = 0;
+    while (io_uring_cqe* cqe = ring_->PeekCqe())
+    {
+      Op* op = reinterpret_cast<Op*>(cqe->user_data);
+      const int res = cqe->res;
+      ring_->SeenCqe();
+      if (!op)
+        continue;
+
+      ++reaped;
+      if (res == -EINTR || res == -EAGAIN)
+        resubmit.push_back(op);
+      else if (res < 0)
+        FinishOp(op, -res);
+      else if (res == 0)
+        FinishOp(op, EIO);
+      else if (static_cast<std::size_t>(res) < op->size_)
+      {
+        op->offset_ += res;
+        op->size_ -= res;
+        resubmit.push_back(op);
+      }
+      else
+        FinishOp(op, 0);
+    }
+
+    if (reaped)
+    {
+      std::lock_guard<std::mutex> lock(lock_);
+      in_flight_ -= reaped;
+      pending_.insert(pending_.begin(), resubmit.begin(), resubmit.end());
+      resubmit.clear();
+      SubmitPending();
+    }
+    else if (running_.load(std::memory_order_acquire))
+      ring_->Wait();
+  }
+#endif
+}
+
+void gdm::IoService::ReadChunks()
+{
+  while (true)
+  {
+    pending_count_.Wait();
+    Op* op = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(lock_);
+      op = pending_.front();
+      pending_.pop_front();
+    }
+    if (!op)
+      return;
+
+    int error = 0;
+    unsigned char* data = op->file_->request_->data_.data();
+    while (op->size_ && !error)
+    {
+      const long long read = _private::ReadFileAt(op->file_->fd_, data + op->offset_, op->size_, op->offset_);
+      if (read <= 0)
+        error = read < 0 ? static_cast<int>(-read) : EIO;
+      else
+      {
+        op->offset_ += static_cast<std::size_t>(read);
+        op->size_ -= static_cast<std::size_t>(read);
+      }
+    }
+    FinishOp(op, error);
+  }
+}
+
+void gdm::IoService::RingFunc(IoService* service)
+{
+  service->ReapCompletions();
+}
+
+void gdm::IoService::FallbackFunc(IoService* service)
+{
+  service->ReadChunks();
+}
@@ -0,0 +1,113 @@
+// *************************************************************
+// File:    io_service.h
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#ifndef AH_GDM_IO_SERVICE_H
+#define AH_GDM_IO_SERVICE_H
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "threads/thread.h"
+#include "threads/semaphore.h"
+#include "threads/job_counter.h"
+#include "threads/job_function.h"
+
+namespace gdm {
+
+struct JobManager;
+
+namespace _private {
+
+  struct IoRing;
+
+} // namespace _private
+
+// Request to read whole file. Data is resized to the file size, error is
+//  errno of failed open or read, data is empty then. Request should live
+//  till its counter is done
+
+struct IoRequest
+{
+  std::string path_;
+  std::vector<unsigned char> data_;
+  int error_ = 0;
+  JobFunction<void()> on_done_;
+
+}; // struct IoRequest
+
+// Asynchronous file reads. Files are opened by calling thread and splitted into
+//  chunks, all chunks of one call are submitted at once through io_uring on
+//  linux, so several files and parts of one big file are read in parallel
+//  and device queue is kept busy. Without io_uring (other os, old kernel,
+//  seccomp) chunks are read by fallback threads. Each finished request
+//  subtracts 1 from counter, its continuation is pushed to job manager before
+//  that, so counter is done only after continuations are done too
+
+struct IoService
+{
+  IoService(JobManager& mgr, unsigned queue_depth = 64, unsigned fallback_threads = 4, bool allow_uring = true);
+  IoService(const IoService&) = delete;
+  IoService& operator=(const IoService&) = delete;
+  ~IoService();
+
+  void Read(IoRequest* requests, std::size_t count, JobCounter& counter);
+  auto Read(IoRequest* requests, std::size_t count) -> JobCounter;
+  bool IsUring() const { return ring_ != nullptr; }
+
+  constexpr static std::size_t v_chunk_size = 1 << 20;
+
+private:
+  struct File;
+
+  struct Op
+  {
+    File* file_;
+    std::size_t offset_;
+    std::size_t size_;
+  };
+
+  struct File
+  {
+    IoRequest* request_;
+    int fd_;
+    std::atomic<int> ops_;
+    std::atomic<int> error_;
+    JobCounter counter_;
+    std::vector<Op> chunks_;
+  };
+
+private:
+  void Enqueue(std::vector<Op*>& ops);
+  void FinishOp(Op* op, int error);
+  void FinishFile(File* file, int error);
+  void SubmitPending();
+  void ReapCompletions();
+  void ReadChunks();
+
+private:
+  static void RingFunc(IoService* service);
+  static void FallbackFunc(IoService* service);
+
+private:
+  JobManager& mgr_;
+  std::unique_ptr<_private::IoRing> ring_;
+  std::vector<Thread> threads_;
+  std::mutex lock_;
+  std::deque<Op*> pending_;
+  Semaphore pending_count_;
+  unsigned in_flight_;
+  std::atomic<int> files_;
+  std::atomic<bool> running_;
+
+}; // struct IoService
+
+} // namespace gdm
+
+#endif // AH_GDM_IO_SERVICE_H
@@ -0,0 +1,128 @@
+// *************************************************************
+// File:    job_coroutine.h
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#ifndef AH_GDM_JOB_COROUTINE_H
+#define AH_GDM_JOB_COROUTINE_H
+
+#if defined(__cpp_impl_coroutine)
+
+#include <coroutine>
+
+#include "threads/job_manager.h"
+#include "threads/job_counter.h"
+#include "threads/task.h"
+
+// Any function returning Task<T> with JobManager& as the first argument is a
+//  coroutine job. It starts as usual job on that manager and inside it may
+//  co_await JobCounter or Task<U> (running on any manager, i.e. read on io
+//  pool). While waiting worker is free, coroutine is pushed back to its own
+//  manager when awaited thing is done:
+//
+//    Task<Mesh> LoadMesh(JobManager& mgr, JobManager& io, const char* path)
+//    {
+//      Task<Bytes> bytes = mt::Async(io, [path](){ return ReadFile(path); });
+//      co_return DecodeMesh(co_await bytes);
+//    }
+
+namespace gdm::_private {
+
+  struct ResumeAwaiter
+  {
+    JobManager* mgr_;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) const;
+    void await_resume() const noexcept { }
+
+  }; // struct ResumeAwaiter
+
+  struct CounterAwaiter
+  {
+    JobManager* mgr_;
+    JobCounter counter_;
+    JobCounter::Waiter waiter_;
+
+    bool await_ready() const { return counter_.IsDone(); }
+    void await_suspend(std::coroutine_handle<> handle);
+    void await_resume() const noexcept { }
+
+  }; // struct CounterAwaiter
+
+  template <class T>
+  struct TaskAwaiter
+  {
+    JobManager* mgr_;
+    Task<T> task_;
+
+    bool await_ready() const { return task_.IsReady(); }
+    void await_suspend(std::coroutine_handle<> handle);
+    auto await_resume() const -> std::add_lvalue_reference_t<T>;
+
+  }; // struct TaskAwaiter
+
+  template <class A>
+  struct IsJobAwaitable : std::is_same<A, JobCounter> { };
+  template <class T>
+  struct IsJobAwaitable<Task<T>> : std::true_type { };
+
+  // Coroutine owns one reference to the task state and completes it when
+  //  frame is destroyed, so all locals are gone by then
+
+  template <class T>
+  struct TaskPromiseBase
+  {
+    template <class... Args>
+    TaskPromiseBase(JobManager& mgr, Args&...);
+    ~TaskPromiseBase();
+
+    auto get_return_object() -> Task<T>;
+    auto initial_suspend() -> ResumeAwaiter { return ResumeAwaiter{mgr_}; }
+    auto final_suspend() noexcept -> std::suspend_never { return {}; }
+    void unhandled_exception();
+
+    auto await_transform(const JobCounter& counter) -> CounterAwaiter;
+    template <class U>
+    auto await_transform(const Task<U>& task) -> TaskAwaiter<U>;
+    template <class Awaitable, class = std::enable_if_t<!IsJobAwaitable<std::decay_t<Awaitable>>::value>>
+    auto await_transform(Awaitable&& awaitable) -> Awaitable&&;
+
+    JobManager* mgr_;
+    TaskState<T>* state_;
+
+  }; // struct TaskPromiseBase
+
+  template <class T>
+  struct TaskPromise : TaskPromiseBase<T>
+  {
+    using TaskPromiseBase<T>::TaskPromiseBase;
+
+    template <class U>
+    void return_value(U&& value);
+
+  }; // struct TaskPromise
+
+  template <>
+  struct TaskPromise<void> : TaskPromiseBase<void>
+  {
+    using TaskPromiseBase<void>::TaskPromiseBase;
+
+    void return_void() { }
+
+  }; // struct TaskPromise
+
+} // namespace gdm::_private
+
+template <class T, class... Args>
+struct std::coroutine_traits<gdm::Task<T>, gdm::JobManager&, Args...>
+{
+  using promise_type = gdm::_private::TaskPromise<T>;
+};
+
+#include "job_coroutine.inl"
+
+#endif // __cpp_impl_coroutine
+
+#endif // AH_GDM_JOB_COROUTINE_H
@@ -0,0 +1,94 @@
+// *************************************************************
+// File:    job_coroutine.inl
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#include "job_coroutine.h"
+
+#include <exception>
+#include <utility>
+
+//--private
+
+inline void gdm::_private::ResumeAwaiter::await_suspend(std::coroutine_handle<> handle) const
+{
+  mgr_->Spawn(Job{[handle](){ handle.resume(); }, Job::SINGLE});
+}
+
+// Waiter lives in the coroutine frame, so waiting doesn't allocate
+
+inline void gdm::_private::CounterAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+  waiter_.func_ = [mgr = mgr_, handle](){ ResumeAwaiter{mgr}.await_suspend(handle); };
+  counter_.Subscribe(&waiter_);
+}
+
+template <class T>
+inline void gdm::_private::TaskAwaiter<T>::await_suspend(std::coroutine_handle<> handle)
+{
+  auto call = [mgr = mgr_, handle](){ ResumeAwaiter{mgr}.await_suspend(handle); };
+  task_.GetState()->Subscribe(new TaskContinuation{std::move(call), nullptr, true});
+}
+
+template <class T>
+inline auto gdm::_private::TaskAwaiter<T>::await_resume() const -> std::add_lvalue_reference_t<T>
+{
+  if constexpr (!std::is_void_v<T>)
+    return task_.Get();
+}
+
+template <class T>
+template <class... Args>
+inline gdm::_private::TaskPromiseBase<T>::TaskPromiseBase(JobManager& mgr, Args&...)
+  : mgr_{&mgr}
+  , state_{new TaskState<T>(&mgr, 1)}
+{ }
+
+template <class T>
+inline gdm::_private::TaskPromiseBase<T>::~TaskPromiseBase()
+{
+  state_->Complete();
+  TaskStateBase::Release(state_);
+}
+
+template <class T>
+inline auto gdm::_private::TaskPromiseBase<T>::get_return_object() -> Task<T>
+{
+  state_->AddRef();
+  return Task<T>{state_};
+}
+
+template <class T>
+inline void gdm::_private::TaskPromiseBase<T>::unhandled_exception()
+{
+  std::terminate();
+}
+
+template <class T>
+inline auto gdm::_private::TaskPromiseBase<T>::await_transform(const JobCounter& counter) -> CounterAwaiter
+{
+  return CounterAwaiter{mgr_, counter, {}};
+}
+
+template <class T>
+template <class U>
+inline auto gdm::_private::TaskPromiseBase<T>::await_transform(const Task<U>& task) -> TaskAwaiter<U>
+{
+  return TaskAwaiter<U>{mgr_, task};
+}
+
+template <class T>
+template <class Awaitable, class>
+inline auto gdm::_private::TaskPromiseBase<T>::await_transform(Awaitable&& awaitable) -> Awaitable&&
+{
+  return std::forward<Awaitable>(awaitable);
+}
+
+template <class T>
+template <class U>
+inline void gdm::_private::TaskPromise<T>::return_value(U&& value)
+{
+  auto make = [&value](){ return T(std::forward<U>(value)); };
+  this->state_->Run(make);
+}
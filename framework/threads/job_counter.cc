@@ -0,0 +1,139 @@
+// *************************************************************
+// File:    job_counter.cc
+// Author:  Novoselov Anton @ 2018
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#include "job_counter.h"
+
+#include <utility>
+
+// --public
+
+gdm::JobCounter::JobCounter() noexcept
+  : state_{nullptr}
+{ }
+
+gdm::JobCounter::JobCounter(const JobCounter& other) noexcept
+  : state_{other.state_}
+{
+  if (state_)
+    state_->refs_.fetch_add(1, std::memory_order_relaxed);
+}
+
+gdm::JobCounter::JobCounter(JobCounter&& other) noexcept
+  : state_{std::exchange(other.state_, nullptr)}
+{ }
+
+gdm::JobCounter& gdm::JobCounter::operator=(const JobCounter& other) noexcept
+{
+  if (state_ == other.state_)
+    return *this;
+
+  Release();
+  state_ = other.state_;
+  if (state_)
+    state_->refs_.fetch_add(1, std::memory_order_relaxed);
+  return *this;
+}
+
+gdm::JobCounter& gdm::JobCounter::operator=(JobCounter&& other) noexcept
+{
+  if (this == &other)
+    return *this;
+
+  Release();
+  state_ = std::exchange(other.state_, nullptr);
+  return *this;
+}
+
+gdm::JobCounter::~JobCounter()
+{
+  Release();
+}
+
+int gdm::JobCounter::GetValue() const
+{
+  return state_ ? state_->pending_.load(std::memory_order_acquire) : 0;
+}
+
+bool gdm::JobCounter::IsDone() const
+{
+  return GetValue() == 0;
+}
+
+// Waiter is pushed first and counter is checked after, while finishing job
+//  does it in reverse order, so either of them takes the waiter. Empty
+//  counter calls waiter at once
+
+void gdm::JobCounter::Subscribe(Waiter* waiter) const
+{
+  if (!state_)
+  {
+    waiter->func_();
+    return;
+  }
+
+  Waiter* head = state_->waiters_.load(std::memory_order_relaxed);
+  do
+    waiter->next_ = head;
+  while (!state_->waiters_.compare_exchange_weak(head, waiter, std::memory_order_seq_cst, std::memory_order_relaxed));
+
+  if (state_->pending_.load(std::memory_order_seq_cst) == 0)
+    Notify(state_);
+}
+
+gdm::JobCounter gdm::JobCounter::Create()
+{
+  JobCounter counter;
+  counter.state_ = new State{{0}, {1}, {nullptr}};
+  return counter;
+}
+
+// --private
+
+// Jobs are pushed only after Add, so transition from zero can't race with
+//  finishing of the same jobs and the caller's handle keeps state alive
+
+void gdm::JobCounter::Add(int count)
+{
+  if (state_->pending_.fetch_add(count, std::memory_order_relaxed) == 0)
+    state_->refs_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void gdm::JobCounter::Release() noexcept
+{
+  if (state_)
+    Release(state_);
+  state_ = nullptr;
+}
+
+// --private static
+
+void gdm::JobCounter::Sub(State* state, int count)
+{
+  if (state->pending_.fetch_sub(count, std::memory_order_seq_cst) == count)
+  {
+    Notify(state);
+    Release(state);
+  }
+}
+
+// Next is read before call since waiter may be destroyed by resumed owner
+
+void gdm::JobCounter::Notify(State* state)
+{
+  Waiter* waiter = state->waiters_.exchange(nullptr, std::memory_order_seq_cst);
+  while (waiter)
+  {
+    Waiter* next = waiter->next_;
+    waiter->func_();
+    waiter = next;
+  }
+}
+
+void gdm::JobCounter::Release(State* state) noexcept
+{
+  if (state->refs_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    delete state;
+}
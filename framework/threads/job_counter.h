@@ -0,0 +1,71 @@
+// *************************************************************
+// File:    job_counter.h
+// Author:  Novoselov Anton @ 2018
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#ifndef AH_GDM_JOB_COUNTER_H
+#define AH_GDM_JOB_COUNTER_H
+
+#include <atomic>
+
+#include "threads/job_function.h"
+
+namespace gdm {
+
+// Handle to amount of not finished work of one or several submissions (single
+// job counts as 1, batch as its data size). Copies share the same counter.
+// Jobs hold raw pointer, while something is pending counter keeps one extra
+// reference to itself, so jobs don't touch refcount. Empty handle is always done.
+// Waiters are called once when counter reaches zero, used to resume coroutines
+
+struct JobCounter
+{
+  struct Waiter
+  {
+    JobFunction<void()> func_;
+    Waiter* next_;
+  };
+
+  JobCounter() noexcept;
+  JobCounter(const JobCounter& other) noexcept;
+  JobCounter(JobCounter&& other) noexcept;
+  JobCounter& operator=(const JobCounter& other) noexcept;
+  JobCounter& operator=(JobCounter&& other) noexcept;
+  ~JobCounter();
+
+  auto GetValue() const -> int;
+  bool IsDone() const;
+  explicit operator bool() const noexcept { return state_ != nullptr; }
+  void Subscribe(Waiter* waiter) const;
+
+  static auto Create() -> JobCounter;
+
+private:
+  struct State
+  {
+    std::atomic<int> pending_;
+    std::atomic<int> refs_;
+    std::atomic<Waiter*> waiters_;
+  };
+
+  void Add(int count);
+  void Release() noexcept;
+
+  static void Sub(State* state, int count);
+  static void Notify(State* state);
+  static void Release(State* state) noexcept;
+
+private:
+  State* state_;
+
+private:
+  friend struct Job;
+  friend struct JobQueue;
+  friend struct IoService;
+
+}; // struct JobCounter
+
+} // namespace gdm
+
+#endif // AH_GDM_JOB_COUNTER_H
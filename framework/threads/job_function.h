@@ -0,0 +1,70 @@
+// *************************************************************
+// File:    job_function.h
+// Author:  Novoselov Anton @ 2018
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#ifndef AH_GDM_JOB_FUNCTION_H
+#define AH_GDM_JOB_FUNCTION_H
+
+#include <cstddef>
+#include <type_traits>
+
+namespace gdm {
+
+// Move-only callable of one cache line size. Small functors are stored
+// inline, captures bigger than v_inline_size fall back to the heap
+
+template <class Signature>
+struct JobFunction;
+
+template <class R, class... Args>
+struct JobFunction<R(Args...)>
+{
+  constexpr static std::size_t v_size = 64;
+  constexpr static std::size_t v_inline_size = v_size - 2 * sizeof(void*);
+
+  JobFunction() noexcept;
+  JobFunction(std::nullptr_t) noexcept;
+  template <class Fn, class = std::enable_if_t<!std::is_same_v<std::decay_t<Fn>, JobFunction>>>
+  JobFunction(Fn&& fn);
+  JobFunction(JobFunction&& other) noexcept;
+  JobFunction& operator=(JobFunction&& other) noexcept;
+  JobFunction(const JobFunction&) = delete;
+  JobFunction& operator=(const JobFunction&) = delete;
+  ~JobFunction();
+
+  auto operator()(Args... args) const -> R;
+  explicit operator bool() const noexcept { return invoke_ != nullptr; }
+
+public:
+  template <class Fn>
+  constexpr static bool IsInline();
+
+private:
+  enum EOperation { MOVE, DESTROY };
+
+  using InvokeFn = R(*)(void* storage, Args&&... args);
+  using ManageFn = void(*)(EOperation op, void* dst, void* src);
+
+  template <class Fn>
+  static auto Invoke(void* storage, Args&&... args) -> R;
+  template <class Fn>
+  static void Manage(EOperation op, void* dst, void* src);
+  template <class Fn>
+  static auto GetFunctor(void* storage) -> Fn*;
+
+  void Reset() noexcept;
+
+private:
+  alignas(std::max_align_t) mutable unsigned char storage_[v_inline_size];
+  InvokeFn invoke_;
+  ManageFn manage_;
+
+}; // struct JobFunction
+
+} // namespace gdm
+
+#include "job_function.inl"
+
+#endif // AH_GDM_JOB_FUNCTION_H
@@ -0,0 +1,141 @@
+// *************************************************************
+// File:    job_function.inl
+// Author:  Novoselov Anton @ 2018
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#include "job_function.h"
+
+#include <new>
+#include <utility>
+#include <functional>
+#include <assert.h>
+
+// --public
+
+template <class R, class... Args>
+inline gdm::JobFunction<R(Args...)>::JobFunction() noexcept
+  : invoke_{nullptr}
+  , manage_{nullptr}
+{
+  static_assert(sizeof(JobFunction) == v_size);
+}
+
+template <class R, class... Args>
+inline gdm::JobFunction<R(Args...)>::JobFunction(std::nullptr_t) noexcept
+  : JobFunction()
+{ }
+
+template <class R, class... Args>
+template <class Fn, class>
+inline gdm::JobFunction<R(Args...)>::JobFunction(Fn&& fn)
+  : invoke_{&Invoke<std::decay_t<Fn>>}
+  , manage_{&Manage<std::decay_t<Fn>>}
+{
+  using Functor = std::decay_t<Fn>;
+
+  if constexpr (IsInline<Functor>())
+    new(storage_) Functor(std::forward<Fn>(fn));
+  else
+    new(storage_) Functor*(new Functor(std::forward<Fn>(fn)));
+}
+
+template <class R, class... Args>
+inline gdm::JobFunction<R(Args...)>::JobFunction(JobFunction&& other) noexcept
+  : invoke_{other.invoke_}
+  , manage_{other.manage_}
+{
+  if (manage_)
+    manage_(MOVE, storage_, other.storage_);
+  other.invoke_ = nullptr;
+  other.manage_ = nullptr;
+}
+
+template <class R, class... Args>
+inline auto gdm::JobFunction<R(Args...)>::operator=(JobFunction&& other) noexcept -> JobFunction&
+{
+  if (this == &other)
+    return *this;
+
+  Reset();
+  invoke_ = other.invoke_;
+  manage_ = other.manage_;
+  if (manage_)
+    manage_(MOVE, storage_, other.storage_);
+  other.invoke_ = nullptr;
+  other.manage_ = nullptr;
+  return *this;
+}
+
+template <class R, class... Args>
+inline gdm::JobFunction<R(Args...)>::~JobFunction()
+{
+  Reset();
+}
+
+template <class R, class... Args>
+inline R gdm::JobFunction<R(Args...)>::operator()(Args... args) const
+{
+  assert(invoke_ && "Empty job function");
+  return invoke_(storage_, std::forward<Args>(args)...);
+}
+
+template <class R, class... Args>
+template <class Fn>
+inline constexpr bool gdm::JobFunction<R(Args...)>::IsInline()
+{
+  return sizeof(Fn) <= v_inline_size &&
+         alignof(Fn) <= alignof(std::max_align_t) &&
+         std::is_nothrow_move_constructible_v<Fn>;
+}
+
+// --private
+
+template <class R, class... Args>
+template <class Fn>
+inline auto gdm::JobFunction<R(Args...)>::GetFunctor(void* storage) -> Fn*
+{
+  if constexpr (IsInline<Fn>())
+    return std::launder(reinterpret_cast<Fn*>(storage));
+  else
+    return *std::launder(reinterpret_cast<Fn**>(storage));
+}
+
+template <class R, class... Args>
+template <class Fn>
+inline R gdm::JobFunction<R(Args...)>::Invoke(void* storage, Args&&... args)
+{
+  if constexpr (std::is_void_v<R>)
+    std::invoke(*GetFunctor<Fn>(storage), std::forward<Args>(args)...);
+  else
+    return std::invoke(*GetFunctor<Fn>(storage), std::forward<Args>(args)...);
+}
+
+template <class R, class... Args>
+template <class Fn>
+inline void gdm::JobFunction<R(Args...)>::Manage(EOperation op, void* dst, void* src)
+{
+  if constexpr (IsInline<Fn>())
+  {
+    Fn* functor = GetFunctor<Fn>(src);
+    if (op == MOVE)
+      new(dst) Fn(std::move(*functor));
+    functor->~Fn();
+  }
+  else
+  {
+    if (op == MOVE)
+      new(dst) Fn*(GetFunctor<Fn>(src));
+    else
+      delete GetFunctor<Fn>(src);
+  }
+}
+
+template <class R, class... Args>
+inline void gdm::JobFunction<R(Args...)>::Reset() noexcept
+{
+  if (manage_)
+    manage_(DESTROY, nullptr, storage_);
+  invoke_ = nullptr;
+  manage_ = nullptr;
+}
@@ -0,0 +1,104 @@
+// *************************************************************
+// File:    job_graph.cc
+// Author:  Novoselov Anton @ 2018
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#include "job_graph.h"
+
+#include <assert.h>
+
+// --public
+
+gdm::JobGraph::JobGraph()
+  : nodes_{}
+  , wait_deps_{}
+  , wait_parts_{}
+  , prepared_count_{0}
+  , remaining_nodes_{0}
+{ }
+
+auto gdm::JobGraph::AddJob(Job::CbSingle func) -> NodeId
+{
+  assert(IsDone() && "Graph is modified while executing");
+  nodes_.push_back(Node{std::move(func), {}, 0, 0, 0, {}});
+  return static_cast<NodeId>(nodes_.size() - 1);
+}
+
+auto gdm::JobGraph::AddBatch(Job::CbBatch func, int batch_size, std::size_t data_size) -> NodeId
+{
+  assert(IsDone() && "Graph is modified while executing");
+  assert(batch_size > 0);
+  nodes_.push_back(Node{{}, std::move(func), batch_size, static_cast<int>(data_size), 0, {}});
+  return static_cast<NodeId>(nodes_.size() - 1);
+}
+
+void gdm::JobGraph::AddEdge(NodeId before, NodeId after)
+{
+  assert(IsDone() && "Graph is modified while executing");
+  assert(before != after);
+  assert(before < GetNodesCount() && after < GetNodesCount());
+  nodes_[before].successors_.push_back(after);
+  ++nodes_[after].dependencies_;
+}
+
+void gdm::JobGraph::Clear()
+{
+  assert(IsDone() && "Graph is modified while executing");
+  nodes_.clear();
+  wait_deps_.reset();
+  wait_parts_.reset();
+  prepared_count_ = 0;
+}
+
+bool gdm::JobGraph::IsDone() const
+{
+  return remaining_nodes_.load(std::memory_order_acquire) == 0;
+}
+
+// Kahn's algorithm, used only in asserts
+
+bool gdm::JobGraph::IsAcyclic() const
+{
+  std::vector<int> deps (nodes_.size(), 0);
+  std::vector<NodeId> ready {};
+  for (NodeId i = 0; i < GetNodesCount(); ++i)
+  {
+    deps[i] = nodes_[i].dependencies_;
+    if (deps[i] == 0)
+      ready.push_back(i);
+  }
+
+  int visited = 0;
+  while (!ready.empty())
+  {
+    NodeId node = ready.back();
+    ready.pop_back();
+    ++visited;
+    for (NodeId next : nodes_[node].successors_)
+      if (--deps[next] == 0)
+        ready.push_back(next);
+  }
+  return visited == GetNodesCount();
+}
+
+// --private
+
+void gdm::JobGraph::Prepare()
+{
+  const std::size_t count = nodes_.size();
+  if (prepared_count_ != count)
+  {
+    wait_deps_ = std::make_unique<std::atomic<int>[]>(count);
+    wait_parts_ = std::make_unique<std::atomic<int>[]>(count);
+    prepared_count_ = count;
+  }
+
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    const Node& node = nodes_[i];
+    wait_deps_[i] = node.dependencies_;
+    wait_parts_[i] = node.batch_ ? (node.data_size_ + node.batch_size_ - 1) / node.batch_size_ : 1;
+  }
+  remaining_nodes_.store(static_cast<int>(count), std::memory_order_release);
+}
@@ -0,0 +1,67 @@
+// *************************************************************
+// File:    job_graph.h
+// Author:  Novoselov Anton @ 2018
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#ifndef AH_GDM_JOB_GRAPH_H
+#define AH_GDM_JOB_GRAPH_H
+
+#include <vector>
+#include <memory>
+#include <atomic>
+
+#include "threads/job_queue.h"
+
+namespace gdm {
+
+// Graph is declared once and may be submitted to JobManager many times
+// (i.e. each frame), but only after previous submission is done. Every
+// node keeps counter of unfinished predecessors, when it reaches zero
+// the node is pushed to workers - so no global barriers are involved
+
+struct JobGraph
+{
+  using NodeId = int;
+
+  JobGraph();
+  JobGraph(const JobGraph&) = delete;
+  JobGraph& operator=(const JobGraph&) = delete;
+
+  auto AddJob(Job::CbSingle func) -> NodeId;
+  auto AddBatch(Job::CbBatch func, int batch_size, std::size_t data_size) -> NodeId;
+  void AddEdge(NodeId before, NodeId after);
+  void Clear();
+
+  bool IsDone() const;
+  bool IsAcyclic() const;
+  auto GetNodesCount() const -> int { return static_cast<int>(nodes_.size()); }
+
+private:
+  void Prepare();
+
+private:
+  struct Node
+  {
+    Job::CbSingle single_;
+    Job::CbBatch batch_;
+    int batch_size_;
+    int data_size_;
+    int dependencies_;
+    std::vector<NodeId> successors_;
+  };
+
+  std::vector<Node> nodes_;
+  std::unique_ptr<std::atomic<int>[]> wait_deps_;
+  std::unique_ptr<std::atomic<int>[]> wait_parts_;
+  std::size_t prepared_count_;
+  std::atomic<int> remaining_nodes_;
+
+private:
+  friend struct JobManager;
+
+}; // struct JobGraph
+
+} // namespace gdm
+
+#endif // AH_GDM_JOB_GRAPH_H
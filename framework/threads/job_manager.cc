@@ -12,8 +12,11 @@
 #include <time.h>
 #include <chrono>
 #include <string.h>
+#include <algorithm>
 
 #include "threads/scoped_locks.h"
+#include "threads/futex.h"
+#include "threads/backoff.h"
 
 #include "system/profiler.h"
 #include "system/event_point.h"
@@ -21,49 +24,105 @@
 // -- log macro
 
 #define FMT_SMPL "#%d %s\t\n", worker_num, GDM_EVENT_STR
-#define FMT_STAT "#%d %s %d %lu\t\n", worker_num, GDM_EVENT_STR, s_stat.running_jobs.load(), mgr.queue_.pending_jobs_.size()
-#define FMT_STAT2 "#%d %s %d %lu\t\n", s_tls.worker_num, GDM_EVENT_STR, s_stat.running_jobs.load(), queue_.pending_jobs_.size()
+#define FMT_STAT "#%d %s %d %lu\t\n", worker_num, GDM_EVENT_STR, mgr.stat_.running_jobs.load(), mgr.queue_.GetSize()
+#define FMT_STAT2 "#%d %s %d %lu\t\n", s_tls.worker_num, GDM_EVENT_STR, stat_.running_jobs.load(), queue_.GetSize()
 
 // --private
 
-struct TLS
+// Each worker belongs to exactly one manager, so per thread data is valid
+//  only when manager is the one who asks
+
+static struct TLS
 {
   char worker_name[256] = ""; 
   unsigned worker_num = 0;
+  gdm::JobManager* manager = nullptr;
+  const gdm::JobManager* background_manager = nullptr;
+  uint64_t background_start_ns = 0;
 } thread_local s_tls;
 
-gdm::JobManager::RuntimeStat gdm::JobManager::s_stat = {};
+// Same as GDM_TRY_LOCK_FOR, but clock for telemetry is read only when the
+//  queue is contended
+
+static std::unique_lock<std::timed_mutex> TryLockQueue(std::timed_mutex& mx, gdm::_private::JobCounters& counters)
+{
+  std::unique_lock<std::timed_mutex> lock(mx, std::try_to_lock);
+  if (!lock.owns_lock())
+  {
+    CPU_PROFILE_ENTER("Mutex", "mx:wt", gdm::core::COLOR_WHITESMOKE);
+    const uint64_t start = gdm::_private::JobCounters::Now();
+    lock.try_lock_for(std::chrono::microseconds(100));
+    counters.AddLockWait(start);
+    CPU_PROFILE_LEAVE();
+  }
+  return lock;
+}
 
 // --public
 
-gdm::JobManager::JobManager(core::JobManagerProps flags)
-  : main_cpu_{0}
+gdm::JobManager::JobManager(core::JobManagerProps flags, unsigned workers_count, core::Priority priority, const char* name)
+  : flags_{flags}
+  , main_cpu_{CpuTopology::GetCurrentCpu()}
   , cpu_count_{std::thread::hardware_concurrency()}
-  , flags_{flags}
+  , thread_pool_{}
+  , thread_status_(workers_count ? workers_count : std::thread::hardware_concurrency() - 1)
+  , local_jobs_{}
+  , job_pool_{static_cast<unsigned>(thread_status_.size())}
   , queue_{}
-  , thread_status_(std::thread::hardware_concurrency() - 1,0)
+  , stat_{}
+  , name_{name}
+  , wake_cursor_{0}
+  , counters_(thread_status_.size() + 1)
+  , dump_lock_{}
+  , next_dump_ns_{0}
+  , dump_period_ns_{0}
+  , dump_file_{nullptr}
+  , last_dump_{}
+  , background_budget_ns_{0}
+  , background_spent_ns_{0}
+  , frame_arenas_{FrameArenas::v_default_size}
 {
-  s_stat.running_jobs = 0;
-  s_stat.workers_stopped = 0;
+  queue_.manager_ = this;
+  counters_.back().shared_ = true;
+
+  const unsigned workers = static_cast<unsigned>(thread_status_.size());
+
+  if (flags_ & core::WORK_STEALING)
+  {
+    queue_.lazy_batches_ = true;
+    local_jobs_.reserve(workers);
+    for (unsigned i = 0; i < workers; ++i)
+      local_jobs_.push_back(std::make_unique<WorkStealingDeque<Job*>>());
+  }
+
+  const CpuTopology topology = CpuTopology::Probe();
+  const std::vector<unsigned> placement = topology.MakePlacement(flags_ & core::PLACE_MASK, workers, main_cpu_);
 
   int done = 1;
-  thread_pool_.reserve(cpu_count_-1);
-  for (unsigned i = 0; i < cpu_count_-1; ++i)
+  thread_pool_.reserve(workers);
+  for (unsigned i = 0; i < workers; ++i)
   {
     thread_pool_.emplace_back(WorkerFunc, this, i);
-    done = thread_pool_.back().SetProcessor(i);
-    done &= thread_pool_.back().SetPriority(core::ABOVE_NORMAL);
+    if (!placement.empty())
+      done &= thread_pool_.back().SetProcessor(placement[i]);
+    done &= thread_pool_.back().SetPriority(priority);
     thread_pool_.back().Detach();
   }
   if(!done)
-      printf("can't change threads property (priority, processor, etc)\n");
+      fprintf(stderr, "can't change threads property (priority, processor, etc)\n");
 }
 
 gdm::JobManager::~JobManager()
 {
   for (unsigned i = 0; i < thread_pool_.size(); ++i)
     thread_pool_[i].SetRunning(false);
-  while(s_stat.workers_stopped != thread_pool_.size()) { }
+  WakeUpThreads(GetWorkersCount());
+  while(stat_.workers_stopped != thread_pool_.size()) { }
+
+  Job* job = nullptr;
+  for (auto& local_jobs : local_jobs_)
+    while (local_jobs->Pop(job))
+      job_pool_.Delete(GetWorkersCount(), job);
 }
 
 gdm::JobQueue& gdm::JobManager::GetJobQueue()
@@ -77,7 +136,6 @@ void gdm::JobManager::WaitOnBarrier()
 
   std::promise<void> signal {};
   queue_.PushBarrier([&signal](){ signal.set_value(); });
-  WakeUpThreads();
   signal.get_future().wait();
 }
 
@@ -86,62 +144,559 @@ void gdm::JobManager::WaitOnBarrierTS()
   GDM_EVENT_POINT("WaitOnBarrier", GDM_CPU_G("WorkerGrp", core::COLOR_MEDIUMAQUAMARINE) GDM_LOG_E());
   std::promise<void> signal;
   queue_.PushBarrierTS([&signal](){ signal.set_value(); });
-  WakeUpThreads();
   signal.get_future().wait();
 }
 
+// Waits only for jobs attached to the counter, meanwhile executes any pending
+//  jobs on the calling thread. Background jobs paused by spent budget are not
+//  executed, so wait on them lasts till the next BeginFrame() and never ends
+//  on the thread which calls it
+
+void gdm::JobManager::WaitOnCounter(const JobCounter& counter)
+{
+  GDM_EVENT_POINT("WaitOnCounter", GDM_CPU_G("WorkerGrp", core::COLOR_MEDIUMAQUAMARINE) GDM_LOG_E());
+  while (!counter.IsDone())
+  {
+    if (!HelpExecute())
+      std::this_thread::yield();
+  }
+}
+
+// Graph nodes are pushed as soon as their counters reach zero, so only
+//  jobs of the graph are ordered and other work runs untouched
+
+void gdm::JobManager::SubmitGraph(JobGraph& graph)
+{
+  GDM_EVENT_POINT("SubmitGraph", GDM_CPU_G("WorkerGrp", core::COLOR_MEDIUMAQUAMARINE) GDM_LOG_E());
+  assert(graph.IsDone() && "Graph is already submitted");
+  assert(graph.IsAcyclic() && "Graph has cycles");
+
+  graph.Prepare();
+  for (JobGraph::NodeId node = 0; node < graph.GetNodesCount(); ++node)
+  {
+    if (graph.nodes_[node].dependencies_ == 0)
+      SpawnGraphNode(graph, node);
+  }
+}
+
+void gdm::JobManager::WaitOnGraph(const JobGraph& graph)
+{
+  GDM_EVENT_POINT("WaitOnGraph", GDM_CPU_G("WorkerGrp", core::COLOR_MEDIUMAQUAMARINE) GDM_LOG_E());
+  while (!graph.IsDone())
+  {
+    if (!HelpExecute())
+      std::this_thread::yield();
+  }
+}
+
+// Counters are read without stopping workers, so values of one worker may be
+//  slightly inconsistent with each other
+
+gdm::JobTelemetry gdm::JobManager::GetTelemetry() const
+{
+  JobTelemetry telemetry;
+  for (const _private::JobCounters& counters : counters_)
+    telemetry.workers_.push_back(counters.Read());
+  return telemetry;
+}
+
+// Workers print counters of the last period when they notice it's passed,
+//  so idle pool prints nothing. Zero period disables dump. Unfinished period
+//  of previous settings is printed at once, so dumps always sum up to the
+//  whole time when dump was enabled
+
+void gdm::JobManager::SetTelemetryDump(unsigned period_ms, FILE* file)
+{
+  std::lock_guard<std::mutex> lock(dump_lock_);
+  JobTelemetry telemetry = GetTelemetry();
+  if (next_dump_ns_.load(std::memory_order_relaxed))
+    PrintTelemetry(telemetry);
+  dump_period_ns_ = period_ms * 1'000'000ull;
+  dump_file_ = file;
+  last_dump_ = std::move(telemetry);
+  next_dump_ns_.store(period_ms ? _private::JobCounters::Now() + dump_period_ns_ : 0, std::memory_order_release);
+}
+
+// Cpu time of background jobs per frame summed over all threads, when it's
+//  spent background lane is paused till the next frame. Running jobs are not
+//  interrupted, long ones should check IsBackgroundBudgetSpent() between
+//  steps. Zero budget is unlimited. Frame thread shouldn't wait on background
+//  work (see WaitOnCounter), it checks IsDone() of the counter instead
+
+void gdm::JobManager::SetBackgroundBudget(unsigned budget_us)
+{
+  background_budget_ns_.store(budget_us * 1000ull, std::memory_order_relaxed);
+  if (!budget_us)
+    ResumeBackground();
+}
+
+// Also flips frame arenas, scratch memory of jobs from the previous frame
+//  stays valid during this one
+
+void gdm::JobManager::BeginFrame()
+{
+  frame_arenas_.BeginFrame();
+  background_spent_ns_.store(0, std::memory_order_relaxed);
+  ResumeBackground();
+}
+
+// Includes time of background job which is running on the calling thread
+
+bool gdm::JobManager::IsBackgroundBudgetSpent() const
+{
+  const uint64_t budget = background_budget_ns_.load(std::memory_order_relaxed);
+  if (!budget)
+    return false;
+  uint64_t spent = background_spent_ns_.load(std::memory_order_relaxed);
+  if (s_tls.background_manager == this)
+    spent += _private::JobCounters::Now() - s_tls.background_start_ns;
+  return spent >= budget;
+}
+
+// Splitting hint for lazily splitted work: somebody is idle or worker's
+//  deque is empty, which means previous split was stolen
+
+bool gdm::JobManager::HasStealDemand() const
+{
+  if (stat_.sleeping_workers.load(std::memory_order_relaxed) > 0 || stat_.spinning_workers.load(std::memory_order_relaxed) > 0)
+    return true;
+  if ((flags_ & core::WORK_STEALING) && s_tls.manager == this)
+    return local_jobs_[s_tls.worker_num]->IsEmpty();
+  return false;
+}
+
+// Pushes job from any thread. Workers in work stealing mode push into own deque,
+//  others go through the shared queue
+
+void gdm::JobManager::Spawn(Job&& job)
+{
+  if ((flags_ & core::WORK_STEALING) && s_tls.manager == this)
+  {
+    ++stat_.running_jobs;
+    local_jobs_[s_tls.worker_num]->Push(job_pool_.New(s_tls.worker_num, std::move(job)));
+  }
+  else
+  {
+    GDM_UNIQUE_LOCK(queue_.lock_, "mx::sp", core::COLOR_WHITESMOKE);
+    Job chunk;
+    while (!queue_.lazy_batches_ && job.SplitFront(chunk))
+      queue_.Push(std::move(chunk));
+    queue_.Push(std::move(job));
+  }
+  WakeUpThreads(1);
+}
+
+// Executes one pending job (except barriers) on the calling thread, used by
+//  waiting functions to not block while there is work. Workers in locked
+//  mode have no deques and take jobs from the shared queue like other
+//  threads, otherwise nested wait on the only worker never finishes
+
+bool gdm::JobManager::HelpExecute()
+{
+  const bool is_worker = s_tls.manager == this;
+  if (is_worker && (flags_ & core::WORK_STEALING))
+  {
+    Job* job = GetLocalJob(s_tls.worker_num);
+    if (job)
+      ExecuteLocalJob(job, s_tls.worker_num);
+    return job != nullptr;
+  }
+
+  _private::JobCounters& counters = GetCounters();
+  Job job;
+  bool found = false;
+  for (auto& local_jobs : local_jobs_)
+  {
+    Job* stolen = nullptr;
+    if (local_jobs->Steal(stolen))
+    {
+      job = std::move(*stolen);
+      job_pool_.Delete(GetWorkersCount(), stolen);
+      found = true;
+      counters.Add(counters.steals_, 1);
+      break;
+    }
+  }
+
+  if (!found)
+  {
+    std::unique_lock<std::timed_mutex> lock = TryLockQueue(queue_.GetMutex(), counters);
+    if (!lock.owns_lock())
+      return false;
+    Job::EPriority lane = queue_.SelectLane(false);
+    if (lane == Job::PRIORITIES_COUNT)
+      return false;
+    counters.AddDepth(queue_.GetSize());
+    job = queue_.Pop(lane);
+    ++stat_.running_jobs;
+  }
+
+  if (DropCancelled(job))
+    return true;
+
+  // no deque to split into - execute one chunk and return the rest to the
+  //  shared queue
+
+  Job chunk;
+  if (job.SplitFront(chunk))
+  {
+    Spawn(std::move(job));
+    job = std::move(chunk);
+  }
+
+  // worker is already marked busy by its loop
+
+  if (is_worker)
+  {
+    ExecuteJob(job);
+    return true;
+  }
+
+  const uint64_t busy_start = _private::JobCounters::Now();
+  ExecuteJob(job);
+  counters.Add(counters.time_ns_[_private::JobCounters::BUSY], _private::JobCounters::Now() - busy_start);
+  return true;
+}
+
+// Safe point for long background jobs: runs pending critical jobs on the
+//  calling thread, then the caller continues its own work
+
+bool gdm::JobManager::YieldToCritical()
+{
+  bool yielded = false;
+  while (queue_.HasCriticalJobs())
+  {
+    Job job;
+    {
+      GDM_UNIQUE_LOCK(queue_.lock_, "mx::yc", core::COLOR_WHITESMOKE);
+      if (queue_.pending_jobs_[Job::CRITICAL].empty())
+        break;
+      job = queue_.Pop(Job::CRITICAL);
+      ++stat_.running_jobs;
+    }
+    GDM_EVENT_POINT("yield", GDM_CPU_G("WorkerGrp", core::COLOR_INDIANRED2) GDM_LOG_E());
+    if ((flags_ & core::WORK_STEALING) && s_tls.manager == this)
+      ExecuteLocalJob(job_pool_.New(s_tls.worker_num, std::move(job)), s_tls.worker_num);
+    else
+      ExecuteJob(job);
+    yielded = true;
+  }
+  return yielded;
+}
+
 // --private
 
 gdm::Job gdm::JobManager::GetJob(bool& no_jobs)
 {
   GDM_EVENT_POINT("GetJob", GDM_LOG_E());  
-  bool locked = false;
-  GDM_TRY_LOCK_FOR(100, locked, queue_.GetMutex(), "mx:wt", core::COLOR_WHITESMOKE);
-  if(!locked)
+  _private::JobCounters& counters = counters_[s_tls.worker_num];
+  std::unique_lock<std::timed_mutex> lock = TryLockQueue(queue_.GetMutex(), counters);
+  if(!lock.owns_lock())
     return {};
 
   Job job;
-  if (!queue_.pending_jobs_.empty()){
-    job = queue_.pending_jobs_.front();
-    if(job.type_ != Job::BARRIER || s_stat.running_jobs == 0){
-      queue_.pending_jobs_.pop();
-      no_jobs = false;
-      ++s_stat.running_jobs;
+  Job::EPriority lane = queue_.SelectLane(stat_.running_jobs == 0);
+  if (lane != Job::PRIORITIES_COUNT){
+    counters.AddDepth(queue_.GetSize());
+    job = queue_.Pop(lane);
+    no_jobs = false;
+    ++stat_.running_jobs;
+  }
+  return job;
+}
+
+// Worker takes jobs from own deque (LIFO), then steals from others (FIFO) and
+//  only then goes to the shared queue, unless it has critical jobs. Each job
+//  in local deques is counted in running_jobs, so barriers in shared queue
+//  still wait for them
+
+gdm::Job* gdm::JobManager::GetLocalJob(unsigned worker_num)
+{
+  GDM_EVENT_POINT("GetLocalJob", GDM_LOG_E());
+  Job* job = nullptr;
+  if (queue_.HasCriticalJobs() && (job = GetInjectedJob(worker_num)))
+    return job;
+  const int depth = local_jobs_[worker_num]->GetSize();
+  if (local_jobs_[worker_num]->Pop(job))
+  {
+    counters_[worker_num].AddDepth(depth > 0 ? depth : 0);
+    return job;
+  }
+
+  const unsigned count = static_cast<unsigned>(local_jobs_.size());
+  for (unsigned i = 1; i < count; ++i)
+  {
+    if (local_jobs_[(worker_num + i) % count]->Steal(job))
+    {
+      counters_[worker_num].Add(counters_[worker_num].steals_, 1);
+      return job;
     }
   }
+  return GetInjectedJob(worker_num);
+}
+
+gdm::Job* gdm::JobManager::GetInjectedJob(unsigned worker_num)
+{
+  std::unique_lock<std::timed_mutex> lock = TryLockQueue(queue_.GetMutex(), counters_[worker_num]);
+  if(!lock.owns_lock())
+    return nullptr;
+
+  Job::EPriority lane = queue_.SelectLane(stat_.running_jobs == 0);
+  if (lane == Job::PRIORITIES_COUNT)
+    return nullptr;
+  counters_[worker_num].AddDepth(queue_.GetSize());
+
+  Job* job = job_pool_.New(worker_num, queue_.Pop(lane));
+  ++stat_.running_jobs;
+
+  if (job->type_ == Job::BARRIER || lane == Job::BACKGROUND)
+    return job;
+
+  // grab a few more jobs of the same lane to reduce contention on the queue,
+  //  others will steal them. Background jobs are left in the queue, otherwise
+  //  they would go before critical jobs pushed later
+
+  int grabbed = 0;
+  while (grabbed < v_max_grab_jobs_ && queue_.SelectLane(false) == lane)
+  {
+    ++stat_.running_jobs;
+    local_jobs_[worker_num]->Push(job_pool_.New(worker_num, queue_.Pop(lane)));
+    ++grabbed;
+  }
+  if (grabbed)
+    WakeUpThreads(grabbed);
   return job;
 }
 
 void gdm::JobManager::ExecuteJob(Job& job)
 {
+  if (DropCancelled(job))
+    return;
+
+  _private::JobCounters& counters = GetCounters();
+  counters.Add(counters.jobs_, 1);
+  if (job.priority_ == Job::BACKGROUND && background_budget_ns_.load(std::memory_order_relaxed))
+    ExecuteBackgroundJob(job);
+  else
+    job.Execute();
+  --stat_.running_jobs;
+}
+
+// Cancelled batch is dropped whole, before it's splitted. Background batch
+//  under budget is not splitted into deque, the rest goes back to the shared
+//  queue, so it may be paused after any chunk
+
+void gdm::JobManager::ExecuteLocalJob(Job* job, unsigned worker_num)
+{
+  if (DropCancelled(*job))
+  {
+    job_pool_.Delete(worker_num, job);
+    return;
+  }
+
+  if (job->priority_ == Job::BACKGROUND && background_budget_ns_.load(std::memory_order_relaxed))
+  {
+    Job chunk;
+    if (job->SplitFront(chunk))
+    {
+      {
+        GDM_UNIQUE_LOCK(queue_.lock_, "mx::bg", core::COLOR_WHITESMOKE);
+        queue_.Push(std::move(*job));
+      }
+      *job = std::move(chunk);
+      WakeUpThreads(1);
+    }
+    ExecuteJob(*job);
+    job_pool_.Delete(worker_num, job);
+    return;
+  }
+
+  unsigned splitted = 0;
+  Job rest;
+  while (job->Split(rest))
+  {
+    ++stat_.running_jobs;
+    local_jobs_[worker_num]->Push(job_pool_.New(worker_num, std::move(rest)));
+    ++splitted;
+  }
+  if (splitted)
+    WakeUpThreads(splitted);
+
+  ExecuteJob(*job);
+  job_pool_.Delete(worker_num, job);
+}
+
+// Time of nested background jobs (i.e. executed while waiting inside other
+//  one) is counted twice, which only makes budget stricter
+
+void gdm::JobManager::ExecuteBackgroundJob(Job& job)
+{
+  const JobManager* prev_manager = s_tls.background_manager;
+  const uint64_t prev_start_ns = s_tls.background_start_ns;
+  const uint64_t start_ns = _private::JobCounters::Now();
+  s_tls.background_manager = this;
+  s_tls.background_start_ns = start_ns;
+
   job.Execute();
-  --s_stat.running_jobs;
+
+  s_tls.background_manager = prev_manager;
+  s_tls.background_start_ns = prev_start_ns;
+
+  const uint64_t elapsed_ns = _private::JobCounters::Now() - start_ns;
+  const uint64_t spent_ns = background_spent_ns_.fetch_add(elapsed_ns, std::memory_order_relaxed) + elapsed_ns;
+  if (spent_ns >= background_budget_ns_.load(std::memory_order_relaxed))
+    queue_.background_paused_.store(true, std::memory_order_relaxed);
 }
 
-void gdm::JobManager::WakeUpThreads()
+// Job with cancelled token is dropped right after it's taken from queue,
+//  it never runs, but its counter is completed
+
+bool gdm::JobManager::DropCancelled(Job& job)
 {
+  if (!job.IsCancelled())
+    return false;
+
+  _private::JobCounters& counters = GetCounters();
+  counters.Add(counters.dropped_, 1);
+  job.Drop();
+  --stat_.running_jobs;
+  return true;
+}
+
+void gdm::JobManager::ResumeBackground()
+{
+  if (!queue_.background_paused_.exchange(false, std::memory_order_relaxed))
+    return;
+
+  std::size_t pending = 0;
+  {
+    GDM_UNIQUE_LOCK(queue_.lock_, "mx::rb", core::COLOR_WHITESMOKE);
+    pending = queue_.pending_jobs_[Job::BACKGROUND].size();
+  }
+  if (pending)
+    WakeUpThreads(static_cast<unsigned>(std::min<std::size_t>(pending, GetWorkersCount())));
+}
+
+bool gdm::JobManager::HasPendingJobs() const
+{
+  return !queue_.IsEmpty() || HasLocalJobs();
+}
+
+bool gdm::JobManager::HasLocalJobs() const
+{
+  for (const auto& local_jobs : local_jobs_)
+  {
+    if (!local_jobs->IsEmpty())
+      return true;
+  }
+  return false;
+}
+
+void gdm::JobManager::SpawnGraphNode(JobGraph& graph, JobGraph::NodeId node)
+{
+  JobGraph::Node& desc = graph.nodes_[node];
+
+  if (!desc.batch_)
+  {
+    Spawn(Job{[this, &graph, node]()
+    {
+      graph.nodes_[node].single_();
+      CompleteGraphNode(graph, node);
+    }, Job::SINGLE});
+    return;
+  }
+
+  if (desc.data_size_ == 0)
+  {
+    CompleteGraphNode(graph, node);
+    return;
+  }
+
+  auto func = [this, &graph, node](int from, int count)
+  {
+    graph.nodes_[node].batch_(from, count);
+    if (graph.wait_parts_[node].fetch_sub(1, std::memory_order_acq_rel) == 1)
+      CompleteGraphNode(graph, node);
+  };
+
+  Spawn(Job{Job::CbBatch{func}, 0, desc.data_size_, desc.batch_size_});
+}
+
+void gdm::JobManager::CompleteGraphNode(JobGraph& graph, JobGraph::NodeId node)
+{
+  for (JobGraph::NodeId next : graph.nodes_[node].successors_)
+  {
+    if (graph.wait_deps_[next].fetch_sub(1, std::memory_order_acq_rel) == 1)
+      SpawnGraphNode(graph, next);
+  }
+  graph.remaining_nodes_.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+// Wakes up to count parked workers, one per available job. Pusher stores job
+//  and then checks parked flags, worker stores flag and then checks jobs, so
+//  with full fences between one of them sees the other
+
+void gdm::JobManager::WakeUpThreads(unsigned count)
+{
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (stat_.sleeping_workers.load(std::memory_order_relaxed) == 0)
+    return;
+
   GDM_EVENT_POINT("wakeup", GDM_CPU_G("WorkerGrp", core::COLOR_MEDIUMAQUAMARINE) GDM_LOG_E());
+  const unsigned workers = GetWorkersCount();
+  const unsigned first = wake_cursor_.fetch_add(1, std::memory_order_relaxed);
+  for (unsigned i = 0; i < workers && count > 0; ++i)
   {
-    GDM_LOCK_GUARD(mx::wait_jobs, "mx:wu", core::COLOR_WHITESMOKE);
-    for (int& status : thread_status_)
-      status = 1;
+    std::atomic<int>& parked = thread_status_[(first + i) % workers].parked;
+    if (parked.load(std::memory_order_relaxed) == 1 && parked.exchange(0, std::memory_order_acq_rel) == 1)
+    {
+      futex::WakeOne(parked);
+      --count;
+    }
   }
-  cv::wait_jobs.notify_all();
-  // cv::wait_jobs.notify_one(); // todo: why
+}
+
+// Spins with growing pauses while there is a chance to get a job soon, then parks
+
+void gdm::JobManager::IdleThisThread()
+{
+  if (!(flags_ & core::IDLE_PARK))
+  {
+    ++stat_.spinning_workers;
+    Backoff backoff;
+    bool has_jobs = HasPendingJobs();
+    while (!has_jobs && GetWorker(s_tls.worker_num).IsRunning())
+    {
+      if (!backoff.Spin())
+      {
+        if (!(flags_ & core::IDLE_SPIN))
+          break;
+        std::this_thread::yield();
+      }
+      has_jobs = HasPendingJobs();
+    }
+    --stat_.spinning_workers;
+    if (has_jobs || (flags_ & core::IDLE_SPIN))
+      return;
+  }
+  SleepThisThread();
 }
 
 void gdm::JobManager::SleepThisThread()
 {
   GDM_EVENT_POINT("sleep", GDM_LOG_E());
-  GDM_UNIQUE_LOCK_VAR(mx::wait_jobs, lock, "mx::wt", core::COLOR_WHITESMOKE);
-
-  // prevents sleep when all threads here but while all on wait for mutex,
-  // somewho post jobs (sort of tradeoff)
-  if(!queue_.pending_jobs_.empty())
-    return;
+  std::atomic<int>& parked = thread_status_[s_tls.worker_num].parked;
+  counters_[s_tls.worker_num].Mark(_private::JobCounters::SLEEP);
+  ++stat_.sleeping_workers;
+  parked.store(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
 
-  thread_status_[s_tls.worker_num] = 0;
-  cv::wait_jobs.wait(lock, [&](){ return thread_status_[s_tls.worker_num] == 1; });
+  if (HasPendingJobs() || !GetWorker(s_tls.worker_num).IsRunning())
+    parked.store(0, std::memory_order_relaxed);
+  while (parked.load(std::memory_order_acquire) == 1)
+    futex::Wait(parked, 1);
+  --stat_.sleeping_workers;
+  counters_[s_tls.worker_num].Mark(_private::JobCounters::IDLE);
 }
 
 gdm::Thread& gdm::JobManager::GetWorker(unsigned worker_num)
@@ -149,17 +704,61 @@ gdm::Thread& gdm::JobManager::GetWorker(unsigned worker_num)
   return thread_pool_[worker_num];
 }
 
+// Threads which are not workers of this manager share the last slot
+
+gdm::_private::JobCounters& gdm::JobManager::GetCounters()
+{
+  return s_tls.manager == this ? counters_[s_tls.worker_num] : counters_.back();
+}
+
+// Called by workers, the one which fails to take the lock skips the dump
+//  since another one is doing it right now
+
+void gdm::JobManager::DumpTelemetry()
+{
+  const uint64_t next = next_dump_ns_.load(std::memory_order_acquire);
+  if (!next || _private::JobCounters::Now() < next)
+    return;
+
+  std::unique_lock<std::mutex> lock(dump_lock_, std::try_to_lock);
+  if (!lock.owns_lock())
+    return;
+  const uint64_t now = _private::JobCounters::Now();
+  const uint64_t current = next_dump_ns_.load(std::memory_order_relaxed);
+  if (!current || now < current)
+    return;
+  next_dump_ns_.store(now + dump_period_ns_, std::memory_order_relaxed);
+
+  JobTelemetry telemetry = GetTelemetry();
+  PrintTelemetry(telemetry);
+  last_dump_ = std::move(telemetry);
+}
+
+void gdm::JobManager::PrintTelemetry(const JobTelemetry& telemetry)
+{
+  GDM_LOCK_GUARD(mx::io_lock, "mx:tl", core::COLOR_WHITESMOKE);
+  (telemetry - last_dump_).Print(dump_file_, name_.c_str());
+}
+
 // --private static
 
 void gdm::JobManager::WorkerFunc(void* job_manager_ptr, unsigned worker_num)
 {
   JobManager& mgr = *(static_cast<JobManager*>(job_manager_ptr));
-  std::queue<Job>& queue = mgr.queue_.pending_jobs_;
-  snprintf(s_tls.worker_name, sizeof(s_tls.worker_name), "Worker_%d", worker_num);
+  snprintf(s_tls.worker_name, sizeof(s_tls.worker_name), "%s_%d", mgr.name_.c_str(), worker_num);
   s_tls.worker_num = worker_num;
+  s_tls.manager = &mgr;
+  mgr.counters_[worker_num].Mark(_private::JobCounters::IDLE);
 
   GDM_PROFILE_THIS_THREAD_ENABLE(s_tls.worker_name);
 
+  if (mgr.flags_ & core::WORK_STEALING)
+  {
+    WorkerStealingFunc(mgr, worker_num);
+    ++mgr.stat_.workers_stopped;
+    return;
+  }
+
   while (mgr.GetWorker(worker_num).IsRunning())
   {
     GDM_EVENT_POINT("loop", GDM_CPU_G("WorkerGrp", core::COLOR_DARKORANGE) GDM_LOG(FMT_STAT));
@@ -171,18 +770,50 @@ void gdm::JobManager::WorkerFunc(void* job_manager_ptr, unsigned worker_num)
     }
     if (no_jobs){
       GDM_EVENT_POINT("sleep", GDM_CPU_G("WorkerGrp", core::COLOR_PERU) GDM_LOG(FMT_STAT));
-      mgr.SleepThisThread();
+      mgr.counters_[worker_num].Mark(_private::JobCounters::IDLE);
+      mgr.DumpTelemetry();
+      mgr.IdleThisThread();
     }
     else{
       GDM_EVENT_POINT("exec", GDM_CPU_G("WorkerGrp", core::COLOR_DARKVIOLET) GDM_LOG(FMT_STAT));
+      mgr.counters_[worker_num].Mark(_private::JobCounters::BUSY);
       mgr.ExecuteJob(job);
+      if ((mgr.counters_[worker_num].jobs_.load(std::memory_order_relaxed) & v_dump_check_jobs_mask_) == 0)
+        mgr.DumpTelemetry();
 #if 0
       // todo: unnecessary since currently we are not sleep while running_jobs
       GDM_EVENT_POINT("wakeup", GDM_CPU_G("WorkerGrp", core::COLOR_INDIANRED2) GDM_LOG(FMT_STAT));
-      mgr.WakeUpThreads();
+      mgr.WakeUpThreads(1);
 #endif
     }
   }
   GDM_EVENT_POINT("term", GDM_LOG(FMT_SMPL));
-  ++mgr.s_stat.workers_stopped;
+  ++mgr.stat_.workers_stopped;
+}
+
+void gdm::JobManager::WorkerStealingFunc(JobManager& mgr, unsigned worker_num)
+{
+  while (mgr.GetWorker(worker_num).IsRunning())
+  {
+    GDM_EVENT_POINT("loop", GDM_CPU_G("WorkerGrp", core::COLOR_DARKORANGE) GDM_LOG(FMT_STAT));
+    Job* job = nullptr;
+    {
+      GDM_EVENT_POINT("get", GDM_CPU_G("WorkerGrp", core::COLOR_MEDIUMAQUAMARINE) GDM_LOG(FMT_STAT));
+      job = mgr.GetLocalJob(worker_num);
+    }
+    if (!job){
+      GDM_EVENT_POINT("sleep", GDM_CPU_G("WorkerGrp", core::COLOR_PERU) GDM_LOG(FMT_STAT));
+      mgr.counters_[worker_num].Mark(_private::JobCounters::IDLE);
+      mgr.DumpTelemetry();
+      mgr.IdleThisThread();
+    }
+    else{
+      GDM_EVENT_POINT("exec", GDM_CPU_G("WorkerGrp", core::COLOR_DARKVIOLET) GDM_LOG(FMT_STAT));
+      mgr.counters_[worker_num].Mark(_private::JobCounters::BUSY);
+      mgr.ExecuteLocalJob(job, worker_num);
+      if ((mgr.counters_[worker_num].jobs_.load(std::memory_order_relaxed) & v_dump_check_jobs_mask_) == 0)
+        mgr.DumpTelemetry();
+    }
+  }
+  GDM_EVENT_POINT("term", GDM_LOG(FMT_SMPL));
 }
@@ -8,23 +8,36 @@
 #define AH_GDM_JOB_MANAGER_H
 
 #include <vector>
+#include <string>
 #include <queue>
+#include <memory>
 #include <mutex>
 #include <future>
 #include <functional>
 #include <condition_variable>
 
 #include "threads/thread.h"
+#include "threads/cpu_topology.h"
 #include "threads/job_queue.h"
+#include "threads/job_graph.h"
+#include "threads/job_telemetry.h"
+#include "threads/frame_arena.h"
+#include "threads/work_stealing_deque.h"
+#include "threads/job_pool.h"
 
 namespace gdm {
 
 namespace core {
 
+  // Workers placement is passed here too, see EPlacement
+
   enum EJobManagerProps : unsigned
   {
     PRINT_LOG = 1 << 1,
-    SAVE_LOG = 1 << 2
+    SAVE_LOG = 1 << 2,
+    WORK_STEALING = 1 << 3,
+    IDLE_PARK = 1 << 4,       // idle worker parks at once (default is spin, then park)
+    IDLE_SPIN = 1 << 5        // idle worker never parks, just spins and yields
   
   }; // enum EJobManagerProps
   
@@ -34,50 +47,107 @@ namespace core {
 
 struct JobManager
 {
-  JobManager(core::JobManagerProps flags = 0); 
+  JobManager(core::JobManagerProps flags = 0, unsigned workers_count = 0, core::Priority priority = core::ABOVE_NORMAL, const char* name = "Worker");
+  JobManager(const JobManager&) = delete;
+  JobManager& operator=(const JobManager&) = delete;
   ~JobManager();
 
   auto GetJobQueue() -> JobQueue&;
+  auto GetWorkersCount() const -> unsigned { return static_cast<unsigned>(thread_pool_.size()); }
   void WaitOnBarrier();
   void WaitOnBarrierTS();
+  void WaitOnCounter(const JobCounter& counter);
+  void SubmitGraph(JobGraph& graph);
+  void WaitOnGraph(const JobGraph& graph);
+  auto GetTelemetry() const -> JobTelemetry;
+  void SetTelemetryDump(unsigned period_ms, FILE* file = stdout);
+  void SetBackgroundBudget(unsigned budget_us);
+  void BeginFrame();
+  bool IsBackgroundBudgetSpent() const;
+  auto GetFrameArena() -> FrameArena& { return frame_arenas_.GetLocal(); }
+  void SetFrameArenaSize(std::size_t size) { frame_arenas_.SetSize(size); }
+
+public:
+  void Spawn(Job&& job);
+  bool HelpExecute();
+  bool YieldToCritical();
+  bool HasStealDemand() const;
+
+private:
+  struct alignas(64) WorkerStatus
+  {
+    std::atomic<int> parked {0};
+  };
 
 private:
   unsigned flags_;
   unsigned main_cpu_;
   unsigned cpu_count_;
   std::vector<Thread> thread_pool_;
-  std::vector<int> thread_status_;
+  std::vector<WorkerStatus> thread_status_;
+  std::vector<std::unique_ptr<WorkStealingDeque<Job*>>> local_jobs_;
+  _private::JobPool job_pool_;
   JobQueue queue_;
 
 private:
   struct RuntimeStat
   {
-    std::atomic<int> running_jobs;
-    std::atomic<int> workers_stopped;
-  } static s_stat;
+    std::atomic<int> running_jobs {0};
+    std::atomic<int> workers_stopped {0};
+    std::atomic<int> sleeping_workers {0};
+    std::atomic<int> spinning_workers {0};
+  } stat_;
+
+  std::string name_;
+  std::atomic<unsigned> wake_cursor_;
+
+  std::vector<_private::JobCounters> counters_;
+  std::mutex dump_lock_;
+  std::atomic<uint64_t> next_dump_ns_;
+  uint64_t dump_period_ns_;
+  FILE* dump_file_;
+  JobTelemetry last_dump_;
+
+  std::atomic<uint64_t> background_budget_ns_;
+  std::atomic<uint64_t> background_spent_ns_;
+  FrameArenas frame_arenas_;
+
+  constexpr static int v_max_grab_jobs_ = 8;
+  constexpr static uint64_t v_dump_check_jobs_mask_ = 1023;
 
 private:
   auto GetJob(bool& no_jobs) -> Job;
+  auto GetLocalJob(unsigned worker_num) -> Job*;
+  auto GetInjectedJob(unsigned worker_num) -> Job*;
   void ExecuteJob(Job& job);
-  void WakeUpThreads();
+  void ExecuteLocalJob(Job* job, unsigned worker_num);
+  void ExecuteBackgroundJob(Job& job);
+  bool DropCancelled(Job& job);
+  void ResumeBackground();
+  bool HasLocalJobs() const;
+  bool HasPendingJobs() const;
+  void SpawnGraphNode(JobGraph& graph, JobGraph::NodeId node);
+  void CompleteGraphNode(JobGraph& graph, JobGraph::NodeId node);
+  void WakeUpThreads(unsigned count);
+  void IdleThisThread();
   void SleepThisThread();
   auto GetWorker(unsigned worker_num) -> Thread&;
+  auto GetCounters() -> _private::JobCounters&;
+  void DumpTelemetry();
+  void PrintTelemetry(const JobTelemetry& telemetry);
 
 private:
   static void WorkerFunc(void* job_manager_ptr, unsigned worker_num);
+  static void WorkerStealingFunc(JobManager& mgr, unsigned worker_num);
+
+private:
+  friend struct JobQueue;
 
 }; // struct JobManager
 
 namespace mx
 {
-  static std::mutex io_lock {};
-  static std::mutex wait_jobs {};
-}
-
-namespace cv
-{
-  static std::condition_variable wait_jobs {};
-  static bool wait_jobs_proof = false;
+  inline std::mutex io_lock {};
 }
 
 } // namespace gdm
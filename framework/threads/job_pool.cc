@@ -0,0 +1,96 @@
+// *************************************************************
+// File:    job_pool.cc
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#include "job_pool.h"
+
+#include <new>
+#include <utility>
+
+// --public
+
+gdm::_private::JobPool::JobPool(unsigned workers)
+  : caches_(workers)
+  , chunks_{}
+  , depot_{nullptr}
+  , lock_{}
+{ }
+
+gdm::Job* gdm::_private::JobPool::New(unsigned worker_num, Job&& job)
+{
+  Cache& cache = caches_[worker_num];
+  if (!cache.head_)
+    Refill(cache);
+
+  Slot* slot = cache.head_;
+  cache.head_ = slot->next_;
+  --cache.count_;
+  return new (slot->data_) Job(std::move(job));
+}
+
+// Worker number out of range means the caller is not a worker
+
+void gdm::_private::JobPool::Delete(unsigned worker_num, Job* job)
+{
+  job->~Job();
+  Slot* slot = reinterpret_cast<Slot*>(job);
+
+  if (worker_num >= caches_.size())
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    slot->next_ = depot_;
+    depot_ = slot;
+    return;
+  }
+
+  Cache& cache = caches_[worker_num];
+  slot->next_ = cache.head_;
+  cache.head_ = slot;
+  if (++cache.count_ >= v_batch_ * 2)
+    Release(cache, v_batch_);
+}
+
+// --private
+
+// Takes a batch from depot, new chunk is allocated only when depot is empty
+
+void gdm::_private::JobPool::Refill(Cache& cache)
+{
+  std::lock_guard<std::mutex> lock(lock_);
+  if (!depot_)
+  {
+    chunks_.push_back(std::make_unique<Slot[]>(v_batch_));
+    Slot* chunk = chunks_.back().get();
+    for (unsigned i = 0; i + 1 < v_batch_; ++i)
+      chunk[i].next_ = &chunk[i + 1];
+    chunk[v_batch_ - 1].next_ = nullptr;
+    depot_ = chunk;
+  }
+
+  while (depot_ && cache.count_ < v_batch_)
+  {
+    Slot* slot = depot_;
+    depot_ = slot->next_;
+    slot->next_ = cache.head_;
+    cache.head_ = slot;
+    ++cache.count_;
+  }
+}
+
+// Batch is cut from the cache without lock, depot is locked only to splice it
+
+void gdm::_private::JobPool::Release(Cache& cache, unsigned count)
+{
+  Slot* first = cache.head_;
+  Slot* last = first;
+  for (unsigned i = 1; i < count; ++i)
+    last = last->next_;
+  cache.head_ = last->next_;
+  cache.count_ -= count;
+
+  std::lock_guard<std::mutex> lock(lock_);
+  last->next_ = depot_;
+  depot_ = first;
+}
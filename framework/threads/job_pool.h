@@ -0,0 +1,62 @@
+// *************************************************************
+// File:    job_pool.h
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#ifndef AH_GDM_JOB_POOL_H
+#define AH_GDM_JOB_POOL_H
+
+#include <mutex>
+#include <memory>
+#include <vector>
+
+#include "threads/job_queue.h"
+
+namespace gdm::_private {
+
+// Slots of jobs which live in work stealing deques. Each worker takes and
+//  gives back slots through own cache without locks. Stolen job is freed by
+//  other worker than the one who took it, so caches exchange surplus with
+//  shared depot by batches. Threads which are not workers free slots right
+//  to the depot. Slots are allocated by chunks and freed with the pool
+
+struct JobPool
+{
+  explicit JobPool(unsigned workers);
+  JobPool(const JobPool&) = delete;
+  JobPool& operator=(const JobPool&) = delete;
+
+  auto New(unsigned worker_num, Job&& job) -> Job*;
+  void Delete(unsigned worker_num, Job* job);
+
+private:
+  union Slot
+  {
+    Slot* next_;
+    alignas(Job) unsigned char data_[sizeof(Job)];
+  };
+
+  struct alignas(64) Cache
+  {
+    Slot* head_ = nullptr;
+    unsigned count_ = 0;
+  };
+
+private:
+  void Refill(Cache& cache);
+  void Release(Cache& cache, unsigned count);
+
+private:
+  std::vector<Cache> caches_;
+  std::vector<std::unique_ptr<Slot[]>> chunks_;
+  Slot* depot_;
+  std::mutex lock_;
+
+  constexpr static unsigned v_batch_ = 64;
+
+}; // struct JobPool
+
+} // namespace gdm::_private
+
+#endif // AH_GDM_JOB_POOL_H
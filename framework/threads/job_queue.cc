@@ -9,35 +9,139 @@
 #include <assert.h>
 
 #include "threads/scoped_locks.h"
+#include "threads/job_manager.h"
 
 // --public
 
 gdm::Job::Job()
   : type_{EType::UNDEFINED}
+  , cb_entry_point_single_{}
+  , cb_entry_point_batch_{nullptr}
+  , cb_data_{0, 0}
+  , cb_grain_{0}
+  , counter_{nullptr}
+  , priority_{NORMAL}
+  , token_{}
 { }
 
 gdm::Job::Job(CbSingle&& func, Job::EType type)
   : type_{type}
-  , cb_entry_point_single_{func}
+  , cb_entry_point_single_{std::move(func)}
+  , cb_entry_point_batch_{nullptr}
+  , cb_data_{0, 0}
+  , cb_grain_{0}
+  , counter_{nullptr}
+  , priority_{NORMAL}
+  , token_{}
 {
   assert(type == EType::SINGLE || type == EType::BARRIER);
 }
 
 gdm::Job::Job(CbBatch&& func, int from, int size)
-  : type_{EType::BATCH}
-  , cb_entry_point_batch_{func}
-  , cb_data_{from, size}
+  : Job(std::move(func), from, size, size)
+{ }
+
+gdm::Job::Job(CbBatch&& func, int from, int size, int grain)
+  : Job(new SharedBatch{std::move(func), {1}}, from, size, grain)
 { }
 
+gdm::Job::Job(Job&& other) noexcept
+  : type_{other.type_}
+  , cb_entry_point_single_{std::move(other.cb_entry_point_single_)}
+  , cb_entry_point_batch_{other.cb_entry_point_batch_}
+  , cb_data_{other.cb_data_[0], other.cb_data_[1]}
+  , cb_grain_{other.cb_grain_}
+  , counter_{other.counter_}
+  , priority_{other.priority_}
+  , token_{std::move(other.token_)}
+{
+  other.type_ = EType::UNDEFINED;
+  other.cb_entry_point_batch_ = nullptr;
+  other.counter_ = nullptr;
+}
+
+gdm::Job& gdm::Job::operator=(Job&& other) noexcept
+{
+  if (this == &other)
+    return *this;
+
+  Release();
+  type_ = other.type_;
+  cb_entry_point_single_ = std::move(other.cb_entry_point_single_);
+  cb_entry_point_batch_ = other.cb_entry_point_batch_;
+  cb_data_[0] = other.cb_data_[0];
+  cb_data_[1] = other.cb_data_[1];
+  cb_grain_ = other.cb_grain_;
+  counter_ = other.counter_;
+  priority_ = other.priority_;
+  token_ = std::move(other.token_);
+  other.type_ = EType::UNDEFINED;
+  other.cb_entry_point_batch_ = nullptr;
+  other.counter_ = nullptr;
+  return *this;
+}
+
+gdm::Job::~Job()
+{
+  Release();
+}
+
 bool gdm::Job::Execute()
 {
   switch (type_)
   {
     case Job::SINGLE  : cb_entry_point_single_.operator()(); break;
     case Job::BARRIER : cb_entry_point_single_.operator()(); break;
-    case Job::BATCH   : cb_entry_point_batch_.operator()(cb_data_[0], cb_data_[1]); break;
+    case Job::BATCH   : cb_entry_point_batch_->func_.operator()(cb_data_[0], cb_data_[1]); break;
     default : assert(false && "Undefined job"); return false;
   }
+  if (counter_)
+    JobCounter::Sub(counter_, type_ == Job::BATCH ? cb_data_[1] : 1);
+  return true;
+}
+
+// Completes job's part of counter without running it
+
+void gdm::Job::Drop()
+{
+  if (counter_)
+    JobCounter::Sub(counter_, type_ == Job::BATCH ? cb_data_[1] : 1);
+  counter_ = nullptr;
+}
+
+// Splits batch by half aligned to grain, this job keeps the left part
+
+bool gdm::Job::Split(Job& rest)
+{
+  if (type_ != Job::BATCH || cb_data_[1] <= cb_grain_)
+    return false;
+
+  int chunks = (cb_data_[1] + cb_grain_ - 1) / cb_grain_;
+  int left_size = (chunks / 2) * cb_grain_;
+
+  cb_entry_point_batch_->refs_.fetch_add(1, std::memory_order_relaxed);
+  rest = Job(cb_entry_point_batch_, cb_data_[0] + left_size, cb_data_[1] - left_size, cb_grain_);
+  rest.counter_ = counter_;
+  rest.priority_ = priority_;
+  rest.token_ = token_;
+  cb_data_[1] = left_size;
+  return true;
+}
+
+// Cuts one grain sized chunk from the front, this job keeps the rest
+
+bool gdm::Job::SplitFront(Job& chunk)
+{
+  if (type_ != Job::BATCH || cb_data_[1] <= cb_grain_)
+    return false;
+
+  cb_entry_point_batch_->refs_.fetch_add(1, std::memory_order_relaxed);
+  chunk = Job(cb_entry_point_batch_, cb_data_[0], cb_grain_, cb_grain_);
+  chunk.counter_ = counter_;
+  chunk.priority_ = priority_;
+  chunk.token_ = token_;
+  cb_data_[0] += cb_grain_;
+  cb_data_[1] -= cb_grain_;
   return true;
 }
 
@@ -46,52 +150,236 @@ gdm::Job::EType gdm::Job::GetType() const
   return type_;
 }
 
+gdm::Job::EPriority gdm::Job::GetPriority() const
+{
+  return priority_;
+}
+
+bool gdm::Job::IsCancelled() const
+{
+  return token_.IsCancelled();
+}
+
+// --private
+
+gdm::Job::Job(SharedBatch* batch, int from, int size, int grain)
+  : type_{EType::BATCH}
+  , cb_entry_point_single_{}
+  , cb_entry_point_batch_{batch}
+  , cb_data_{from, size}
+  , cb_grain_{grain}
+  , counter_{nullptr}
+  , priority_{NORMAL}
+  , token_{}
+{
+  assert(grain > 0);
+}
+
+void gdm::Job::Release()
+{
+  if (cb_entry_point_batch_ && cb_entry_point_batch_->refs_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    delete cb_entry_point_batch_;
+  cb_entry_point_batch_ = nullptr;
+}
+
 // --public JobQueue
 
 gdm::JobQueue::JobQueue()
   : pending_jobs_{}
+  , pending_sizes_{}
+  , skipped_{}
+  , critical_jobs_{0}
+  , background_paused_{false}
   , lock_{}
+  , lazy_batches_{false}
+  , manager_{nullptr}
 { }
 
-void gdm::JobQueue::PushJob(Job::CbSingle func)
+void gdm::JobQueue::PushJob(Job::CbSingle func, Job::EPriority priority, const CancellationToken& token)
+{
+  PushJob(std::move(func), nullptr, priority, token);
+}
+
+void gdm::JobQueue::PushBatch(Job::CbBatch func, int batch_size, std::size_t data_size, Job::EPriority priority, const CancellationToken& token)
+{
+  PushBatch(std::move(func), batch_size, data_size, nullptr, priority, token);
+}
+
+// Empty counter gets new state, so caller may wait on it after the push
+
+void gdm::JobQueue::PushJob(Job::CbSingle func, JobCounter& counter, Job::EPriority priority, const CancellationToken& token)
+{
+  if (!counter)
+    counter = JobCounter::Create();
+  counter.Add(1);
+  PushJob(std::move(func), counter.state_, priority, token);
+}
+
+void gdm::JobQueue::PushBatch(Job::CbBatch func, int batch_size, std::size_t data_size, JobCounter& counter, Job::EPriority priority, const CancellationToken& token)
+{
+  if (!counter)
+    counter = JobCounter::Create();
+  if (data_size == 0)
+    return;
+  counter.Add(static_cast<int>(data_size));
+  PushBatch(std::move(func), batch_size, data_size, counter.state_, priority, token);
+}
+
+void gdm::JobQueue::PushJob(Job::CbSingle func, JobCounter::State* counter, Job::EPriority priority, const CancellationToken& token)
 {
-  pending_jobs_.push(Job{std::move(func), Job::SINGLE});
+  Job job {std::move(func), Job::SINGLE};
+  job.counter_ = counter;
+  job.priority_ = priority;
+  job.token_ = token;
+  Push(std::move(job));
+  Notify(1);
 }
 
-void gdm::JobQueue::PushBatch(Job::CbBatch func, int batch_size, std::size_t data_size)
+void gdm::JobQueue::PushBatch(Job::CbBatch func, int batch_size, std::size_t data_size, JobCounter::State* counter, Job::EPriority priority, const CancellationToken& token)
 {
   assert(batch_size > 0);
-  
-  int curr_data_size = static_cast<int>(data_size);
-  int curr_batch_size = static_cast<int>(batch_size);
 
-  for (int i = 0; i < curr_data_size; i += curr_batch_size)
+  if (data_size == 0)
+    return;
+
+  // In work stealing mode whole range goes as one job and workers split it by themselves
+
+  Job batch {std::move(func), 0, static_cast<int>(data_size), batch_size};
+  batch.counter_ = counter;
+  batch.priority_ = priority;
+  batch.token_ = token;
+  unsigned chunks = 1;
+  if (!lazy_batches_)
   {
-    int batch_overflow = i + curr_batch_size > curr_data_size ? i + curr_batch_size - curr_data_size : 0;
-    curr_batch_size -= batch_overflow;
-    pending_jobs_.push(Job{std::move(func), i, curr_batch_size});
+    Job chunk;
+    while (batch.SplitFront(chunk))
+    {
+      Push(std::move(chunk));
+      ++chunks;
+    }
   }
+  Push(std::move(batch));
+  Notify(chunks);
 }
 
 void gdm::JobQueue::PushBarrier(Job::CbSingle func)
 {
-  pending_jobs_.push(Job(std::move(func), Job::BARRIER));
+  Push(Job(std::move(func), Job::BARRIER));
+  Notify(1);
+}
+
+void gdm::JobQueue::PushJobTS(Job::CbSingle func, Job::EPriority priority, const CancellationToken& token)
+{
+  GDM_UNIQUE_LOCK(lock_, "mx::pj", core::COLOR_WHITESMOKE);
+  PushJob(std::move(func), priority, token);
+}
+
+void gdm::JobQueue::PushBatchTS(Job::CbBatch func, int batch_size, std::size_t data_size, Job::EPriority priority, const CancellationToken& token)
+{
+  GDM_UNIQUE_LOCK(lock_, "mx::pb", core::COLOR_WHITESMOKE);
+  PushBatch(std::move(func), batch_size, data_size, priority, token);
 }
 
-void gdm::JobQueue::PushJobTS(Job::CbSingle func)
+void gdm::JobQueue::PushJobTS(Job::CbSingle func, JobCounter& counter, Job::EPriority priority, const CancellationToken& token)
 {
   GDM_UNIQUE_LOCK(lock_, "mx::pj", core::COLOR_WHITESMOKE);
-  PushJob(func);
+  PushJob(std::move(func), counter, priority, token);
 }
 
-void gdm::JobQueue::PushBatchTS(Job::CbBatch func, int batch_size, std::size_t data_size)
+void gdm::JobQueue::PushBatchTS(Job::CbBatch func, int batch_size, std::size_t data_size, JobCounter& counter, Job::EPriority priority, const CancellationToken& token)
 {
   GDM_UNIQUE_LOCK(lock_, "mx::pb", core::COLOR_WHITESMOKE);
-  PushBatch(func, batch_size, data_size);
+  PushBatch(std::move(func), batch_size, data_size, counter, priority, token);
 }
 
 void gdm::JobQueue::PushBarrierTS(Job::CbSingle func)
 {
   GDM_UNIQUE_LOCK(lock_, "mx::pb", core::COLOR_WHITESMOKE);
-  PushBarrier(func);
+  PushBarrier(std::move(func));
+}
+
+// --private JobQueue
+
+// Wakes one parked worker per pushed job, not the whole pool
+
+void gdm::JobQueue::Notify(unsigned count)
+{
+  if (manager_)
+    manager_->WakeUpThreads(count);
+}
+
+void gdm::JobQueue::Push(Job&& job)
+{
+  if (job.priority_ == Job::CRITICAL)
+    critical_jobs_.fetch_add(1, std::memory_order_relaxed);
+  pending_sizes_[job.priority_].fetch_add(1, std::memory_order_relaxed);
+  pending_jobs_[job.priority_].push(std::move(job));
+}
+
+gdm::Job gdm::JobQueue::Pop(Job::EPriority lane)
+{
+  if (lane == Job::CRITICAL)
+    critical_jobs_.fetch_sub(1, std::memory_order_relaxed);
+  skipped_[lane] = 0;
+  pending_sizes_[lane].fetch_sub(1, std::memory_order_relaxed);
+  Job job = std::move(pending_jobs_[lane].front());
+  pending_jobs_[lane].pop();
+  return job;
+}
+
+// Returns lane to take the next job from or PRIORITIES_COUNT if there is
+//  nothing to take. Barrier at the front blocks its lane and all lower ones,
+//  except starving lanes. Paused background lane is seen as empty
+
+gdm::Job::EPriority gdm::JobQueue::SelectLane(bool barrier_allowed)
+{
+  int first = 0;
+  while (first < Job::PRIORITIES_COUNT && !HasLaneJobs(first))
+    ++first;
+  if (first == Job::PRIORITIES_COUNT)
+    return Job::PRIORITIES_COUNT;
+
+  for (int lane = Job::PRIORITIES_COUNT - 1; lane > first; --lane)
+  {
+    if (skipped_[lane] >= v_max_skipped_ && HasLaneJobs(lane) && pending_jobs_[lane].front().type_ != Job::BARRIER)
+      return static_cast<Job::EPriority>(lane);
+  }
+
+  if (pending_jobs_[first].front().type_ == Job::BARRIER && !barrier_allowed)
+    return Job::PRIORITIES_COUNT;
+
+  for (int lane = first + 1; lane < Job::PRIORITIES_COUNT; ++lane)
+  {
+    if (HasLaneJobs(lane))
+      ++skipped_[lane];
+  }
+  return static_cast<Job::EPriority>(first);
+}
+
+// Sizes are changed under lock but read without it, so idle workers may
+//  check for jobs without touching the queues which others push to
+
+bool gdm::JobQueue::HasLaneJobs(int lane) const
+{
+  if (lane == Job::BACKGROUND && IsBackgroundPaused())
+    return false;
+  return pending_sizes_[lane].load(std::memory_order_relaxed) > 0;
+}
+
+bool gdm::JobQueue::IsEmpty() const
+{
+  for (int lane = 0; lane < Job::PRIORITIES_COUNT; ++lane)
+  {
+    if (HasLaneJobs(lane))
+      return false;
+  }
+  return true;
+}
+
+std::size_t gdm::JobQueue::GetSize() const
+{
+  std::size_t size = 0;
+  for (const std::atomic<std::size_t>& lane : pending_sizes_)
+    size += lane.load(std::memory_order_relaxed);
+  return size;
 }
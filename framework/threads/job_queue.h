@@ -10,60 +10,127 @@
 #include <vector>
 #include <queue>
 #include <mutex>
+#include <atomic>
 #include <future>
 #include <functional>
 #include <condition_variable>
 
 #include "threads/thread.h"
+#include "threads/job_function.h"
+#include "threads/job_counter.h"
+#include "threads/cancellation_token.h"
 
 namespace gdm {
 
 struct JobManager;
 
+// Job is move-only. All parts of one batch share the same functor which is
+// released by the last part. When counter is attached, each finished part
+// subtracts its size from it. Parts keep priority and cancellation token of
+// the whole job. Cancelled job is dropped instead of execution
+
 struct Job
 {
-  using CbSingle = std::function<void()>;
-  using CbBatch = std::function<void(int from, int count)>;
-  using CbBarrier = std::function<bool()>;
+  using CbSingle = JobFunction<void()>;
+  using CbBatch = JobFunction<void(int from, int count)>;
+  using CbBarrier = JobFunction<bool()>;
   
   enum EType { UNDEFINED, SINGLE, BATCH, BARRIER };
+  enum EPriority { CRITICAL, NORMAL, BACKGROUND, PRIORITIES_COUNT };
 
   Job();
   Job(CbSingle&& func, Job::EType type);
   Job(CbBatch&& func, int from, int size);
+  Job(CbBatch&& func, int from, int size, int grain);
+  Job(Job&& other) noexcept;
+  Job& operator=(Job&& other) noexcept;
+  Job(const Job&) = delete;
+  Job& operator=(const Job&) = delete;
+  ~Job();
 
   bool Execute();
+  void Drop();
+  bool Split(Job& rest);
+  bool SplitFront(Job& chunk);
   auto GetType() const -> EType;
+  auto GetPriority() const -> EPriority;
+  bool IsCancelled() const;
+
+private:
+  struct SharedBatch
+  {
+    CbBatch func_;
+    std::atomic<int> refs_;
+  };
+
+  Job(SharedBatch* batch, int from, int size, int grain);
+  void Release();
 
 private:
   EType type_;
   CbSingle cb_entry_point_single_;
-  CbBatch cb_entry_point_batch_;
+  SharedBatch* cb_entry_point_batch_;
   int cb_data_[2];
+  int cb_grain_;
+  JobCounter::State* counter_;
+  EPriority priority_;
+  CancellationToken token_;
 
 private:
   friend struct JobManager;
+  friend struct JobQueue;
 
 }; // struct Job
 
+// Jobs are taken from the highest priority lane first. Lower lane which was
+// skipped v_max_skipped_ times gets its turn, so it is never starved. Barriers
+// go to normal lane and don't wait for pending background jobs. Background
+// lane may be paused by manager when per frame budget is spent. Pushes without
+// counter are fire and forget, they don't allocate counter state
+
 struct JobQueue
 {
   JobQueue();
   JobQueue(const JobQueue& queue) = delete;
 
-  void PushJob(Job::CbSingle func);
-  void PushBatch(Job::CbBatch func, int batch_size, std::size_t data_size);
+  void PushJob(Job::CbSingle func, Job::EPriority priority = Job::NORMAL, const CancellationToken& token = {});
+  void PushBatch(Job::CbBatch func, int batch_size, std::size_t data_size, Job::EPriority priority = Job::NORMAL, const CancellationToken& token = {});
+  void PushJob(Job::CbSingle func, JobCounter& counter, Job::EPriority priority = Job::NORMAL, const CancellationToken& token = {});
+  void PushBatch(Job::CbBatch func, int batch_size, std::size_t data_size, JobCounter& counter, Job::EPriority priority = Job::NORMAL, const CancellationToken& token = {});
   void PushBarrier(Job::CbSingle func = {[](){ return true; }});
   
-  void PushJobTS(Job::CbSingle func);
-  void PushBatchTS(Job::CbBatch func, int batch_size, std::size_t data_size);
+  void PushJobTS(Job::CbSingle func, Job::EPriority priority = Job::NORMAL, const CancellationToken& token = {});
+  void PushBatchTS(Job::CbBatch func, int batch_size, std::size_t data_size, Job::EPriority priority = Job::NORMAL, const CancellationToken& token = {});
+  void PushJobTS(Job::CbSingle func, JobCounter& counter, Job::EPriority priority = Job::NORMAL, const CancellationToken& token = {});
+  void PushBatchTS(Job::CbBatch func, int batch_size, std::size_t data_size, JobCounter& counter, Job::EPriority priority = Job::NORMAL, const CancellationToken& token = {});
   void PushBarrierTS(Job::CbSingle func = {[](){ return true; }});
   
   auto GetMutex() -> std::timed_mutex& { return lock_; }
+  bool HasCriticalJobs() const { return critical_jobs_.load(std::memory_order_relaxed) > 0; }
+  bool IsBackgroundPaused() const { return background_paused_.load(std::memory_order_relaxed); }
+
+private:
+  void PushJob(Job::CbSingle func, JobCounter::State* counter, Job::EPriority priority, const CancellationToken& token);
+  void PushBatch(Job::CbBatch func, int batch_size, std::size_t data_size, JobCounter::State* counter, Job::EPriority priority, const CancellationToken& token);
+  void Notify(unsigned count);
+  void Push(Job&& job);
+  auto Pop(Job::EPriority lane) -> Job;
+  auto SelectLane(bool barrier_allowed) -> Job::EPriority;
+  bool HasLaneJobs(int lane) const;
+  bool IsEmpty() const;
+  auto GetSize() const -> std::size_t;
 
 private:
-  std::queue<Job> pending_jobs_;
+  constexpr static int v_max_skipped_ = 16;
+
+  std::queue<Job> pending_jobs_[Job::PRIORITIES_COUNT];
+  std::atomic<std::size_t> pending_sizes_[Job::PRIORITIES_COUNT];
+  int skipped_[Job::PRIORITIES_COUNT];
+  std::atomic<int> critical_jobs_;
+  std::atomic<bool> background_paused_;
   std::timed_mutex lock_;
+  bool lazy_batches_;
+  JobManager* manager_;
 
 private:
   friend struct JobManager;
@@ -0,0 +1,181 @@
+// *************************************************************
+// File:    job_telemetry.cc
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#include "job_telemetry.h"
+
+#include <chrono>
+#include <algorithm>
+
+//--private
+
+namespace gdm::_private {
+
+  static unsigned GetDepthBound(int bucket)
+  {
+    return bucket == 0 ? 0 : (1u << bucket) - 1;
+  }
+
+  static int GetDepthPercentile(const JobTelemetry::Worker& worker, double percentile)
+  {
+    uint64_t count = 0;
+    for (uint64_t depth : worker.depth_)
+      count += depth;
+
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < JobTelemetry::v_depth_buckets; ++bucket)
+    {
+      seen += worker.depth_[bucket];
+      if (count && seen >= count * percentile)
+        return bucket;
+    }
+    return 0;
+  }
+
+} // namespace gdm::_private
+
+// --public
+
+gdm::JobTelemetry::Worker gdm::JobTelemetry::GetTotal() const
+{
+  Worker total {};
+  for (const Worker& worker : workers_)
+  {
+    total.jobs_ += worker.jobs_;
+    total.dropped_ += worker.dropped_;
+    total.busy_ns_ += worker.busy_ns_;
+    total.idle_ns_ += worker.idle_ns_;
+    total.sleep_ns_ += worker.sleep_ns_;
+    total.lock_wait_ns_ += worker.lock_wait_ns_;
+    total.steals_ += worker.steals_;
+    for (int i = 0; i < v_depth_buckets; ++i)
+      total.depth_[i] += worker.depth_[i];
+  }
+  return total;
+}
+
+gdm::JobTelemetry gdm::JobTelemetry::operator-(const JobTelemetry& older) const
+{
+  JobTelemetry diff = *this;
+  for (std::size_t w = 0; w < std::min(workers_.size(), older.workers_.size()); ++w)
+  {
+    Worker& worker = diff.workers_[w];
+    const Worker& old = older.workers_[w];
+    worker.jobs_ -= old.jobs_;
+    worker.dropped_ -= old.dropped_;
+    worker.busy_ns_ -= old.busy_ns_;
+    worker.idle_ns_ -= old.idle_ns_;
+    worker.sleep_ns_ -= old.sleep_ns_;
+    worker.lock_wait_ns_ -= old.lock_wait_ns_;
+    worker.steals_ -= old.steals_;
+    for (int i = 0; i < v_depth_buckets; ++i)
+      worker.depth_[i] -= old.depth_[i];
+  }
+  return diff;
+}
+
+void gdm::JobTelemetry::Print(FILE* out, const char* name) const
+{
+  fprintf(out, "%-12s %-10s %-8s %-7s %-7s %-7s %-10s %-8s %-9s %-9s\n",
+    "worker", "jobs", "dropped", "busy%", "idle%", "sleep%", "lock ms", "steals", "depth50", "depth99");
+  for (std::size_t w = 0; w < workers_.size(); ++w)
+  {
+    const Worker& worker = workers_[w];
+    double time = static_cast<double>(worker.busy_ns_ + worker.idle_ns_ + worker.sleep_ns_);
+    double scale = time > 0.0 ? 100.0 / time : 0.0;
+    char worker_name[64];
+    if (w + 1 == workers_.size())
+      snprintf(worker_name, sizeof(worker_name), "%s_other", name);
+    else
+      snprintf(worker_name, sizeof(worker_name), "%s_%d", name, static_cast<int>(w));
+    fprintf(out, "%-12s %-10llu %-8llu %-7.1f %-7.1f %-7.1f %-10.3f %-8llu %-9u %-9u\n", worker_name,
+      static_cast<unsigned long long>(worker.jobs_), static_cast<unsigned long long>(worker.dropped_), worker.busy_ns_ * scale, worker.idle_ns_ * scale, worker.sleep_ns_ * scale,
+      worker.lock_wait_ns_ / 1e6, static_cast<unsigned long long>(worker.steals_),
+      _private::GetDepthBound(_private::GetDepthPercentile(worker, 0.5)), _private::GetDepthBound(_private::GetDepthPercentile(worker, 0.99)));
+  }
+}
+
+int gdm::JobTelemetry::GetDepthBucket(std::size_t depth)
+{
+  int bucket = 0;
+  while (depth && bucket < v_depth_buckets - 1)
+  {
+    depth >>= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+// --public JobCounters
+
+uint64_t gdm::_private::JobCounters::Now()
+{
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void gdm::_private::JobCounters::Add(std::atomic<uint64_t>& counter, uint64_t value)
+{
+  if (shared_)
+    counter.fetch_add(value, std::memory_order_relaxed);
+  else
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+// Time since previous mark goes to the previous state, used by owner only
+
+void gdm::_private::JobCounters::Mark(EState state)
+{
+  const int prev = state_.load(std::memory_order_relaxed);
+  const uint64_t mark = mark_ns_.load(std::memory_order_relaxed);
+  if (prev == state && mark)
+    return;
+
+  const uint64_t now = Now();
+  if (mark)
+    Add(time_ns_[prev], now - mark);
+  state_.store(state, std::memory_order_relaxed);
+  mark_ns_.store(now, std::memory_order_relaxed);
+}
+
+void gdm::_private::JobCounters::AddDepth(std::size_t depth)
+{
+  Add(depth_[JobTelemetry::GetDepthBucket(depth)], 1);
+}
+
+void gdm::_private::JobCounters::AddLockWait(uint64_t start_ns)
+{
+  Add(lock_wait_ns_, Now() - start_ns);
+}
+
+gdm::JobTelemetry::Worker gdm::_private::JobCounters::Read() const
+{
+  JobTelemetry::Worker worker {};
+  worker.jobs_ = jobs_.load(std::memory_order_relaxed);
+  worker.dropped_ = dropped_.load(std::memory_order_relaxed);
+  worker.busy_ns_ = time_ns_[BUSY].load(std::memory_order_relaxed);
+  worker.idle_ns_ = time_ns_[IDLE].load(std::memory_order_relaxed);
+  worker.sleep_ns_ = time_ns_[SLEEP].load(std::memory_order_relaxed);
+
+  // current state lasts since the last mark, but owner may change it meanwhile,
+  //  so this part is approximate
+
+  const uint64_t mark = mark_ns_.load(std::memory_order_relaxed);
+  const uint64_t now = Now();
+  if (mark && now > mark)
+  {
+    switch (state_.load(std::memory_order_relaxed))
+    {
+      case BUSY  : worker.busy_ns_ += now - mark; break;
+      case IDLE  : worker.idle_ns_ += now - mark; break;
+      case SLEEP : worker.sleep_ns_ += now - mark; break;
+    }
+  }
+  worker.lock_wait_ns_ = lock_wait_ns_.load(std::memory_order_relaxed);
+  worker.steals_ = steals_.load(std::memory_order_relaxed);
+  for (int i = 0; i < JobTelemetry::v_depth_buckets; ++i)
+    worker.depth_[i] = depth_[i].load(std::memory_order_relaxed);
+  return worker;
+}
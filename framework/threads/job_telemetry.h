@@ -0,0 +1,91 @@
+// *************************************************************
+// File:    job_telemetry.h
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#ifndef AH_GDM_JOB_TELEMETRY_H
+#define AH_GDM_JOB_TELEMETRY_H
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+
+namespace gdm {
+
+// Snapshot of job manager counters, one entry per worker and the last one
+//  for other threads which helped to execute jobs. Worker is busy from the
+//  first found job till the first failed search, idle while it searches or
+//  spins and sleeping while parked. Dropped jobs were cancelled and never
+//  run, they are not counted in jobs. Lock wait is counted only when the queue
+//  was contended. Queue depth at pop is histogram with power of two buckets:
+//  0, 1, 2-3, 4-7, ...
+
+struct JobTelemetry
+{
+  constexpr static int v_depth_buckets = 16;
+
+  struct Worker
+  {
+    uint64_t jobs_;
+    uint64_t dropped_;
+    uint64_t busy_ns_;
+    uint64_t idle_ns_;
+    uint64_t sleep_ns_;
+    uint64_t lock_wait_ns_;
+    uint64_t steals_;
+    uint64_t depth_[v_depth_buckets];
+  };
+
+  auto GetTotal() const -> Worker;
+  auto GetWorkers() const -> const std::vector<Worker>& { return workers_; }
+  auto operator-(const JobTelemetry& older) const -> JobTelemetry;
+  void Print(FILE* out, const char* name) const;
+
+  static auto GetDepthBucket(std::size_t depth) -> int;
+
+private:
+  std::vector<Worker> workers_;
+
+private:
+  friend struct JobManager;
+
+}; // struct JobTelemetry
+
+namespace _private {
+
+  // Counters of one thread on own cache line. Worker slot is written only by
+  //  its owner with plain stores, slot of helping threads is shared and uses
+  //  atomic adds. Clock is read only when state changes, so worker which is
+  //  never out of jobs doesn't read it at all
+
+  struct alignas(64) JobCounters
+  {
+    enum EState { BUSY, IDLE, SLEEP };
+
+    static auto Now() -> uint64_t;
+
+    void Add(std::atomic<uint64_t>& counter, uint64_t value);
+    void Mark(EState state);
+    void AddDepth(std::size_t depth);
+    void AddLockWait(uint64_t start_ns);
+    auto Read() const -> JobTelemetry::Worker;
+
+    bool shared_ {false};
+    std::atomic<int> state_ {IDLE};
+    std::atomic<uint64_t> mark_ns_ {0};
+    std::atomic<uint64_t> jobs_ {0};
+    std::atomic<uint64_t> dropped_ {0};
+    std::atomic<uint64_t> time_ns_[3] {};
+    std::atomic<uint64_t> lock_wait_ns_ {0};
+    std::atomic<uint64_t> steals_ {0};
+    std::atomic<uint64_t> depth_[JobTelemetry::v_depth_buckets] {};
+
+  }; // struct JobCounters
+
+} // namespace _private
+
+} // namespace gdm
+
+#endif // AH_GDM_JOB_TELEMETRY_H
@@ -0,0 +1,70 @@
+// *************************************************************
+// File:    lightweight_semaphore.cc
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#include "lightweight_semaphore.h"
+
+#include <thread>
+#include <algorithm>
+
+#include "backoff.h"
+
+// --public
+
+gdm::LightweightSemaphore::LightweightSemaphore(int value)
+  : count_{value}
+  , sleepers_{0}
+{
+  assert(value >= 0);
+}
+
+void gdm::LightweightSemaphore::Post(int count)
+{
+  assert(count > 0);
+  const int old_count = count_.fetch_add(count, std::memory_order_release);
+  const int to_wake = std::min(-old_count, count);
+  if (to_wake > 0)
+    sleepers_.Post(to_wake);
+}
+
+void gdm::LightweightSemaphore::Wait()
+{
+  if (!TryWait())
+    WaitWithSpinning();
+}
+
+bool gdm::LightweightSemaphore::TryWait()
+{
+  int count = count_.load(std::memory_order_relaxed);
+  while (count > 0)
+  {
+    if (count_.compare_exchange_weak(count, count - 1, std::memory_order_acquire, std::memory_order_relaxed))
+      return true;
+  }
+  return false;
+}
+
+int gdm::LightweightSemaphore::Get() const
+{
+  return std::max(0, count_.load(std::memory_order_relaxed));
+}
+
+// --private
+
+// Spinning is useless on single cpu, poster can't run while we spin
+
+void gdm::LightweightSemaphore::WaitWithSpinning()
+{
+  static const int s_spin_count = std::thread::hardware_concurrency() > 1 ? v_spin_count : 0;
+
+  for (int i = 0; i < s_spin_count; ++i)
+  {
+    Backoff::Pause();
+    if (TryWait())
+      return;
+  }
+  if (count_.fetch_sub(1, std::memory_order_acquire) <= 0)
+    sleepers_.Wait();
+}
@@ -0,0 +1,42 @@
+// *************************************************************
+// File:    lightweight_semaphore.h
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#ifndef AH_GDM_LIGHTWEIGHT_SEMAPHORE_H
+#define AH_GDM_LIGHTWEIGHT_SEMAPHORE_H
+
+#include <atomic>
+
+#include "threads/semaphore.h"
+
+namespace gdm {
+
+// Counting semaphore for short waits. Count goes below zero by number of
+//  sleepers, waiter spins a bit first and only then takes a place in the
+//  sleeping semaphore. Post enters it only when there are sleepers
+
+struct LightweightSemaphore
+{
+  constexpr static int v_spin_count = 256;
+
+  explicit LightweightSemaphore(int value);
+
+  void Post(int count = 1);
+  void Wait();
+  bool TryWait();
+  int Get() const;
+
+private:
+  void WaitWithSpinning();
+
+private:
+  std::atomic<int> count_;
+  Semaphore sleepers_;
+
+}; // struct LightweightSemaphore
+
+}  // namespace gdm
+
+#endif // AH_GDM_LIGHTWEIGHT_SEMAPHORE_H
@@ -0,0 +1,118 @@
+// *************************************************************
+// File:    mcs_lock.cc
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#include "mcs_lock.h"
+
+#include <thread>
+
+#include "backoff.h"
+
+//--private
+
+namespace gdm::_private {
+
+  struct McsNodes
+  {
+    ~McsNodes()
+    {
+      while (free_)
+      {
+        McsLock::Node* node = free_;
+        free_ = node->free_next_;
+        delete node;
+      }
+    }
+
+    McsLock::Node* free_ = nullptr;
+
+  }; // struct McsNodes
+
+  static thread_local McsNodes s_mcs_nodes;
+
+  static void WaitMcs(Backoff& backoff)
+  {
+    if (!backoff.Spin())
+      std::this_thread::yield();
+  }
+
+} // namespace gdm::_private
+
+// --public
+
+gdm::McsLock::McsLock()
+  : tail_{nullptr}
+  , owner_{nullptr}
+{ }
+
+void gdm::McsLock::Lock()
+{
+  Node* node = AcquireNode();
+  Node* prev = tail_.exchange(node, std::memory_order_acq_rel);
+  if (prev)
+  {
+    prev->next_.store(node, std::memory_order_release);
+    Backoff backoff;
+    while (node->locked_.load(std::memory_order_acquire))
+      _private::WaitMcs(backoff);
+  }
+  owner_ = node;
+}
+
+bool gdm::McsLock::TryLock()
+{
+  Node* node = AcquireNode();
+  Node* expected = nullptr;
+  if (!tail_.compare_exchange_strong(expected, node, std::memory_order_acquire, std::memory_order_relaxed))
+  {
+    ReleaseNode(node);
+    return false;
+  }
+  owner_ = node;
+  return true;
+}
+
+// When there is no known successor, but tail is not ours, somebody is
+//  between exchange of tail and link to our node, so wait for the link
+
+void gdm::McsLock::Unlock()
+{
+  Node* node = owner_;
+  Node* next = node->next_.load(std::memory_order_acquire);
+  if (!next)
+  {
+    Node* expected = node;
+    if (tail_.compare_exchange_strong(expected, nullptr, std::memory_order_release, std::memory_order_relaxed))
+    {
+      ReleaseNode(node);
+      return;
+    }
+    Backoff backoff;
+    while (!(next = node->next_.load(std::memory_order_acquire)))
+      _private::WaitMcs(backoff);
+  }
+  next->locked_.store(false, std::memory_order_release);
+  ReleaseNode(node);
+}
+
+// --private
+
+gdm::McsLock::Node* gdm::McsLock::AcquireNode()
+{
+  Node* node = _private::s_mcs_nodes.free_;
+  if (node)
+    _private::s_mcs_nodes.free_ = node->free_next_;
+  else
+    node = new Node{};
+  node->next_.store(nullptr, std::memory_order_relaxed);
+  node->locked_.store(true, std::memory_order_relaxed);
+  return node;
+}
+
+void gdm::McsLock::ReleaseNode(Node* node)
+{
+  node->free_next_ = _private::s_mcs_nodes.free_;
+  _private::s_mcs_nodes.free_ = node;
+}
@@ -0,0 +1,50 @@
+// *************************************************************
+// File:    mcs_lock.h
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#ifndef AH_GDM_MCS_LOCK_H
+#define AH_GDM_MCS_LOCK_H
+
+#include <atomic>
+
+namespace gdm {
+
+// Queue lock, fair as ticket lock, but each waiter spins on own node, so
+//  unlock touches only the next waiter line. Nodes are taken from per thread
+//  free list, so lock has usual interface and one thread may hold many locks
+
+struct McsLock
+{
+  struct alignas(64) Node
+  {
+    std::atomic<Node*> next_;
+    std::atomic<bool> locked_;
+    Node* free_next_;
+
+  }; // struct Node
+
+  McsLock();
+
+  void Lock();
+  bool TryLock();
+  void Unlock();
+
+  void lock() { Lock(); }
+  bool try_lock() { return TryLock(); }
+  void unlock() { Unlock(); }
+
+private:
+  static auto AcquireNode() -> Node*;
+  static void ReleaseNode(Node* node);
+
+private:
+  std::atomic<Node*> tail_;
+  Node* owner_;
+
+}; // struct McsLock
+
+}  // namespace gdm
+
+#endif // AH_GDM_MCS_LOCK_H
@@ -10,11 +10,24 @@
 #include <future>
 #include <vector>
 
+#include "threads/task.h"
+
 namespace gdm::mt {
 
   template <class Fn, class K>
   void WhenAll(Fn&& fn, const std::vector<std::future<K>>& futures);
 
+  // Task is done when all tasks are done, continuations of the result are
+  //  pushed to mgr. Empty list gives ready task
+
+  template <class T>
+  auto WhenAll(JobManager& mgr, const std::vector<Task<T>>& tasks) -> Task<void>;
+
+  // Result is index of the first finished task
+
+  template <class T>
+  auto WhenAny(JobManager& mgr, const std::vector<Task<T>>& tasks) -> Task<std::size_t>;
+
 }  // namespace gdmLLnt
 
 #include "mt_utils.inl"
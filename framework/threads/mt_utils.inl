@@ -7,15 +7,33 @@
 #include "mt_utils.h"
 
 #include <utility>
+#include <assert.h>
 
 //--private
 
 namespace gdm::_private {
 
-struct Notificator
+struct WhenAllState : TaskState<void>
 {
+  WhenAllState(JobManager* mgr, int count)
+    : TaskState<void>(mgr, count + 1)
+    , remaining_{count}
+  { }
 
-}; // struct Notificator
+  std::atomic<int> remaining_;
+
+}; // struct WhenAllState
+
+struct WhenAnyState : TaskState<std::size_t>
+{
+  WhenAnyState(JobManager* mgr, int count)
+    : TaskState<std::size_t>(mgr, count + 1)
+    , done_{false}
+  { }
+
+  std::atomic<bool> done_;
+
+}; // struct WhenAnyState
 
 } // namespace gdm::_private
 
@@ -24,5 +42,50 @@ struct Notificator
 template <class Fn, class K>
 void gdm::mt::WhenAll(Fn&& fn, const std::vector<std::future<K>>& futures)
 {
+  for (const std::future<K>& future : futures)
+    future.wait();
+  fn();
+}
+
+template <class T>
+auto gdm::mt::WhenAll(JobManager& mgr, const std::vector<Task<T>>& tasks) -> Task<void>
+{
+  auto* state = new _private::WhenAllState(&mgr, static_cast<int>(tasks.size()));
+  if (tasks.empty())
+    state->Complete();
+
+  for (const Task<T>& task : tasks)
+  {
+    auto call = [state]()
+    {
+      if (state->remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        state->Complete();
+      _private::TaskStateBase::Release(state);
+    };
+    task.GetState()->Subscribe(new _private::TaskContinuation{std::move(call), nullptr, true});
+  }
+  return Task<void>{state};
+}
+
+template <class T>
+auto gdm::mt::WhenAny(JobManager& mgr, const std::vector<Task<T>>& tasks) -> Task<std::size_t>
+{
+  assert(!tasks.empty() && "WhenAny of nothing never completes");
 
-}
\ No newline at end of file
+  auto* state = new _private::WhenAnyState(&mgr, static_cast<int>(tasks.size()));
+  for (std::size_t i = 0; i < tasks.size(); ++i)
+  {
+    auto call = [state, i]()
+    {
+      if (!state->done_.exchange(true, std::memory_order_acq_rel))
+      {
+        auto index = [i](){ return i; };
+        state->Run(index);
+        state->Complete();
+      }
+      _private::TaskStateBase::Release(state);
+    };
+    tasks[i].GetState()->Subscribe(new _private::TaskContinuation{std::move(call), nullptr, true});
+  }
+  return Task<std::size_t>{state};
+}
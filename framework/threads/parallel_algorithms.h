@@ -0,0 +1,63 @@
+// *************************************************************
+// File:    parallel_algorithms.h
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#ifndef AH_GDM_PARALLEL_ALGORITHMS_H
+#define AH_GDM_PARALLEL_ALGORITHMS_H
+
+#include <vector>
+#include <functional>
+
+#include "threads/job_manager.h"
+#include "threads/parallel_for.h"
+
+// Parallel versions of std algorithms over random access ranges. Range is
+//  splitted into few blocks per worker, calling thread takes part in work and
+//  returns when all is done. Small ranges are processed serially. Algorithms
+//  which need temporary buffer require default constructible values
+
+namespace gdm::mt {
+
+  template <class InIt, class OutIt, class Fn>
+  void Transform(JobManager& mgr, InIt first, InIt last, OutIt out, Fn&& fn);
+
+  // Op should be associative, blocks are combined in order
+
+  template <class It, class T, class Op = std::plus<>>
+  auto Reduce(JobManager& mgr, It first, It last, T init, Op op = {}) -> T;
+
+  // Output may be the same range as input
+
+  template <class InIt, class OutIt, class Op = std::plus<>>
+  void InclusiveScan(JobManager& mgr, InIt first, InIt last, OutIt out, Op op = {});
+  template <class InIt, class OutIt, class T, class Op = std::plus<>>
+  void ExclusiveScan(JobManager& mgr, InIt first, InIt last, OutIt out, T init, Op op = {});
+
+  // Stable sorts. Integer and float values (or keys given by key_fn) are
+  //  sorted with LSD radix sort, passes where all keys have the same digit
+  //  are skipped. Others and custom comparison use merge sort
+
+  template <class It>
+  void Sort(JobManager& mgr, It first, It last);
+  template <class It, class Less>
+  void Sort(JobManager& mgr, It first, It last, Less less);
+  template <class It, class KeyFn>
+  void SortByKey(JobManager& mgr, It first, It last, KeyFn key_fn);
+
+  // Stable, returns the first element for which pred is false
+
+  template <class It, class Pred>
+  auto Partition(JobManager& mgr, It first, It last, Pred pred) -> It;
+
+  // Counts elements per bucket, bucket_fn returns index in [0, buckets)
+
+  template <class It, class BucketFn>
+  auto Histogram(JobManager& mgr, It first, It last, int buckets, BucketFn bucket_fn) -> std::vector<std::size_t>;
+
+} // namespace gdm::mt
+
+#include "parallel_algorithms.inl"
+
+#endif // AH_GDM_PARALLEL_ALGORITHMS_H
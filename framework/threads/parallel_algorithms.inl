@@ -0,0 +1,496 @@
+// *************************************************************
+// File:    parallel_algorithms.inl
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#include "parallel_algorithms.h"
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <utility>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <assert.h>
+
+//--private
+
+namespace gdm::_private {
+
+  constexpr int v_algo_min_block = 4096;
+  constexpr int v_algo_blocks_per_worker = 4;
+  constexpr int v_radix_bits = 8;
+  constexpr int v_radix_digits = 1 << v_radix_bits;
+
+  template <class It>
+  using IteratorValue = typename std::iterator_traits<It>::value_type;
+
+  inline bool IsSmallRange(int count)
+  {
+    return count < v_algo_min_block * 2;
+  }
+
+  // Enough blocks to balance uneven workers, but not smaller than min block
+
+  inline int GetBlocksCount(JobManager& mgr, int count)
+  {
+    const int by_size = (count + v_algo_min_block - 1) / v_algo_min_block;
+    const int by_workers = static_cast<int>(mgr.GetWorkersCount() + 1) * v_algo_blocks_per_worker;
+    return std::max(1, std::min(by_size, by_workers));
+  }
+
+  inline int GetBlockBegin(int blocks, int count, int block)
+  {
+    return static_cast<int>(static_cast<int64_t>(count) * block / blocks);
+  }
+
+  // Calls fn(block, from, to) for each block of range
+
+  template <class Fn>
+  inline void ForEachBlock(JobManager& mgr, int blocks, int count, Fn&& fn)
+  {
+    auto call = [&fn, blocks, count](int block)
+    {
+      fn(block, GetBlockBegin(blocks, count, block), GetBlockBegin(blocks, count, block + 1));
+    };
+    mt::ParallelFor(mgr, {0, blocks}, call);
+  }
+
+  template <class SrcIt, class DstIt>
+  inline void MoveBlocks(JobManager& mgr, int blocks, int count, SrcIt src, DstIt dst)
+  {
+    ForEachBlock(mgr, blocks, count, [src, dst](int, int from, int to)
+    {
+      std::move(src + from, src + to, dst + from);
+    });
+  }
+
+  // Block sums are scanned serially, then blocks are scanned in parallel
+  //  starting from own offset. Without init the first block has no offset
+
+  template <class InIt, class OutIt, class T, class Op>
+  inline void Scan(JobManager& mgr, InIt first, int count, OutIt out, const T* init, Op& op, bool inclusive)
+  {
+    const int blocks = GetBlocksCount(mgr, count);
+    std::vector<T> sums(blocks, init ? *init : T(first[0]));
+    ForEachBlock(mgr, blocks, count, [&](int block, int from, int to)
+    {
+      T sum = first[from];
+      for (int i = from + 1; i < to; ++i)
+        sum = op(sum, first[i]);
+      sums[block] = std::move(sum);
+    });
+
+    std::vector<T> offsets(blocks, sums[0]);
+    for (int block = 1; block < blocks; ++block)
+      offsets[block] = op(offsets[block - 1], sums[block]);
+    if (init)
+    {
+      for (int block = blocks - 1; block > 0; --block)
+        offsets[block] = op(*init, offsets[block - 1]);
+      offsets[0] = *init;
+    }
+    else
+    {
+      for (int block = blocks - 1; block > 0; --block)
+        offsets[block] = offsets[block - 1];
+    }
+
+    ForEachBlock(mgr, blocks, count, [&](int block, int from, int to)
+    {
+      if (inclusive)
+      {
+        T sum = (init || block) ? op(offsets[block], first[from]) : T(first[from]);
+        out[from] = sum;
+        for (int i = from + 1; i < to; ++i)
+        {
+          sum = op(sum, first[i]);
+          out[i] = sum;
+        }
+      }
+      else
+      {
+        T sum = offsets[block];
+        for (int i = from; i < to; ++i)
+        {
+          T value = first[i];
+          out[i] = sum;
+          sum = op(sum, value);
+        }
+      }
+    });
+  }
+
+  template <class K>
+  struct IsRadixKey : std::bool_constant<(std::is_integral_v<K> && !std::is_same_v<K, bool>) ||
+    (std::is_floating_point_v<K> && (sizeof(K) == 4 || sizeof(K) == 8))> { };
+
+  // Maps key to unsigned integer with the same order. Negative floats have
+  //  all bits flipped, positive ones only the sign bit
+
+  template <class K>
+  inline auto GetRadixKey(K key)
+  {
+    if constexpr (std::is_floating_point_v<K>)
+    {
+      using U = std::conditional_t<sizeof(K) == 4, uint32_t, uint64_t>;
+      const U sign = U(1) << (sizeof(K) * 8 - 1);
+      U bits;
+      std::memcpy(&bits, &key, sizeof(K));
+      return (bits & sign) ? U(~bits) : U(bits | sign);
+    }
+    else
+    {
+      using U = std::make_unsigned_t<K>;
+      if constexpr (std::is_signed_v<K>)
+        return U(U(key) ^ U(U(1) << (sizeof(K) * 8 - 1)));
+      else
+        return U(key);
+    }
+  }
+
+  // One stable pass by digit at shift: counts per block, then blocks scatter
+  //  into own slots. Returns false without moving if all keys have the same digit
+
+  template <class SrcIt, class DstIt, class KeyFn>
+  inline bool RadixPass(JobManager& mgr, SrcIt src, DstIt dst, int blocks, int count, KeyFn& key_fn, int shift)
+  {
+    auto get_digit = [&key_fn, shift](const IteratorValue<SrcIt>& value)
+    {
+      return static_cast<std::size_t>(GetRadixKey(key_fn(value)) >> shift) & (v_radix_digits - 1);
+    };
+
+    std::vector<std::size_t> offsets(static_cast<std::size_t>(blocks) * v_radix_digits, 0);
+    ForEachBlock(mgr, blocks, count, [&](int block, int from, int to)
+    {
+      std::size_t* counts = &offsets[static_cast<std::size_t>(block) * v_radix_digits];
+      for (int i = from; i < to; ++i)
+        ++counts[get_digit(src[i])];
+    });
+
+    // digit major order: block places items after the same digit of previous blocks
+
+    std::size_t offset = 0;
+    for (int digit = 0; digit < v_radix_digits; ++digit)
+    {
+      const std::size_t digit_begin = offset;
+      for (int block = 0; block < blocks; ++block)
+      {
+        std::size_t& slot = offsets[static_cast<std::size_t>(block) * v_radix_digits + digit];
+        const std::size_t counted = slot;
+        slot = offset;
+        offset += counted;
+      }
+      if (offset - digit_begin == static_cast<std::size_t>(count))
+        return false;
+    }
+
+    ForEachBlock(mgr, blocks, count, [&](int block, int from, int to)
+    {
+      std::size_t* slots = &offsets[static_cast<std::size_t>(block) * v_radix_digits];
+      for (int i = from; i < to; ++i)
+        dst[slots[get_digit(src[i])]++] = std::move(src[i]);
+    });
+    return true;
+  }
+
+  template <class It, class KeyFn>
+  inline void RadixSort(JobManager& mgr, It first, int count, KeyFn& key_fn)
+  {
+    using Key = decltype(GetRadixKey(key_fn(*first)));
+
+    std::vector<IteratorValue<It>> buffer(count);
+    const int blocks = GetBlocksCount(mgr, count);
+    bool in_buffer = false;
+    for (int shift = 0; shift < static_cast<int>(sizeof(Key)) * 8; shift += v_radix_bits)
+    {
+      if (in_buffer)
+        in_buffer = !RadixPass(mgr, buffer.begin(), first, blocks, count, key_fn, shift);
+      else
+        in_buffer = RadixPass(mgr, first, buffer.begin(), blocks, count, key_fn, shift);
+    }
+    if (in_buffer)
+      MoveBlocks(mgr, blocks, count, buffer.begin(), first);
+  }
+
+  // Number of elements taken from a among the first diag elements of
+  //  stable merge of a and b
+
+  template <class It, class Less>
+  inline int GetMergeSplit(It a, int a_count, It b, int b_count, int diag, Less& less)
+  {
+    int lo = std::max(0, diag - b_count);
+    int hi = std::min(diag, a_count);
+    while (lo < hi)
+    {
+      const int mid = lo + (hi - lo) / 2;
+      if (less(b[diag - mid - 1], a[mid]))
+        hi = mid;
+      else
+        lo = mid + 1;
+    }
+    return lo;
+  }
+
+  // Merges pairs of sorted runs. Output of each pair is cut into parts and
+  //  each part finds its inputs by binary search, so even the last pass with
+  //  the single pair is parallel. All splits are found before any merge
+  //  starts, since merges move values out of runs which searches read
+
+  template <class SrcIt, class DstIt, class Less>
+  inline void MergePass(JobManager& mgr, SrcIt src, DstIt dst, int count, int run, int part, Less& less)
+  {
+    const int64_t pair_size = static_cast<int64_t>(run) * 2;
+    const int pairs = static_cast<int>((count + pair_size - 1) / pair_size);
+    const int parts = static_cast<int>((pair_size + part - 1) / part);
+
+    struct Part
+    {
+      int begin;
+      int middle;
+      int end;
+      int from;
+      int to;
+    };
+
+    auto get_part = [&](int task)
+    {
+      Part p;
+      p.begin = static_cast<int>(task / parts * pair_size);
+      p.middle = static_cast<int>(std::min<int64_t>(p.begin + static_cast<int64_t>(run), count));
+      p.end = static_cast<int>(std::min<int64_t>(p.begin + pair_size, count));
+      p.from = static_cast<int>(std::min<int64_t>(p.begin + static_cast<int64_t>(task % parts) * part, p.end));
+      p.to = static_cast<int>(std::min<int64_t>(p.from + static_cast<int64_t>(part), p.end));
+      return p;
+    };
+
+    std::vector<int> splits(static_cast<std::size_t>(pairs) * parts);
+    mt::ParallelFor(mgr, {0, pairs * parts}, [&](int task)
+    {
+      const Part p = get_part(task);
+      splits[task] = GetMergeSplit(src + p.begin, p.middle - p.begin, src + p.middle, p.end - p.middle, p.from - p.begin, less);
+    });
+
+    // part which doesn't end the pair is followed by the part of the same pair
+
+    mt::ParallelFor(mgr, {0, pairs * parts}, [&](int task)
+    {
+      const Part p = get_part(task);
+      if (p.from == p.to)
+        return;
+
+      SrcIt a = src + p.begin;
+      SrcIt b = src + p.middle;
+      const int a_from = splits[task];
+      const int a_to = p.to == p.end ? p.middle - p.begin : splits[task + 1];
+      std::merge(std::make_move_iterator(a + a_from), std::make_move_iterator(a + a_to),
+        std::make_move_iterator(b + (p.from - p.begin - a_from)), std::make_move_iterator(b + (p.to - p.begin - a_to)), dst + p.from, less);
+    });
+  }
+
+  template <class It, class Less>
+  inline void MergeSort(JobManager& mgr, It first, int count, Less& less)
+  {
+    const int blocks = GetBlocksCount(mgr, count);
+    const int run = (count + blocks - 1) / blocks;
+    mt::ParallelFor(mgr, {0, blocks}, [&](int block)
+    {
+      const int from = std::min(block * run, count);
+      const int to = std::min(from + run, count);
+      std::stable_sort(first + from, first + to, less);
+    });
+
+    std::vector<IteratorValue<It>> buffer(count);
+    bool in_buffer = false;
+    for (int merged = run; merged < count; merged *= 2)
+    {
+      if (in_buffer)
+        MergePass(mgr, buffer.begin(), first, count, merged, run, less);
+      else
+        MergePass(mgr, first, buffer.begin(), count, merged, run, less);
+      in_buffer = !in_buffer;
+    }
+    if (in_buffer)
+      MoveBlocks(mgr, blocks, count, buffer.begin(), first);
+  }
+
+} // namespace gdm::_private
+
+//--public
+
+template <class InIt, class OutIt, class Fn>
+inline void gdm::mt::Transform(JobManager& mgr, InIt first, InIt last, OutIt out, Fn&& fn)
+{
+  auto call = [first, out, &fn](int from, int count)
+  {
+    for (int i = from; i < from + count; ++i)
+      out[i] = fn(first[i]);
+  };
+  ParallelFor(mgr, {0, static_cast<int>(last - first)}, call);
+}
+
+template <class It, class T, class Op>
+inline auto gdm::mt::Reduce(JobManager& mgr, It first, It last, T init, Op op) -> T
+{
+  const int count = static_cast<int>(last - first);
+  if (_private::IsSmallRange(count))
+    return std::accumulate(first, last, std::move(init), op);
+
+  const int blocks = _private::GetBlocksCount(mgr, count);
+  std::vector<T> sums(blocks, init);
+  _private::ForEachBlock(mgr, blocks, count, [&](int block, int from, int to)
+  {
+    T sum = first[from];
+    for (int i = from + 1; i < to; ++i)
+      sum = op(std::move(sum), first[i]);
+    sums[block] = std::move(sum);
+  });
+
+  for (T& sum : sums)
+    init = op(std::move(init), sum);
+  return init;
+}
+
+template <class InIt, class OutIt, class Op>
+inline void gdm::mt::InclusiveScan(JobManager& mgr, InIt first, InIt last, OutIt out, Op op)
+{
+  using T = _private::IteratorValue<InIt>;
+
+  const int count = static_cast<int>(last - first);
+  if (_private::IsSmallRange(count))
+    std::inclusive_scan(first, last, out, op);
+  else
+    _private::Scan(mgr, first, count, out, static_cast<const T*>(nullptr), op, true);
+}
+
+template <class InIt, class OutIt, class T, class Op>
+inline void gdm::mt::ExclusiveScan(JobManager& mgr, InIt first, InIt last, OutIt out, T init, Op op)
+{
+  const int count = static_cast<int>(last - first);
+  if (_private::IsSmallRange(count))
+    std::exclusive_scan(first, last, out, init, op);
+  else
+    _private::Scan(mgr, first, count, out, &init, op, false);
+}
+
+template <class It>
+inline void gdm::mt::Sort(JobManager& mgr, It first, It last)
+{
+  using T = _private::IteratorValue<It>;
+
+  if constexpr (_private::IsRadixKey<T>::value)
+    SortByKey(mgr, first, last, [](const T& value){ return value; });
+  else
+    Sort(mgr, first, last, std::less<>{});
+}
+
+template <class It, class Less>
+inline void gdm::mt::Sort(JobManager& mgr, It first, It last, Less less)
+{
+  const int count = static_cast<int>(last - first);
+  if (_private::IsSmallRange(count))
+    std::stable_sort(first, last, less);
+  else
+    _private::MergeSort(mgr, first, count, less);
+}
+
+template <class It, class KeyFn>
+inline void gdm::mt::SortByKey(JobManager& mgr, It first, It last, KeyFn key_fn)
+{
+  using Key = std::decay_t<decltype(key_fn(*first))>;
+  static_assert(_private::IsRadixKey<Key>::value, "Key should be integer or float");
+
+  const int count = static_cast<int>(last - first);
+  if (_private::IsSmallRange(count))
+  {
+    auto less = [&key_fn](const auto& a, const auto& b)
+    {
+      return _private::GetRadixKey<Key>(key_fn(a)) < _private::GetRadixKey<Key>(key_fn(b));
+    };
+    std::stable_sort(first, last, less);
+  }
+  else
+    _private::RadixSort(mgr, first, count, key_fn);
+}
+
+template <class It, class Pred>
+inline auto gdm::mt::Partition(JobManager& mgr, It first, It last, Pred pred) -> It
+{
+  const int count = static_cast<int>(last - first);
+  if (_private::IsSmallRange(count))
+    return std::stable_partition(first, last, pred);
+
+  const int blocks = _private::GetBlocksCount(mgr, count);
+  std::vector<uint8_t> flags(count);
+  std::vector<int> offsets(static_cast<std::size_t>(blocks) * 2);
+  _private::ForEachBlock(mgr, blocks, count, [&](int block, int from, int to)
+  {
+    int passed = 0;
+    for (int i = from; i < to; ++i)
+    {
+      flags[i] = pred(first[i]) ? 1 : 0;
+      passed += flags[i];
+    }
+    offsets[block * 2] = passed;
+  });
+
+  int passed = 0;
+  for (int block = 0; block < blocks; ++block)
+    passed += offsets[block * 2];
+
+  int passed_offset = 0;
+  int failed_offset = passed;
+  for (int block = 0; block < blocks; ++block)
+  {
+    const int size = _private::GetBlockBegin(blocks, count, block + 1) - _private::GetBlockBegin(blocks, count, block);
+    const int block_passed = offsets[block * 2];
+    offsets[block * 2] = passed_offset;
+    offsets[block * 2 + 1] = failed_offset;
+    passed_offset += block_passed;
+    failed_offset += size - block_passed;
+  }
+
+  std::vector<_private::IteratorValue<It>> buffer(count);
+  _private::ForEachBlock(mgr, blocks, count, [&](int block, int from, int to)
+  {
+    int passed_slot = offsets[block * 2];
+    int failed_slot = offsets[block * 2 + 1];
+    for (int i = from; i < to; ++i)
+      buffer[flags[i] ? passed_slot++ : failed_slot++] = std::move(first[i]);
+  });
+  _private::MoveBlocks(mgr, blocks, count, buffer.begin(), first);
+  return first + passed;
+}
+
+template <class It, class BucketFn>
+inline auto gdm::mt::Histogram(JobManager& mgr, It first, It last, int buckets, BucketFn bucket_fn) -> std::vector<std::size_t>
+{
+  const int count = static_cast<int>(last - first);
+  const int blocks = _private::IsSmallRange(count) ? 1 : _private::GetBlocksCount(mgr, count);
+
+  std::vector<std::size_t> counts(static_cast<std::size_t>(blocks) * buckets, 0);
+  auto count_block = [&](int block, int from, int to)
+  {
+    std::size_t* block_counts = &counts[static_cast<std::size_t>(block) * buckets];
+    for (int i = from; i < to; ++i)
+    {
+      const int bucket = bucket_fn(first[i]);
+      assert(bucket >= 0 && bucket < buckets && "Bucket is out of range");
+      ++block_counts[bucket];
+    }
+  };
+  if (blocks == 1)
+    count_block(0, 0, count);
+  else
+    _private::ForEachBlock(mgr, blocks, count, count_block);
+
+  std::vector<std::size_t> result(counts.begin(), counts.begin() + buckets);
+  for (int block = 1; block < blocks; ++block)
+  {
+    for (int bucket = 0; bucket < buckets; ++bucket)
+      result[bucket] += counts[static_cast<std::size_t>(block) * buckets + bucket];
+  }
+  return result;
+}
@@ -0,0 +1,31 @@
+// *************************************************************
+// File:    parallel_for.h
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#ifndef AH_GDM_PARALLEL_FOR_H
+#define AH_GDM_PARALLEL_FOR_H
+
+#include "threads/job_manager.h"
+
+namespace gdm::mt {
+
+  struct Range
+  {
+    int from;
+    int to;
+  };
+
+  // Calls fn(i) for each index or fn(from, count) for chunks of range.
+  //  Grain is picked from measured cost of item, range is splitted
+  //  only when there are idle workers or previous part was stolen
+
+  template <class Fn>
+  void ParallelFor(JobManager& mgr, Range range, Fn&& fn);
+
+} // namespace gdm::mt
+
+#include "parallel_for.inl"
+
+#endif // AH_GDM_PARALLEL_FOR_H
@@ -0,0 +1,122 @@
+// *************************************************************
+// File:    parallel_for.inl
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#include "parallel_for.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <type_traits>
+
+//--private
+
+namespace gdm::_private {
+
+  constexpr double v_pfor_sample_ns = 10'000.0;
+  constexpr double v_pfor_chunk_ns = 30'000.0;
+
+  template <class Fn>
+  struct ParallelForState
+  {
+    JobManager& mgr_;
+    Fn& fn_;
+    int grain_;
+    std::atomic<int> remaining_;
+
+  }; // struct ParallelForState
+
+  template <class Fn>
+  inline void ParallelForCall(Fn& fn, int from, int to)
+  {
+    if constexpr (std::is_invocable_v<Fn&, int, int>)
+      fn(from, to - from);
+    else
+    {
+      for (int i = from; i < to; ++i)
+        fn(i);
+    }
+  }
+
+  // Processes range by grain sized chunks, before each chunk gives the
+  //  right half away if somebody is ready to take it
+
+  template <class Fn>
+  inline void ParallelForRun(ParallelForState<Fn>* state, int from, int to)
+  {
+    const int grain = state->grain_;
+    while (from < to)
+    {
+      if (to - from > grain * 2 && state->mgr_.HasStealDemand())
+      {
+        int middle = from + (to - from) / 2;
+        state->mgr_.Spawn(Job{[state, middle, to](){ ParallelForRun(state, middle, to); }, Job::SINGLE});
+        to = middle;
+      }
+      int end = std::min(from + grain, to);
+      ParallelForCall(state->fn_, from, end);
+      state->remaining_.fetch_sub(end - from, std::memory_order_acq_rel);
+      from = end;
+    }
+  }
+
+  // Runs first items on the calling thread with doubling chunks until
+  //  spent enough time to get stable per item cost. Returns ns per item
+
+  template <class Fn>
+  inline double ParallelForSample(Fn& fn, int& from, int to)
+  {
+    using Clock = std::chrono::steady_clock;
+
+    double spent_ns = 0.0;
+    int done = 0;
+    for (int count = 1; from < to && spent_ns < v_pfor_sample_ns; count *= 2)
+    {
+      int end = std::min(from + count, to);
+      Clock::time_point start = Clock::now();
+      ParallelForCall(fn, from, end);
+      spent_ns += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+      done += end - from;
+      from = end;
+    }
+    return done ? spent_ns / done : 0.0;
+  }
+
+} // namespace gdm::_private
+
+//--public
+
+template <class Fn>
+inline void gdm::mt::ParallelFor(JobManager& mgr, Range range, Fn&& fn)
+{
+  using Functor = std::remove_reference_t<Fn>;
+
+  // lambdas have unique types, so this is cost per call site
+
+  static std::atomic<double> s_item_ns {0.0};
+
+  int from = range.from;
+  double item_ns = _private::ParallelForSample(fn, from, range.to);
+  double cached_ns = s_item_ns.load(std::memory_order_relaxed);
+  if (cached_ns > 0.0)
+    item_ns = (cached_ns * 3.0 + item_ns) / 4.0;
+  s_item_ns.store(item_ns, std::memory_order_relaxed);
+
+  if (from >= range.to)
+    return;
+
+  const int count = range.to - from;
+  const double grain = item_ns > 0.0 ? _private::v_pfor_chunk_ns / item_ns : count;
+
+  _private::ParallelForState<Functor> state {mgr, fn, static_cast<int>(std::clamp(grain, 1.0, double(count))), {count}};
+  _private::ParallelForRun(&state, from, range.to);
+
+  while (state.remaining_.load(std::memory_order_acquire) > 0)
+  {
+    if (!mgr.HelpExecute())
+      std::this_thread::yield();
+  }
+}
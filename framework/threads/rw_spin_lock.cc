@@ -0,0 +1,79 @@
+// *************************************************************
+// File:    rw_spin_lock.cc
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#include "rw_spin_lock.h"
+
+#include <thread>
+#include <assert.h>
+
+#include "backoff.h"
+
+// --public
+
+gdm::RwSpinLock::RwSpinLock()
+  : state_{0}
+{ }
+
+void gdm::RwSpinLock::Lock()
+{
+  Backoff backoff;
+  for (;;)
+  {
+    unsigned state = state_.load(std::memory_order_relaxed);
+    if ((state & ~v_writer_pending) == 0)
+    {
+      if (state_.compare_exchange_weak(state, v_writer, std::memory_order_acquire, std::memory_order_relaxed))
+        return;
+    }
+    else if (!(state & v_writer_pending))
+      state_.fetch_or(v_writer_pending, std::memory_order_relaxed);
+    if (!backoff.Spin())
+      std::this_thread::yield();
+  }
+}
+
+bool gdm::RwSpinLock::TryLock()
+{
+  unsigned state = state_.load(std::memory_order_relaxed);
+  if ((state & ~v_writer_pending) != 0)
+    return false;
+  return state_.compare_exchange_strong(state, v_writer, std::memory_order_acquire, std::memory_order_relaxed);
+}
+
+// Pending bit set by other writers while we held the lock is kept
+
+void gdm::RwSpinLock::Unlock()
+{
+  assert(state_.load(std::memory_order_relaxed) & v_writer);
+  state_.fetch_and(~v_writer, std::memory_order_release);
+}
+
+void gdm::RwSpinLock::LockShared()
+{
+  Backoff backoff;
+  while (!TryLockShared())
+  {
+    if (!backoff.Spin())
+      std::this_thread::yield();
+  }
+}
+
+bool gdm::RwSpinLock::TryLockShared()
+{
+  unsigned state = state_.load(std::memory_order_relaxed);
+  while (!(state & (v_writer | v_writer_pending)))
+  {
+    if (state_.compare_exchange_weak(state, state + v_reader, std::memory_order_acquire, std::memory_order_relaxed))
+      return true;
+  }
+  return false;
+}
+
+void gdm::RwSpinLock::UnlockShared()
+{
+  assert(state_.load(std::memory_order_relaxed) >= v_reader);
+  state_.fetch_sub(v_reader, std::memory_order_release);
+}
@@ -0,0 +1,48 @@
+// *************************************************************
+// File:    rw_spin_lock.h
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#ifndef AH_GDM_RW_SPIN_LOCK_H
+#define AH_GDM_RW_SPIN_LOCK_H
+
+#include <atomic>
+
+namespace gdm {
+
+// Readers-writer spin lock in one word: writer bit, writer pending bit and
+//  readers count. Waiting writer sets pending bit and new readers wait for
+//  it, so stream of readers can't starve writers. Lower case names are for
+//  std::unique_lock and std::shared_lock
+
+struct RwSpinLock
+{
+  RwSpinLock();
+
+  void Lock();
+  bool TryLock();
+  void Unlock();
+  void LockShared();
+  bool TryLockShared();
+  void UnlockShared();
+
+  void lock() { Lock(); }
+  bool try_lock() { return TryLock(); }
+  void unlock() { Unlock(); }
+  void lock_shared() { LockShared(); }
+  bool try_lock_shared() { return TryLockShared(); }
+  void unlock_shared() { UnlockShared(); }
+
+private:
+  constexpr static unsigned v_writer = 1;
+  constexpr static unsigned v_writer_pending = 2;
+  constexpr static unsigned v_reader = 4;
+
+  std::atomic<unsigned> state_;
+
+}; // struct RwSpinLock
+
+}  // namespace gdm
+
+#endif // AH_GDM_RW_SPIN_LOCK_H
@@ -35,12 +35,12 @@
 
 #define GDM_LOCK_GUARD(mx, name, color)\
   CPU_PROFILE_ENTER("Mutex", name, color);\
-  std::lock_guard<std::mutex> GDM_CONCAT(lock,__LINE__)(mx);\
+  std::lock_guard<decltype(mx)> GDM_CONCAT(lock,__LINE__)(mx);\
   CPU_PROFILE_LEAVE();
 
 #define GDM_LOCK_GUARD_VAR(mx, varname, name, color)\
   CPU_PROFILE_ENTER("Mutex", name, color);\
-  std::lock_guard<std::mutex> varname(mx);\
+  std::lock_guard<decltype(mx)> varname(mx);\
   CPU_PROFILE_LEAVE();
 
 #define GDM_COND_VAR(varmx, varcv, name, color, cond)\
@@ -6,34 +6,61 @@
 
 #include "semaphore.h"
 
+#include <algorithm>
+
+#include "futex.h"
+
+// --public
+
 gdm::Semaphore::Semaphore(int value)
   : value_{value}
-  , cv_{}
-  , mx_{}
+  , waiters_{0}
 {
   assert(value >= 0);
 }
 
-void gdm::Semaphore::Post()
+// Value is increased before waiters are checked and sleeper registers itself
+//  before checking the value, so either poster sees sleeper or sleeper sees
+//  the value (seq_cst on both sides)
+
+void gdm::Semaphore::Post(int count)
+{
+  assert(count > 0);
+  value_.fetch_add(count, std::memory_order_seq_cst);
+  const int waiters = waiters_.load(std::memory_order_seq_cst);
+  if (waiters > 0)
+    futex::Wake(value_, std::min(count, waiters));
+}
+
+void gdm::Semaphore::Wait()
 {
+  if (TryWait())
+    return;
+
+  waiters_.fetch_add(1, std::memory_order_seq_cst);
+  for (;;)
   {
-    std::unique_lock<std::mutex> lock(mx_);
-    assert(value_ >= 0);
-    ++value_;
+    int value = value_.load(std::memory_order_seq_cst);
+    if (value == 0)
+      futex::Wait(value_, 0);
+    else if (value_.compare_exchange_weak(value, value - 1, std::memory_order_acquire, std::memory_order_relaxed))
+      break;
   }
-  cv_.notify_all();
+  waiters_.fetch_sub(1, std::memory_order_relaxed);
 }
 
-void gdm::Semaphore::Wait()
+bool gdm::Semaphore::TryWait()
 {
-  std::unique_lock<std::mutex> lock(mx_);
-  assert(value_ >= 0);
-  if (value_ == 0)
-    cv_.wait(lock, [this](){ return value_ > 0; });
-  --value_;
+  int value = value_.load(std::memory_order_relaxed);
+  while (value > 0)
+  {
+    if (value_.compare_exchange_weak(value, value - 1, std::memory_order_acquire, std::memory_order_relaxed))
+      return true;
+  }
+  return false;
 }
 
 int gdm::Semaphore::Get() const
 {
-  return value_;
+  return value_.load(std::memory_order_relaxed);
 }
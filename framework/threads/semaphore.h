@@ -9,23 +9,25 @@
 
 #include <assert.h>
 #include <atomic>
-#include <mutex>
-#include <condition_variable>
 
 namespace gdm {
 
+// Counting semaphore over futex. Uncontended Post and Wait are one atomic
+//  operation each, kernel is entered only when somebody really sleeps and
+//  each posted unit wakes at most one sleeper
+
 struct Semaphore
 {
   explicit Semaphore(int value);
 
-  void Post();
+  void Post(int count = 1);
   void Wait();
+  bool TryWait();
   int Get() const;
 
 private:
-  std::atomic_int value_;
-  std::condition_variable cv_;
-  std::mutex mx_;
+  std::atomic<int> value_;
+  std::atomic<int> waiters_;
 
 }; // struct Semaphore
 
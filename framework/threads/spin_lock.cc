@@ -6,32 +6,33 @@
 
 #include "spin_lock.h"
 
-#ifdef _WIN32
-#include <intrin.h>
-#else
-#include <x86intrin.h>
-#endif
+#include <thread>
+
+#include "backoff.h"
 
 gdm::SpinLock::SpinLock()
-  : atomic_{}
-{
-  atomic_.clear();
-}
+  : locked_{false}
+{ }
 
 void gdm::SpinLock::Lock()
 {
-  while(!TryLock())
+  Backoff backoff;
+  while (!TryLock())
   {
-    _mm_pause();
+    while (locked_.load(std::memory_order_relaxed))
+    {
+      if (!backoff.Spin())
+        std::this_thread::yield();
+    }
   }
 }
 
 void gdm::SpinLock::Unlock()
 {
-  atomic_.clear(std::memory_order_release); 
+  locked_.store(false, std::memory_order_release);
 }
 
 bool gdm::SpinLock::TryLock()
 {
-  return !atomic_.test_and_set(std::memory_order_acquire);
+  return !locked_.exchange(true, std::memory_order_acquire);
 }
@@ -11,6 +11,9 @@
 
 namespace gdm {
 
+// Test and test-and-set lock, waiters read the flag with backoff and try to
+//  take it only when it looks free. Lower case names are for std lock wrappers
+
 struct SpinLock
 {
   SpinLock();
@@ -19,8 +22,12 @@ struct SpinLock
   bool TryLock();
   void Unlock();
 
+  void lock() { Lock(); }
+  bool try_lock() { return TryLock(); }
+  void unlock() { Unlock(); }
+
 private:
-  std::atomic_flag atomic_;
+  std::atomic<bool> locked_;
 
 }; // struct SpinLock
 
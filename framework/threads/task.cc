@@ -0,0 +1,91 @@
+// *************************************************************
+// File:    task.cc
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#include "task.h"
+
+//--private
+
+namespace gdm::_private {
+
+  static TaskContinuation s_ready_mark {};
+
+} // namespace gdm::_private
+
+gdm::_private::TaskStateBase::TaskStateBase(JobManager* mgr, int refs)
+  : mgr_{mgr}
+  , refs_{refs}
+  , continuations_{nullptr}
+{ }
+
+gdm::_private::TaskStateBase::~TaskStateBase()
+{ }
+
+bool gdm::_private::TaskStateBase::IsReady() const
+{
+  return continuations_.load(std::memory_order_acquire) == &s_ready_mark;
+}
+
+// Continuation added after completion is scheduled at once
+
+void gdm::_private::TaskStateBase::Subscribe(TaskContinuation* continuation)
+{
+  TaskContinuation* head = continuations_.load(std::memory_order_acquire);
+  do
+  {
+    if (head == &s_ready_mark)
+    {
+      Schedule(continuation);
+      return;
+    }
+    continuation->next_ = head;
+  }
+  while (!continuations_.compare_exchange_weak(head, continuation, std::memory_order_acq_rel, std::memory_order_acquire));
+}
+
+// Called once after result is stored. List is reversed to run continuations
+//  in order of subscription
+
+void gdm::_private::TaskStateBase::Complete()
+{
+  TaskContinuation* head = continuations_.exchange(&s_ready_mark, std::memory_order_acq_rel);
+  TaskContinuation* ordered = nullptr;
+  while (head)
+  {
+    TaskContinuation* next = head->next_;
+    head->next_ = ordered;
+    ordered = head;
+    head = next;
+  }
+  while (ordered)
+  {
+    TaskContinuation* next = ordered->next_;
+    Schedule(ordered);
+    ordered = next;
+  }
+}
+
+// Inline continuations are cheap bookkeeping of combinators, others are
+//  pushed to manager as usual jobs
+
+void gdm::_private::TaskStateBase::Schedule(TaskContinuation* continuation)
+{
+  if (continuation->inline_)
+    continuation->func_();
+  else
+    mgr_->Spawn(Job{std::move(continuation->func_), Job::SINGLE});
+  delete continuation;
+}
+
+void gdm::_private::TaskStateBase::AddRef()
+{
+  refs_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void gdm::_private::TaskStateBase::Release(TaskStateBase* state)
+{
+  if (state->refs_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    delete state;
+}
@@ -0,0 +1,126 @@
+// *************************************************************
+// File:    task.h
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#ifndef AH_GDM_TASK_H
+#define AH_GDM_TASK_H
+
+#include <atomic>
+#include <type_traits>
+
+#include "threads/job_manager.h"
+#include "threads/job_function.h"
+
+namespace gdm {
+
+namespace _private {
+
+  struct TaskContinuation
+  {
+    JobFunction<void()> func_;
+    TaskContinuation* next_;
+    bool inline_;
+
+  }; // struct TaskContinuation
+
+  // Shared state of task: refcount, result stored inline and lock-free list
+  //  of continuations which is replaced by ready mark when task is done
+
+  struct TaskStateBase
+  {
+    TaskStateBase(JobManager* mgr, int refs);
+    virtual ~TaskStateBase();
+
+    bool IsReady() const;
+    void Subscribe(TaskContinuation* continuation);
+    void Complete();
+    void Schedule(TaskContinuation* continuation);
+
+    void AddRef();
+    static void Release(TaskStateBase* state);
+
+    JobManager* mgr_;
+    std::atomic<int> refs_;
+    std::atomic<TaskContinuation*> continuations_;
+
+  }; // struct TaskStateBase
+
+  template <class T>
+  struct TaskState : TaskStateBase
+  {
+    using TaskStateBase::TaskStateBase;
+    ~TaskState() override;
+
+    template <class Fn, class... Args>
+    void Run(Fn& fn, Args&... args);
+    auto GetResult() -> T&;
+
+    alignas(T) unsigned char result_[sizeof(T)];
+
+  }; // struct TaskState
+
+  template <>
+  struct TaskState<void> : TaskStateBase
+  {
+    using TaskStateBase::TaskStateBase;
+
+    template <class Fn, class... Args>
+    void Run(Fn& fn, Args&... args);
+
+  }; // struct TaskState
+
+  template <class T, class Fn>
+  struct TaskThenResult { using type = std::invoke_result_t<Fn&, T&>; };
+  template <class Fn>
+  struct TaskThenResult<void, Fn> { using type = std::invoke_result_t<Fn&>; };
+
+} // namespace _private
+
+// Handle to result of function running on job manager. Result lives in the
+//  task state, not in std::promise, and copies share it. Continuations are
+//  pushed to the same manager as soon as task is done
+
+template <class T>
+struct Task
+{
+  Task() noexcept;
+  Task(const Task& other) noexcept;
+  Task(Task&& other) noexcept;
+  Task& operator=(const Task& other) noexcept;
+  Task& operator=(Task&& other) noexcept;
+  ~Task();
+
+  bool IsReady() const;
+  void Wait() const;
+  template <class U = T, class = std::enable_if_t<!std::is_void_v<U>>>
+  auto Get() const -> U&;
+  explicit operator bool() const noexcept { return state_ != nullptr; }
+
+  template <class Fn>
+  auto Then(Fn&& fn) const -> Task<typename _private::TaskThenResult<T, std::decay_t<Fn>>::type>;
+
+public:
+  explicit Task(_private::TaskState<T>* state) noexcept;
+  auto GetState() const -> _private::TaskState<T>* { return state_; }
+
+private:
+  _private::TaskState<T>* state_;
+
+}; // struct Task
+
+namespace mt {
+
+  // Runs fn() on job manager, result is taken through returned task
+
+  template <class Fn>
+  auto Async(JobManager& mgr, Fn&& fn) -> Task<std::invoke_result_t<std::decay_t<Fn>&>>;
+
+} // namespace mt
+
+} // namespace gdm
+
+#include "task.inl"
+
+#endif // AH_GDM_TASK_H
@@ -0,0 +1,164 @@
+// *************************************************************
+// File:    task.inl
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#include "task.h"
+
+#include <new>
+#include <thread>
+#include <utility>
+
+//--private
+
+template <class T>
+inline gdm::_private::TaskState<T>::~TaskState()
+{
+  if (IsReady())
+    GetResult().~T();
+}
+
+template <class T>
+template <class Fn, class... Args>
+inline void gdm::_private::TaskState<T>::Run(Fn& fn, Args&... args)
+{
+  new (result_) T(fn(args...));
+}
+
+template <class T>
+inline T& gdm::_private::TaskState<T>::GetResult()
+{
+  return *std::launder(reinterpret_cast<T*>(result_));
+}
+
+template <class Fn, class... Args>
+inline void gdm::_private::TaskState<void>::Run(Fn& fn, Args&... args)
+{
+  fn(args...);
+}
+
+//--public
+
+template <class T>
+inline gdm::Task<T>::Task() noexcept
+  : state_{nullptr}
+{ }
+
+template <class T>
+inline gdm::Task<T>::Task(_private::TaskState<T>* state) noexcept
+  : state_{state}
+{ }
+
+template <class T>
+inline gdm::Task<T>::Task(const Task& other) noexcept
+  : state_{other.state_}
+{
+  if (state_)
+    state_->AddRef();
+}
+
+template <class T>
+inline gdm::Task<T>::Task(Task&& other) noexcept
+  : state_{std::exchange(other.state_, nullptr)}
+{ }
+
+template <class T>
+inline gdm::Task<T>& gdm::Task<T>::operator=(const Task& other) noexcept
+{
+  if (state_ == other.state_)
+    return *this;
+
+  if (other.state_)
+    other.state_->AddRef();
+  if (state_)
+    _private::TaskStateBase::Release(state_);
+  state_ = other.state_;
+  return *this;
+}
+
+template <class T>
+inline gdm::Task<T>& gdm::Task<T>::operator=(Task&& other) noexcept
+{
+  if (this == &other)
+    return *this;
+
+  if (state_)
+    _private::TaskStateBase::Release(state_);
+  state_ = std::exchange(other.state_, nullptr);
+  return *this;
+}
+
+template <class T>
+inline gdm::Task<T>::~Task()
+{
+  if (state_)
+    _private::TaskStateBase::Release(state_);
+}
+
+template <class T>
+inline bool gdm::Task<T>::IsReady() const
+{
+  return !state_ || state_->IsReady();
+}
+
+// Helps manager with other jobs while waiting, so may be called from workers
+
+template <class T>
+inline void gdm::Task<T>::Wait() const
+{
+  while (!IsReady())
+  {
+    if (!state_->mgr_->HelpExecute())
+      std::this_thread::yield();
+  }
+}
+
+template <class T>
+template <class U, class>
+inline U& gdm::Task<T>::Get() const
+{
+  Wait();
+  return state_->GetResult();
+}
+
+// Continuation gets reference to the result, so it may move it out
+
+template <class T>
+template <class Fn>
+inline auto gdm::Task<T>::Then(Fn&& fn) const -> Task<typename _private::TaskThenResult<T, std::decay_t<Fn>>::type>
+{
+  using R = typename _private::TaskThenResult<T, std::decay_t<Fn>>::type;
+
+  auto* next = new _private::TaskState<R>(state_->mgr_, 2);
+  auto* prev = state_;
+  prev->AddRef();
+
+  auto call = [prev, next, fn = std::forward<Fn>(fn)]() mutable
+  {
+    if constexpr (std::is_void_v<T>)
+      next->Run(fn);
+    else
+      next->Run(fn, prev->GetResult());
+    next->Complete();
+    _private::TaskStateBase::Release(prev);
+    _private::TaskStateBase::Release(next);
+  };
+  prev->Subscribe(new _private::TaskContinuation{std::move(call), nullptr, false});
+  return Task<R>{next};
+}
+
+template <class Fn>
+inline auto gdm::mt::Async(JobManager& mgr, Fn&& fn) -> Task<std::invoke_result_t<std::decay_t<Fn>&>>
+{
+  using R = std::invoke_result_t<std::decay_t<Fn>&>;
+
+  auto* state = new _private::TaskState<R>(&mgr, 2);
+  mgr.Spawn(Job{[state, fn = std::forward<Fn>(fn)]() mutable
+  {
+    state->Run(fn);
+    state->Complete();
+    _private::TaskStateBase::Release(state);
+  }, Job::SINGLE});
+  return Task<R>{state};
+}
@@ -17,6 +17,7 @@
 
 #include <atomic>
 #include <cassert>
+#include <climits>
 
 //--private
 
@@ -107,9 +108,13 @@ bool gdm::Thread::SetAffinity(dword_t mask)
 #elif defined(__unix__)
   cpu_set_t cpuset;
   CPU_ZERO(&cpuset);
-  CPU_SET(mask, &cpuset);
+  for (uint_t cpu = 0; cpu < sizeof(mask) * CHAR_BIT; ++cpu)
+  {
+    if (mask & (dword_t{1} << cpu))
+      CPU_SET(cpu, &cpuset);
+  }
   pthread_t curr_thread = thread_.native_handle();
-  return pthread_setaffinity_np(curr_thread, sizeof(cpu_set_t), &cpuset); 
+  return pthread_setaffinity_np(curr_thread, sizeof(cpu_set_t), &cpuset) == 0;
 #endif
 }
 
@@ -139,7 +144,15 @@ gdm::Thread::dword_t gdm::Thread::GetAffinity() const
   cpu_set_t cpuset;
   CPU_ZERO(&cpuset);
   pthread_t curr_thread = thread_.native_handle();
-  return pthread_getaffinity_np(curr_thread, sizeof(cpu_set_t), &cpuset); 
+  if (pthread_getaffinity_np(curr_thread, sizeof(cpu_set_t), &cpuset) != 0)
+    return 0;
+  dword_t mask = 0;
+  for (uint_t cpu = 0; cpu < sizeof(mask) * CHAR_BIT; ++cpu)
+  {
+    if (CPU_ISSET(cpu, &cpuset))
+      mask |= dword_t{1} << cpu;
+  }
+  return mask;
 #endif
 }
 
@@ -149,9 +162,16 @@ bool gdm::Thread::SetProcessor(unsigned core)
   SYSTEM_INFO system_info;
   ::GetSystemInfo(&system_info);
   ::SetThreadIdealProcessor(thread_.native_handle(), core % system_info.dwNumberOfProcessors);
-#endif
-
   return true;
+#elif defined(__unix__)
+  // there is no ideal processor hint, so thread is pinned to the cpu
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  CPU_SET(core, &cpuset);
+  return pthread_setaffinity_np(thread_.native_handle(), sizeof(cpu_set_t), &cpuset) == 0;
+#else
+  return true;
+#endif
 }
 
 gdm::Thread::uint_t gdm::Thread::GetProcessor() const
@@ -160,6 +180,17 @@ gdm::Thread::uint_t gdm::Thread::GetProcessor() const
   PPROCESSOR_NUMBER processor = nullptr;
   ::GetThreadIdealProcessorEx(thread_.native_handle(), processor);
   return processor->Number;
+#elif defined(__unix__)
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  if (pthread_getaffinity_np(thread_.native_handle(), sizeof(cpu_set_t), &cpuset) != 0)
+    return 0;
+  for (uint_t cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+  {
+    if (CPU_ISSET(cpu, &cpuset))
+      return cpu;
+  }
+  return 0;
 #else
   return 0;
 #endif
@@ -187,7 +218,7 @@ gdm::core::Priority gdm::Thread::GetPriority() const
 #if defined(_WIN32) || defined(_WIN64) 
   return static_cast<core::Priority>(::GetThreadPriority(thread_.native_handle()));
 #else
-  return static_cast<Priority>(0);
+  return static_cast<core::Priority>(0);
 #endif
 }
 bool gdm::Thread::SetRunning(bool running)
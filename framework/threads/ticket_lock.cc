@@ -0,0 +1,40 @@
+// *************************************************************
+// File:    ticket_lock.cc
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#include "ticket_lock.h"
+
+#include <thread>
+
+#include "backoff.h"
+
+// --public
+
+gdm::TicketLock::TicketLock()
+  : next_{0}
+  , serving_{0}
+{ }
+
+void gdm::TicketLock::Lock()
+{
+  const unsigned ticket = next_.fetch_add(1, std::memory_order_relaxed);
+  Backoff backoff;
+  while (serving_.load(std::memory_order_acquire) != ticket)
+  {
+    if (!backoff.Spin())
+      std::this_thread::yield();
+  }
+}
+
+bool gdm::TicketLock::TryLock()
+{
+  unsigned serving = serving_.load(std::memory_order_acquire);
+  return next_.compare_exchange_strong(serving, serving + 1, std::memory_order_acquire, std::memory_order_relaxed);
+}
+
+void gdm::TicketLock::Unlock()
+{
+  serving_.store(serving_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
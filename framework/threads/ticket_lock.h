@@ -0,0 +1,37 @@
+// *************************************************************
+// File:    ticket_lock.h
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#ifndef AH_GDM_TICKET_LOCK_H
+#define AH_GDM_TICKET_LOCK_H
+
+#include <atomic>
+
+namespace gdm {
+
+// Fair spin lock, threads get the lock in order of arrival. Waiters only read
+//  the shared line, but all of them still see each unlock
+
+struct TicketLock
+{
+  TicketLock();
+
+  void Lock();
+  bool TryLock();
+  void Unlock();
+
+  void lock() { Lock(); }
+  bool try_lock() { return TryLock(); }
+  void unlock() { Unlock(); }
+
+private:
+  std::atomic<unsigned> next_;
+  std::atomic<unsigned> serving_;
+
+}; // struct TicketLock
+
+}  // namespace gdm
+
+#endif // AH_GDM_TICKET_LOCK_H
@@ -0,0 +1,183 @@
+// *************************************************************
+// File:    io_service_test.cc
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+// Usage: io_service_test [files] [file_kb] [dir]
+
+#include <vector>
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "threads/job_manager.h"
+#include "threads/io_service.h"
+
+struct TestSettings
+{
+  int files = 32;
+  int file_kb = 2560;
+  std::string dir = "/tmp";
+} g_test_settings;
+
+static auto GetPath(int i) -> std::string
+{
+  return g_test_settings.dir + "/gdm_io_test_" + std::to_string(i) + ".bin";
+}
+
+static auto GetByte(int file, std::size_t pos) -> unsigned char
+{
+  return static_cast<unsigned char>((pos * 31 + file * 7 + pos / 4096) & 0xff);
+}
+
+// Sizes are various to have empty, small, not aligned and multi chunk files
+
+static auto GetSize(int file) -> std::size_t
+{
+  switch (file % 4)
+  {
+    case 0  : return 0;
+    case 1  : return 1000 + file;
+    case 2  : return g_test_settings.file_kb * 1024ull + 123;
+    default : return gdm::IoService::v_chunk_size * 2;
+  }
+}
+
+static void WriteFiles()
+{
+  for (int i = 0; i < g_test_settings.files; ++i)
+  {
+    std::vector<unsigned char> data (GetSize(i));
+    for (std::size_t k = 0; k < data.size(); ++k)
+      data[k] = GetByte(i, k);
+    std::ofstream file (GetPath(i), std::ios::binary);
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+  }
+}
+
+static void RemoveFiles()
+{
+  for (int i = 0; i < g_test_settings.files; ++i)
+    remove(GetPath(i).c_str());
+}
+
+static bool CheckData(int file, const std::vector<unsigned char>& data)
+{
+  if (data.size() != GetSize(file))
+    return false;
+  for (std::size_t k = 0; k < data.size(); ++k)
+    if (data[k] != GetByte(file, k))
+      return false;
+  return true;
+}
+
+// All files and one missing are read in one call, continuations should be
+//  finished before the counter is done
+
+static int case_read(gdm::JobManager& mgr, bool allow_uring)
+{
+  gdm::IoService service (mgr, 64, 4, allow_uring);
+  const char* name = service.IsUring() ? "io_uring" : "threads";
+
+  std::vector<gdm::IoRequest> requests (g_test_settings.files + 1);
+  std::atomic<int> continuations {0};
+  for (int i = 0; i <= g_test_settings.files; ++i)
+  {
+    requests[i].path_ = i < g_test_settings.files ? GetPath(i) : g_test_settings.dir + "/gdm_io_test_missing.bin";
+    requests[i].on_done_ = [&continuations](){ continuations.fetch_add(1, std::memory_order_relaxed); };
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  gdm::JobCounter counter = service.Read(requests.data(), requests.size());
+  mgr.WaitOnCounter(counter);
+  double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  int errors = 0;
+  for (int i = 0; i < g_test_settings.files; ++i)
+    errors += requests[i].error_ != 0 || !CheckData(i, requests[i].data_);
+  errors += requests.back().error_ != ENOENT || !requests.back().data_.empty();
+  errors += continuations.load() != static_cast<int>(requests.size());
+
+  printf("%-9s read %d files: %.3f ms, continuations %d, errors %d\n", name, g_test_settings.files, ms, continuations.load(), errors);
+  assert(!errors);
+  return errors;
+}
+
+// Requests are pushed from several jobs at once while service is busy
+
+static int case_concurrent(gdm::JobManager& mgr, bool allow_uring)
+{
+  gdm::IoService service (mgr, 8, 2, allow_uring);
+  const char* name = service.IsUring() ? "io_uring" : "threads";
+
+  std::vector<gdm::IoRequest> requests (g_test_settings.files);
+  for (int i = 0; i < g_test_settings.files; ++i)
+    requests[i].path_ = GetPath(i);
+
+  gdm::JobCounter reads = gdm::JobCounter::Create();
+  gdm::JobCounter pushes;
+  mgr.GetJobQueue().PushBatchTS([&](int from, int count){
+    service.Read(&requests[from], count, reads); }, 1, requests.size(), pushes);
+  mgr.WaitOnCounter(pushes);
+  mgr.WaitOnCounter(reads);
+
+  int errors = 0;
+  for (int i = 0; i < g_test_settings.files; ++i)
+    errors += requests[i].error_ != 0 || !CheckData(i, requests[i].data_);
+
+  printf("%-9s concurrent reads: errors %d\n", name, errors);
+  assert(!errors);
+  return errors;
+}
+
+// Baseline: the same files read one by one
+
+static int case_sync()
+{
+  auto start = std::chrono::steady_clock::now();
+  int errors = 0;
+  for (int i = 0; i < g_test_settings.files; ++i)
+  {
+    std::ifstream file (GetPath(i), std::ios::binary | std::ios::ate);
+    std::vector<unsigned char> data (static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(data.data()), data.size());
+    errors += !CheckData(i, data);
+  }
+  double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  printf("%-9s read %d files: %.3f ms, errors %d\n", "ifstream", g_test_settings.files, ms, errors);
+  assert(!errors);
+  return errors;
+}
+
+int main(int argc, const char** argv)
+{
+  g_test_settings.files = argc > 1 ? atoi(argv[1]) : g_test_settings.files;
+  g_test_settings.file_kb = argc > 2 ? atoi(argv[2]) : g_test_settings.file_kb;
+  g_test_settings.dir = argc > 3 ? argv[3] : g_test_settings.dir;
+
+  WriteFiles();
+
+  int errors = 0;
+  {
+    gdm::JobManager mgr {};
+    errors += case_sync();
+    errors += case_read(mgr, true);
+    errors += case_read(mgr, false);
+    errors += case_concurrent(mgr, true);
+    errors += case_concurrent(mgr, false);
+  }
+
+  RemoveFiles();
+
+  printf(errors ? "FAILED\n" : "COMPLETED\n");
+  return errors ? -1 : 0;
+}
@@ -0,0 +1,368 @@
+// *************************************************************
+// File:    job_bench.cc
+// Author:  Novoselov Anton @ 2018
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+// Usage: job_bench [max_workers] [repeats]
+
+#include <vector>
+#include <queue>
+#include <functional>
+#include <ctime>
+#include <random>
+
+#include "threads/job_manager.h"
+#include "threads/job_function.h"
+#include "threads/parallel_for.h"
+#include "threads/parallel_algorithms.h"
+
+#include "job_scenarios.h"
+
+struct JobBenchSettings : BenchSettings
+{
+  JobBenchSettings() { repeats = 32; }
+
+  int single_jobs = 4096;
+  int array_size = 1 << 20;
+  int batch_size = 256;
+} g_bench_settings;
+
+// Many tiny jobs, measures pure scheduling overhead
+
+static double bench_single_jobs(gdm::JobManager& mgr)
+{
+  double elapsed_us = 0.0;
+  for (int i = 0; i < g_bench_settings.repeats; ++i)
+    elapsed_us += RunSingleJobs(mgr, g_bench_settings.single_jobs);
+  return g_bench_settings.single_jobs * g_bench_settings.repeats / elapsed_us * 1e6;
+}
+
+// Batches with small per-item work, measures how batch is spreaded over workers
+
+static double bench_batch_jobs(gdm::JobManager& mgr, std::vector<float>& array)
+{
+  auto func = [&array](int begin, int length)
+  {
+    for (int i = begin; i < begin + length; ++i)
+      array[i] = std::sqrt(array[i] + static_cast<float>(i));
+  };
+
+  double elapsed_us = 0.0;
+  for (int i = 0; i < g_bench_settings.repeats; ++i)
+    elapsed_us += RunBatch(mgr, func, g_bench_settings.batch_size, array.size());
+
+  int jobs_per_batch = (g_bench_settings.array_size + g_bench_settings.batch_size - 1) / g_bench_settings.batch_size;
+  return jobs_per_batch * g_bench_settings.repeats / elapsed_us * 1e6;
+}
+
+// Same work as batch above, but grain is picked by ParallelFor itself
+
+static double bench_parallel_for(gdm::JobManager& mgr, std::vector<float>& array)
+{
+  auto func = [&array](int i){ array[i] = std::sqrt(array[i] + static_cast<float>(i)); };
+
+  double start = TIME_NOW_MS();
+  for (int i = 0; i < g_bench_settings.repeats; ++i)
+    gdm::mt::ParallelFor(mgr, {0, static_cast<int>(array.size())}, func);
+  double elapsed = TIME_NOW_MS() - start;
+
+  return static_cast<double>(array.size()) * g_bench_settings.repeats / elapsed * 1000.0;
+}
+
+// Cost of callable itself: construct with typical capture, put into queue,
+//  pop and invoke. std::function here is what Job used to store
+
+template <class Callable>
+static double bench_callable()
+{
+  struct Capture { void* ptrs[4]; } capture {};
+  std::atomic<int> counter {0};
+  std::queue<Callable> queue;
+
+  const int count = g_bench_settings.single_jobs * g_bench_settings.repeats;
+  double start = TIME_NOW_MS();
+  for (int i = 0; i < count; ++i)
+  {
+    queue.push(Callable{[capture, &counter](){ counter.fetch_add(capture.ptrs[0] ? 2 : 1, std::memory_order_relaxed); }});
+    queue.front()();
+    queue.pop();
+  }
+  double elapsed = TIME_NOW_MS() - start;
+
+  if (counter != count)
+    printf("\tcallable: lost calls %d\n", counter.load());
+  return count / elapsed * 1000.0;
+}
+
+static void run_callables()
+{
+  printf("%-16s %-16s\n", "callable", "calls/s");
+  printf("%-16s %-16.0f\n", "std::function", bench_callable<std::function<void()>>());
+  printf("%-16s %-16.0f\n", "gdm::JobFunction", bench_callable<gdm::JobFunction<void()>>());
+}
+
+static const char* PLACEMENT_NAME(gdm::core::Placement placement)
+{
+  switch (placement)
+  {
+    case gdm::core::PLACE_PHYSICAL_CORES : return "cores";
+    case gdm::core::PLACE_L3_DOMAIN : return "l3";
+    case gdm::core::PLACE_SEQUENTIAL : return "sequential";
+    default : return "any";
+  }
+}
+
+static void run_placements()
+{
+  gdm::CpuTopology topology = gdm::CpuTopology::Probe();
+  printf("cpus %u, cores %u, numa nodes %u\n", topology.GetCpusCount(), topology.GetCoresCount(), topology.GetNodesCount());
+
+  std::vector<float> array(g_bench_settings.array_size, 1.f);
+  const gdm::core::Placement placements[] = {
+    gdm::core::PLACE_PHYSICAL_CORES, gdm::core::PLACE_L3_DOMAIN, gdm::core::PLACE_SEQUENTIAL, gdm::core::PLACE_ANY };
+
+  printf("%-12s %-8s %-16s %-16s %-16s\n", "placement", "workers", "single jobs/s", "batch jobs/s", "pfor items/s");
+  for (gdm::core::Placement placement : placements)
+  {
+    gdm::JobManager mgr {gdm::core::WORK_STEALING | placement, g_bench_settings.max_workers};
+    double single = bench_single_jobs(mgr);
+    double batch = bench_batch_jobs(mgr, array);
+    double pfor = bench_parallel_for(mgr, array);
+    printf("%-12s %-8u %-16.0f %-16.0f %-16.0f\n", PLACEMENT_NAME(placement), g_bench_settings.max_workers, single, batch, pfor);
+  }
+}
+
+static const char* IDLE_NAME(gdm::core::JobManagerProps flags)
+{
+  if (flags & gdm::core::IDLE_PARK)
+    return "park";
+  return (flags & gdm::core::IDLE_SPIN) ? "spin" : "spin-park";
+}
+
+// Time from pushing a job into idle pool until some worker starts it, median
+
+static double bench_wake_latency(gdm::JobManager& mgr)
+{
+  const int rounds = 64;
+  std::vector<double> latencies;
+  std::atomic<double> started {0.0};
+
+  for (int i = 0; i < rounds; ++i)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    started = 0.0;
+    double pushed = TIME_NOW_MS();
+    mgr.GetJobQueue().PushJobTS([&started](){ started = TIME_NOW_MS(); });
+    while (started.load() == 0.0)
+      std::this_thread::yield();
+    latencies.push_back((started.load() - pushed) * 1000.0);
+  }
+  return Summarize(std::move(latencies)).median_;
+}
+
+// Cpu time burned by the whole process while pool has nothing to do, percents of one core
+
+static double bench_idle_burn(gdm::JobManager& mgr)
+{
+  mgr.WaitOnBarrierTS();
+  std::clock_t cpu_start = std::clock();
+  double start = TIME_NOW_MS();
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  double elapsed = TIME_NOW_MS() - start;
+  double cpu = 1000.0 * (std::clock() - cpu_start) / CLOCKS_PER_SEC;
+  return cpu / elapsed * 100.0;
+}
+
+static void run_idle_policies()
+{
+  const gdm::core::JobManagerProps policies[] = { 0, gdm::core::IDLE_PARK, gdm::core::IDLE_SPIN };
+
+  printf("%-10s %-8s %-16s %-16s %-16s\n", "idle", "workers", "wake median us", "idle cpu %", "single jobs/s");
+  for (gdm::core::JobManagerProps policy : policies)
+  {
+    gdm::JobManager mgr {gdm::core::WORK_STEALING | policy, g_bench_settings.max_workers};
+    double latency = bench_wake_latency(mgr);
+    double burn = bench_idle_burn(mgr);
+    double single = bench_single_jobs(mgr);
+    printf("%-10s %-8u %-16.1f %-16.1f %-16.0f\n", IDLE_NAME(policy), g_bench_settings.max_workers, latency, burn, single);
+  }
+}
+
+// Time to finish small frame batch while loaders keep the pool busy with
+//  long background jobs, pushed into the same lane and into its own lane
+
+static double bench_lane_latency(gdm::JobManager& mgr, gdm::Job::EPriority frame_lane, gdm::Job::EPriority loader_lane)
+{
+  gdm::JobQueue& queue = mgr.GetJobQueue();
+  std::vector<double> latencies;
+  for (int i = 0; i < g_bench_settings.repeats; ++i)
+  {
+    gdm::JobCounter loaders;
+    queue.PushBatchTS([&mgr](int, int){
+      for (double until = TIME_NOW_MS() + 0.2; TIME_NOW_MS() < until; ) { mgr.YieldToCritical(); } }, 1, 256, loaders, loader_lane);
+    double start = TIME_NOW_MS();
+    gdm::JobCounter frame;
+    queue.PushBatchTS([](int, int){ }, 1, 64, frame, frame_lane);
+    while (!frame.IsDone())
+      std::this_thread::yield();
+    latencies.push_back(TIME_NOW_MS() - start);
+    mgr.WaitOnCounter(loaders);
+  }
+  return Summarize(std::move(latencies)).median_;
+}
+
+static void run_priority_lanes()
+{
+  printf("%-10s %-8s %-20s %-20s\n", "lanes", "workers", "frame ms shared", "frame ms lanes");
+  for (gdm::core::JobManagerProps flags : { 0u, unsigned(gdm::core::WORK_STEALING) })
+  {
+    gdm::JobManager mgr {flags, g_bench_settings.max_workers};
+    double shared = bench_lane_latency(mgr, gdm::Job::NORMAL, gdm::Job::NORMAL);
+    double lanes = bench_lane_latency(mgr, gdm::Job::CRITICAL, gdm::Job::BACKGROUND);
+    printf("%-10s %-8u %-20.3f %-20.3f\n", MODE_NAME(flags), g_bench_settings.max_workers, shared, lanes);
+  }
+}
+
+// Per worker counters after mixed load, shows imbalance between workers
+
+static void run_telemetry(gdm::core::JobManagerProps flags)
+{
+  std::vector<float> array(g_bench_settings.array_size, 1.f);
+  gdm::JobManager mgr {flags, g_bench_settings.max_workers};
+  bench_single_jobs(mgr);
+  bench_batch_jobs(mgr, array);
+  bench_parallel_for(mgr, array);
+  printf("telemetry, %s\n", MODE_NAME(flags));
+  mgr.GetTelemetry().Print(stdout, "Worker");
+}
+
+// Best of iterations for serial std version and parallel one, each run
+//  starts from the same input and results are compared
+
+template <class T, class Serial, class Parallel>
+static void bench_algorithm(const char* name, const std::vector<T>& input, Serial&& serial, Parallel&& parallel)
+{
+  std::vector<T> serial_data;
+  std::vector<T> parallel_data;
+  double serial_ms = 1e9;
+  double parallel_ms = 1e9;
+  for (int i = 0; i < std::max(1, g_bench_settings.repeats / 4); ++i)
+  {
+    serial_data = input;
+    double start = TIME_NOW_MS();
+    serial(serial_data);
+    serial_ms = std::min(serial_ms, TIME_NOW_MS() - start);
+
+    parallel_data = input;
+    start = TIME_NOW_MS();
+    parallel(parallel_data);
+    parallel_ms = std::min(parallel_ms, TIME_NOW_MS() - start);
+  }
+  const char* result = serial_data == parallel_data ? "ok" : "MISMATCH";
+  printf("%-16s %-12.3f %-12.3f %-10.2f %-10s\n", name, serial_ms, parallel_ms, serial_ms / parallel_ms, result);
+}
+
+struct DrawItem
+{
+  uint64_t key;
+  int index;
+  bool operator==(const DrawItem& other) const { return key == other.key && index == other.index; }
+};
+
+static void run_algorithms()
+{
+  gdm::JobManager mgr {gdm::core::WORK_STEALING, g_bench_settings.max_workers};
+  std::mt19937 random {42};
+  const int size = g_bench_settings.array_size * 4;
+
+  std::vector<float> floats(size);
+  std::vector<uint32_t> ints(size);
+  std::vector<DrawItem> items(size);
+  for (int i = 0; i < size; ++i)
+  {
+    floats[i] = std::uniform_real_distribution<float>(-1000.f, 1000.f)(random);
+    ints[i] = random();
+    items[i] = DrawItem{(uint64_t(random()) << 32) | random(), i};
+  }
+  auto by_key = [](const DrawItem& a, const DrawItem& b){ return a.key < b.key; };
+  auto is_positive = [](float v){ return v > 0.f; };
+  auto work = [](float v){ return std::sqrt(std::abs(v)) * 0.5f + 1.f; };
+
+  printf("algorithms, %d items, %u workers\n", size, g_bench_settings.max_workers);
+  printf("%-16s %-12s %-12s %-10s %-10s\n", "algorithm", "std ms", "mt ms", "speedup", "result");
+
+  bench_algorithm("transform", floats,
+    [&](std::vector<float>& v){ std::transform(v.begin(), v.end(), v.begin(), work); },
+    [&](std::vector<float>& v){ gdm::mt::Transform(mgr, v.begin(), v.end(), v.begin(), work); });
+  bench_algorithm("reduce", ints,
+    [&](std::vector<uint32_t>& v){ v.assign(1, std::accumulate(v.begin(), v.end(), 0u)); },
+    [&](std::vector<uint32_t>& v){ v.assign(1, gdm::mt::Reduce(mgr, v.begin(), v.end(), 0u)); });
+  bench_algorithm("inclusive scan", ints,
+    [&](std::vector<uint32_t>& v){ std::inclusive_scan(v.begin(), v.end(), v.begin()); },
+    [&](std::vector<uint32_t>& v){ gdm::mt::InclusiveScan(mgr, v.begin(), v.end(), v.begin()); });
+  bench_algorithm("exclusive scan", ints,
+    [&](std::vector<uint32_t>& v){ std::exclusive_scan(v.begin(), v.end(), v.begin(), 7u); },
+    [&](std::vector<uint32_t>& v){ gdm::mt::ExclusiveScan(mgr, v.begin(), v.end(), v.begin(), 7u); });
+  bench_algorithm("sort int", ints,
+    [&](std::vector<uint32_t>& v){ std::sort(v.begin(), v.end()); },
+    [&](std::vector<uint32_t>& v){ gdm::mt::Sort(mgr, v.begin(), v.end()); });
+  bench_algorithm("sort float", floats,
+    [&](std::vector<float>& v){ std::sort(v.begin(), v.end()); },
+    [&](std::vector<float>& v){ gdm::mt::Sort(mgr, v.begin(), v.end()); });
+  bench_algorithm("sort by key", items,
+    [&](std::vector<DrawItem>& v){ std::stable_sort(v.begin(), v.end(), by_key); },
+    [&](std::vector<DrawItem>& v){ gdm::mt::SortByKey(mgr, v.begin(), v.end(), [](const DrawItem& item){ return item.key; }); });
+  bench_algorithm("sort merge", items,
+    [&](std::vector<DrawItem>& v){ std::stable_sort(v.begin(), v.end(), by_key); },
+    [&](std::vector<DrawItem>& v){ gdm::mt::Sort(mgr, v.begin(), v.end(), by_key); });
+  bench_algorithm("partition", floats,
+    [&](std::vector<float>& v){ std::stable_partition(v.begin(), v.end(), is_positive); },
+    [&](std::vector<float>& v){ gdm::mt::Partition(mgr, v.begin(), v.end(), is_positive); });
+
+  auto bucket = [](uint32_t v){ return static_cast<int>(v >> 24); };
+  bench_algorithm("histogram", ints,
+    [&](std::vector<uint32_t>& v)
+    {
+      std::vector<uint32_t> counts(256, 0);
+      for (uint32_t value : v)
+        ++counts[bucket(value)];
+      v = counts;
+    },
+    [&](std::vector<uint32_t>& v)
+    {
+      std::vector<std::size_t> counts = gdm::mt::Histogram(mgr, v.begin(), v.end(), 256, bucket);
+      v.assign(counts.begin(), counts.end());
+    });
+}
+
+static void run_scaling(gdm::core::JobManagerProps flags)
+{
+  std::vector<float> array(g_bench_settings.array_size, 1.f);
+
+  printf("%-10s %-8s %-16s %-16s %-16s\n", "mode", "workers", "single jobs/s", "batch jobs/s", "pfor items/s");
+  for (unsigned workers = 1; workers <= g_bench_settings.max_workers; workers *= 2)
+  {
+    gdm::JobManager mgr {flags, workers};
+    double single = bench_single_jobs(mgr);
+    double batch = bench_batch_jobs(mgr, array);
+    double pfor = bench_parallel_for(mgr, array);
+    printf("%-10s %-8u %-16.0f %-16.0f %-16.0f\n", MODE_NAME(flags), workers, single, batch, pfor);
+  }
+}
+
+int main(int argc, const char** argv)
+{
+  g_bench_settings.Parse(argc, argv);
+
+  run_callables();
+  run_scaling(0);
+  run_scaling(gdm::core::WORK_STEALING);
+  run_placements();
+  run_idle_policies();
+  run_priority_lanes();
+  run_telemetry(gdm::core::WORK_STEALING);
+  run_algorithms();
+
+  return 0;
+}
@@ -0,0 +1,134 @@
+// *************************************************************
+// File:    job_scenarios.h
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+// Helpers and scenarios shared by job_bench and job_suite. Scenarios return
+//  elapsed time of one run in microseconds, callers turn it into own units
+
+#ifndef AH_GDM_JOB_SCENARIOS_H
+#define AH_GDM_JOB_SCENARIOS_H
+
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <cmath>
+#include <algorithm>
+#include <numeric>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "threads/job_manager.h"
+
+// Command line shared by benchmarks: [max_workers] [repeats] ...
+
+struct BenchSettings
+{
+  unsigned max_workers = std::max(1u, std::thread::hardware_concurrency() - 1);
+  int repeats = 1;
+
+  void Parse(int argc, const char** argv)
+  {
+    max_workers = argc > 1 ? std::max(1, atoi(argv[1])) : max_workers;
+    repeats = argc > 2 ? std::max(1, atoi(argv[2])) : repeats;
+  }
+
+}; // struct BenchSettings
+
+struct Stats
+{
+  int samples_;
+  double min_;
+  double median_;
+  double mean_;
+  double stddev_;
+  double p90_;
+  double max_;
+
+}; // struct Stats
+
+inline double TIME_NOW_US()
+{
+  return std::chrono::duration<double, std::micro>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline double TIME_NOW_MS()
+{
+  return TIME_NOW_US() / 1000.0;
+}
+
+inline const char* MODE_NAME(gdm::core::JobManagerProps flags)
+{
+  return (flags & gdm::core::WORK_STEALING) ? "stealing" : "locked";
+}
+
+inline Stats Summarize(std::vector<double> samples)
+{
+  Stats stats {};
+  stats.samples_ = static_cast<int>(samples.size());
+  if (samples.empty())
+    return stats;
+
+  std::sort(samples.begin(), samples.end());
+  const std::size_t count = samples.size();
+  stats.min_ = samples.front();
+  stats.max_ = samples.back();
+  stats.median_ = count % 2 ? samples[count / 2] : (samples[count / 2 - 1] + samples[count / 2]) / 2.0;
+  stats.p90_ = samples[std::min(count - 1, static_cast<std::size_t>(std::ceil(count * 0.9)) - 1)];
+  stats.mean_ = std::accumulate(samples.begin(), samples.end(), 0.0) / count;
+  double variance = 0.0;
+  for (double sample : samples)
+    variance += (sample - stats.mean_) * (sample - stats.mean_);
+  stats.stddev_ = count > 1 ? std::sqrt(variance / (count - 1)) : 0.0;
+  return stats;
+}
+
+// Tiny jobs pushed under one lock with one counter and waited on it, pure
+//  scheduling cost. Lost jobs are reported to stderr to keep stdout clean
+
+inline double RunSingleJobs(gdm::JobManager& mgr, int count)
+{
+  std::atomic<int> executed {0};
+  gdm::JobQueue& queue = mgr.GetJobQueue();
+  gdm::JobCounter jobs;
+  const double start = TIME_NOW_US();
+  {
+    std::unique_lock<std::timed_mutex> lock(queue.GetMutex());
+    for (int k = 0; k < count; ++k)
+      queue.PushJob([&executed](){ executed.fetch_add(1, std::memory_order_relaxed); }, jobs);
+  }
+  mgr.WaitOnCounter(jobs);
+  const double elapsed = TIME_NOW_US() - start;
+
+  if (executed.load() != count)
+    fprintf(stderr, "single jobs: lost %d of %d\n", count - executed.load(), count);
+  return elapsed;
+}
+
+template <class Fn>
+inline double RunBatch(gdm::JobManager& mgr, Fn&& func, int batch_size, std::size_t size)
+{
+  gdm::JobCounter jobs;
+  const double start = TIME_NOW_US();
+  mgr.GetJobQueue().PushBatchTS(std::forward<Fn>(func), batch_size, size, jobs);
+  mgr.WaitOnCounter(jobs);
+  return TIME_NOW_US() - start;
+}
+
+// One job through idle pool: push and wait on counter
+
+inline double RunRoundTrip(gdm::JobManager& mgr)
+{
+  gdm::JobCounter job;
+  const double start = TIME_NOW_US();
+  mgr.GetJobQueue().PushJobTS([](){ }, job);
+  mgr.WaitOnCounter(job);
+  return TIME_NOW_US() - start;
+}
+
+#endif // AH_GDM_JOB_SCENARIOS_H
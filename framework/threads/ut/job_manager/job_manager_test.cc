@@ -7,14 +7,21 @@
 #include <vector>
 #include <numeric>
 #include <algorithm>
+#include <mutex>
+#include <string>
 
 #include <assert.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <string.h>
 
 #include "system/logger.h"
 #include "system/profiler.h"
 #include "threads/job_manager.h"
+#include "threads/parallel_for.h"
+#include "threads/mt_utils.h"
+#include "threads/parallel_algorithms.h"
+#include "threads/job_coroutine.h"
 
 static gdm::JobManager* g_mgr;
 static std::vector<int> g_cases_array; // array for tests
@@ -235,6 +242,516 @@ int case_4_simulate_post_from_diff_sources()
   return total_summ;
 }
 
+int case_5_job_graph()
+{
+  LOG(FUNC, "case_5_job_graph()\n");
+
+  static gdm::JobGraph graph;
+
+  if (graph.GetNodesCount() == 0)
+  {
+    auto fill = graph.AddBatch([](int begin, int length){
+      for (int i = begin; i < begin + length; ++i) g_cases_array[i] = 1; SLEEP_MS(WORKERS, 100); },
+      g_test_settings.batch_size, g_cases_array.size());
+    auto set = graph.AddBatch([](int begin, int length){
+      for (int i = begin; i < begin + length; ++i) g_cases_array[i] += 1; SLEEP_MS(WORKERS, 100); },
+      g_test_settings.batch_size, g_cases_array.size());
+    auto test = graph.AddJob([](){
+      int sum = DATA_SUM(g_cases_array); LOG(TEST, "some_test_fn(): %d\n", sum); assert(sum == g_test_settings.array_size * 2); });
+    auto mov = graph.AddBatch([](int begin, int length){
+      for (int i = begin; i < begin + length; i += 2) g_cases_array[i] += 1; SLEEP_MS(WORKERS, 100); },
+      g_test_settings.batch_size, g_cases_array.size());
+    auto rot = graph.AddBatch([](int begin, int length){
+      for (int i = begin + 1; i < begin + length; i += 2) g_cases_array[i] += 1; SLEEP_MS(WORKERS, 100); },
+      g_test_settings.batch_size, g_cases_array.size());
+    
+    graph.AddEdge(fill, set);
+    graph.AddEdge(set, test);
+    graph.AddEdge(test, mov);
+    graph.AddEdge(test, rot);
+  }
+
+  {
+    CPU_PROFILE_SCOPE("ThreadMain", "ex_5", gdm::core::COLOR_AUTO);
+    g_mgr->SubmitGraph(graph);
+    g_mgr->WaitOnGraph(graph);
+  }
+
+  int total_summ = DATA_SUM(g_cases_array);
+  LOG(FUNC, "graph data after:  %d\n\n", total_summ);
+  assert(total_summ == g_test_settings.array_size * 3);
+
+  return total_summ;
+}
+
+int case_6_parallel_for()
+{
+  LOG(FUNC, "case_6_parallel_for()\n");
+
+  {
+    CPU_PROFILE_SCOPE("ThreadMain", "ex_6", gdm::core::COLOR_AUTO);
+    int size = static_cast<int>(g_cases_array.size());
+    gdm::mt::ParallelFor(*g_mgr, {0, size}, [](int i){ g_cases_array[i] = 1; });
+    gdm::mt::ParallelFor(*g_mgr, {0, size}, [](int begin, int length){
+      for (int i = begin; i < begin + length; ++i) g_cases_array[i] += 1; });
+  }
+
+  int total_summ = DATA_SUM(g_cases_array);
+  LOG(FUNC, "parallel for data after:  %d\n\n", total_summ);
+  assert(total_summ == g_test_settings.array_size * 2);
+
+  return total_summ;
+}
+
+int case_7_job_counters()
+{
+  LOG(FUNC, "case_7_job_counters()\n");
+
+  DATA_FILL(g_cases_array, 1);
+  const int half = static_cast<int>(g_cases_array.size()) / 2;
+
+  {
+    CPU_PROFILE_SCOPE("ThreadMain", "ex_7", gdm::core::COLOR_AUTO);
+    gdm::JobQueue& queue = g_mgr->GetJobQueue();
+    gdm::JobCounter first;
+    queue.PushBatchTS([](int begin, int length){
+      for (int i = begin; i < begin + length; ++i) g_cases_array[i] += 1; },
+      g_test_settings.batch_size, half, first);
+    gdm::JobCounter second;
+    queue.PushBatchTS([half](int begin, int length){
+      for (int i = begin; i < begin + length; ++i) g_cases_array[half + i] += 1; },
+      g_test_settings.batch_size, g_cases_array.size() - half, second);
+    queue.PushJobTS([](){ LOG(TEST, "second counter job\n"); }, second);
+    g_mgr->WaitOnCounter(first);
+    int sum = std::accumulate(g_cases_array.begin(), g_cases_array.begin() + half, 0);
+    LOG(TEST, "first counter: %d\n", sum);
+    assert(sum == half * 2);
+    g_mgr->WaitOnCounter(second);
+    assert(first.IsDone() && second.IsDone());
+  }
+
+  int total_summ = DATA_SUM(g_cases_array);
+  LOG(FUNC, "counters data after:  %d\n\n", total_summ);
+  assert(total_summ == g_test_settings.array_size * 2);
+
+  return total_summ;
+}
+
+int case_8_separate_pools()
+{
+  LOG(FUNC, "case_8_separate_pools()\n");
+
+  static gdm::JobManager io_pool {0, 1, gdm::core::BELOW_NORMAL, "Io"};
+  static std::vector<int> io_array;
+
+  DATA_FILL(g_cases_array, 1);
+  io_array.assign(g_cases_array.size(), 0);
+
+  {
+    CPU_PROFILE_SCOPE("ThreadMain", "ex_8", gdm::core::COLOR_AUTO);
+    gdm::JobCounter io_jobs;
+    io_pool.GetJobQueue().PushBatchTS([](int begin, int length){
+      for (int i = begin; i < begin + length; ++i) io_array[i] = 1; SLEEP_MS(WORKERS, 100); },
+      g_test_settings.batch_size, io_array.size(), io_jobs);
+    gdm::JobCounter jobs;
+    g_mgr->GetJobQueue().PushBatchTS([](int begin, int length){
+      for (int i = begin; i < begin + length; ++i) g_cases_array[i] += 1; },
+      g_test_settings.batch_size, g_cases_array.size(), jobs);
+    g_mgr->WaitOnCounter(jobs);
+    io_pool.WaitOnCounter(io_jobs);
+    assert(DATA_SUM(io_array) == g_test_settings.array_size);
+  }
+
+  int total_summ = DATA_SUM(g_cases_array);
+  LOG(FUNC, "pools data after:  %d\n\n", total_summ);
+  assert(total_summ == g_test_settings.array_size * 2);
+
+  return total_summ;
+}
+
+int case_9_tasks()
+{
+  LOG(FUNC, "case_9_tasks()\n");
+
+  DATA_FILL(g_cases_array, 1);
+  const int size = static_cast<int>(g_cases_array.size());
+  const int half = size / 2;
+
+  {
+    CPU_PROFILE_SCOPE("ThreadMain", "ex_9", gdm::core::COLOR_AUTO);
+    gdm::Task<int> first = gdm::mt::Async(*g_mgr, [half](){ return half; })
+      .Then([](int& count){ for (int i = 0; i < count; ++i) g_cases_array[i] += 1; return count; });
+    gdm::Task<void> second = gdm::mt::Async(*g_mgr, [half, size](){
+      for (int i = half; i < size; ++i) g_cases_array[i] += 1; });
+    gdm::Task<std::size_t> any = gdm::mt::WhenAny(*g_mgr, std::vector<gdm::Task<int>>{first});
+    gdm::Task<int> all = gdm::mt::WhenAll(*g_mgr, std::vector<gdm::Task<void>>{second, first.Then([](int&){})})
+      .Then([](){ return DATA_SUM(g_cases_array); });
+    LOG(TEST, "tasks sum: %d\n", all.Get());
+    assert(all.Get() == size * 2);
+    assert(any.Get() == 0 && first.Get() == half);
+  }
+
+  int total_summ = DATA_SUM(g_cases_array);
+  LOG(FUNC, "tasks data after:  %d\n\n", total_summ);
+  assert(total_summ == g_test_settings.array_size * 2);
+
+  return total_summ;
+}
+
+int case_11_priority_lanes()
+{
+  LOG(FUNC, "case_11_priority_lanes()\n");
+
+  DATA_FILL(g_cases_array, 1);
+  const int half = static_cast<int>(g_cases_array.size()) / 2;
+
+  {
+    CPU_PROFILE_SCOPE("ThreadMain", "ex_11", gdm::core::COLOR_AUTO);
+    gdm::JobQueue& queue = g_mgr->GetJobQueue();
+    gdm::JobCounter background;
+    queue.PushBatchTS([half](int begin, int length){
+      for (int i = half + begin; i < half + begin + length; ++i) { g_cases_array[i] += 1; g_mgr->YieldToCritical(); } },
+      g_test_settings.batch_size, g_cases_array.size() - half, background, gdm::Job::BACKGROUND);
+    gdm::JobCounter critical;
+    queue.PushBatchTS([](int begin, int length){
+      for (int i = begin; i < begin + length; ++i) g_cases_array[i] += 1; },
+      g_test_settings.batch_size, half, critical, gdm::Job::CRITICAL);
+    g_mgr->WaitOnCounter(critical);
+    int sum = std::accumulate(g_cases_array.begin(), g_cases_array.begin() + half, 0);
+    LOG(TEST, "critical lane: %d\n", sum);
+    assert(sum == half * 2);
+    g_mgr->WaitOnCounter(background);
+  }
+
+  int total_summ = DATA_SUM(g_cases_array);
+  LOG(FUNC, "lanes data after:  %d\n\n", total_summ);
+  assert(total_summ == g_test_settings.array_size * 2);
+
+  return total_summ;
+}
+
+int case_12_telemetry()
+{
+  LOG(FUNC, "case_12_telemetry()\n");
+
+  DATA_FILL(g_cases_array, 1);
+
+  {
+    CPU_PROFILE_SCOPE("ThreadMain", "ex_12", gdm::core::COLOR_AUTO);
+
+    // dumps are chained one after another, so printed deltas sum up to the
+    //  counters of the whole time when dump was enabled. Chunks are slowed
+    //  down to let workers dump in the middle of the batch
+
+    FILE* dump = tmpfile();
+    assert(dump);
+    g_mgr->SetTelemetryDump(1, dump);
+    gdm::JobTelemetry before = g_mgr->GetTelemetry();
+    gdm::JobCounter jobs;
+    g_mgr->GetJobQueue().PushBatchTS([](int begin, int length){
+      const auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(200);
+      while (std::chrono::steady_clock::now() < until) { }
+      for (int i = begin; i < begin + length; ++i) g_cases_array[i] += 1; },
+      g_test_settings.batch_size, g_cases_array.size(), jobs);
+    g_mgr->WaitOnCounter(jobs);
+    gdm::JobTelemetry::Worker total = (g_mgr->GetTelemetry() - before).GetTotal();
+    g_mgr->SetTelemetryDump(g_test_settings.log_workers ? 1000 : 0);
+
+    unsigned long long dumped_jobs = 0;
+    int dumps = 0;
+    char line[256];
+    rewind(dump);
+    while (fgets(line, sizeof(line), dump))
+    {
+      unsigned long long jobs_count = 0;
+      if (strncmp(line, "worker", 6) == 0)
+        ++dumps;
+      else if (sscanf(line, "%*s %llu", &jobs_count) == 1)
+        dumped_jobs += jobs_count;
+    }
+    fclose(dump);
+
+    LOG(TEST, "telemetry jobs: %llu, dumped: %llu in %d dumps\n", static_cast<unsigned long long>(total.jobs_), dumped_jobs, dumps);
+    assert(total.jobs_ >= (g_cases_array.size() + g_test_settings.batch_size - 1) / g_test_settings.batch_size);
+    assert(dumps >= 1);
+    assert(dumped_jobs == total.jobs_);
+  }
+
+  int total_summ = DATA_SUM(g_cases_array);
+  LOG(FUNC, "telemetry data after:  %d\n\n", total_summ);
+  assert(total_summ == g_test_settings.array_size * 2);
+
+  return total_summ;
+}
+
+int case_13_algorithms()
+{
+  LOG(FUNC, "case_13_algorithms()\n");
+
+  const int size = static_cast<int>(g_cases_array.size());
+  auto begin = g_cases_array.begin();
+  auto end = g_cases_array.end();
+
+  {
+    CPU_PROFILE_SCOPE("ThreadMain", "ex_13", gdm::core::COLOR_AUTO);
+    for (int i = 0; i < size; ++i)
+      g_cases_array[i] = (size - i) % 1000 - 500;
+    gdm::mt::Sort(*g_mgr, begin, end);
+    assert(std::is_sorted(begin, end));
+
+    std::reverse(begin, end);
+    auto positive_end = gdm::mt::Partition(*g_mgr, begin, end, [](int v){ return v > 0; });
+    assert(std::is_sorted(begin, positive_end, std::greater<>{}) && std::is_sorted(positive_end, end, std::greater<>{}));
+    std::vector<std::size_t> signs = gdm::mt::Histogram(*g_mgr, begin, end, 2, [](int v){ return v > 0 ? 1 : 0; });
+    LOG(TEST, "algorithms positive: %d\n", static_cast<int>(signs[1]));
+    assert(static_cast<int>(signs[1]) == positive_end - begin);
+
+    gdm::mt::Transform(*g_mgr, begin, end, begin, [](int){ return 1; });
+    gdm::mt::InclusiveScan(*g_mgr, begin, end, begin);
+    assert(g_cases_array[size / 3] == size / 3 + 1 && g_cases_array[size - 1] == size);
+    gdm::mt::Transform(*g_mgr, begin, end, begin, [](int){ return 1; });
+    gdm::mt::ExclusiveScan(*g_mgr, begin, end, begin, 0);
+    assert(g_cases_array[size / 3] == size / 3 && g_cases_array[size - 1] == size - 1);
+    gdm::mt::Transform(*g_mgr, begin, end, begin, [](int){ return 2; });
+    assert(gdm::mt::Reduce(*g_mgr, begin, end, 0) == size * 2);
+
+    // moved-from strings are empty, so merge which reads already moved
+    //  values breaks order or loses keys. Keys are longer than small string
+
+    struct Named
+    {
+      std::string s;
+      int idx;
+    };
+    std::vector<Named> named(50000);
+    for (int i = 0; i < static_cast<int>(named.size()); ++i)
+      named[i] = Named{"named_sort_key_" + std::to_string((i * 7919) % 1000), i};
+    gdm::mt::Sort(*g_mgr, named.begin(), named.end(), [](const Named& a, const Named& b){ return a.s < b.s; });
+    for (std::size_t i = 1; i < named.size(); ++i)
+    {
+      const Named& prev = named[i - 1];
+      const Named& curr = named[i];
+      assert(curr.s == "named_sort_key_" + std::to_string((curr.idx * 7919) % 1000));
+      assert(prev.s < curr.s || (prev.s == curr.s && prev.idx < curr.idx));
+    }
+  }
+
+  int total_summ = DATA_SUM(g_cases_array);
+  LOG(FUNC, "algorithms data after:  %d\n\n", total_summ);
+  assert(total_summ == g_test_settings.array_size * 2);
+
+  return total_summ;
+}
+
+int case_14_cancellation()
+{
+  LOG(FUNC, "case_14_cancellation()\n");
+
+  DATA_FILL(g_cases_array, 1);
+  const int half = static_cast<int>(g_cases_array.size()) / 2;
+
+  {
+    CPU_PROFILE_SCOPE("ThreadMain", "ex_14", gdm::core::COLOR_AUTO);
+    gdm::JobQueue& queue = g_mgr->GetJobQueue();
+    gdm::JobTelemetry before = g_mgr->GetTelemetry();
+    gdm::CancellationToken token = gdm::CancellationToken::Create();
+    gdm::JobCounter cancelled;
+    {
+      std::unique_lock<std::timed_mutex> lock(queue.GetMutex());
+      queue.PushBatch([](int begin, int length){
+        for (int i = begin; i < begin + length; ++i) g_cases_array[i] += 100; },
+        g_test_settings.batch_size, g_cases_array.size(), cancelled, gdm::Job::BACKGROUND, token);
+      token.Cancel();
+    }
+    gdm::JobCounter critical;
+    queue.PushBatchTS([](int begin, int length){
+      for (int i = begin; i < begin + length; ++i) g_cases_array[i] += 1; },
+      g_test_settings.batch_size, half, critical, gdm::Job::CRITICAL);
+    g_mgr->WaitOnCounter(cancelled);
+    g_mgr->WaitOnCounter(critical);
+    gdm::JobTelemetry::Worker total = (g_mgr->GetTelemetry() - before).GetTotal();
+    LOG(TEST, "cancelled dropped: %llu\n", static_cast<unsigned long long>(total.dropped_));
+    assert(total.dropped_ > 0);
+
+    // jobs are longer than budget, so each finished job pauses the lane and
+    //  between two resumes by BeginFrame() worker starts at most one job.
+    //  Starts are not attributed to frames, since job may see frame number
+    //  of the next frame before BeginFrame() has resumed the lane
+
+    static std::atomic<int> starts;
+    starts = 0;
+    int frames = 0;
+
+    g_mgr->SetBackgroundBudget(1);
+    g_mgr->BeginFrame();
+    ++frames;
+    gdm::JobCounter background;
+    queue.PushBatchTS([half](int begin, int length){
+      ++starts;
+      const auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(20);
+      while (std::chrono::steady_clock::now() < until) { }
+      for (int i = half + begin; i < half + begin + length; ++i) g_cases_array[i] += 1; },
+      g_test_settings.batch_size, g_cases_array.size() - half, background, gdm::Job::BACKGROUND);
+    while (!background.IsDone())
+    {
+      SLEEP_MS(GENERAL, 1);
+      g_mgr->BeginFrame();
+      ++frames;
+    }
+    g_mgr->SetBackgroundBudget(0);
+    const int chunks = static_cast<int>((g_cases_array.size() - half + g_test_settings.batch_size - 1) / g_test_settings.batch_size);
+    LOG(TEST, "budget frames: %d for %d jobs, starts: %d\n", frames, chunks, starts.load());
+    assert(starts >= chunks);
+    assert(starts <= frames * static_cast<int>(g_mgr->GetWorkersCount()));
+  }
+
+  int total_summ = DATA_SUM(g_cases_array);
+  LOG(FUNC, "cancellation data after:  %d\n\n", total_summ);
+  assert(total_summ == g_test_settings.array_size * 2);
+
+  return total_summ;
+}
+
+int case_15_frame_arena()
+{
+  LOG(FUNC, "case_15_frame_arena()\n");
+
+  DATA_FILL(g_cases_array, 1);
+
+  struct Record
+  {
+    int begin;
+    int length;
+    int marker;
+  };
+
+  {
+    CPU_PROFILE_SCOPE("ThreadMain", "ex_15", gdm::core::COLOR_AUTO);
+    gdm::JobQueue& queue = g_mgr->GetJobQueue();
+    std::mutex records_lock;
+    std::vector<Record*> records;
+
+    // scratch records of previous frame should survive allocations of the next one
+
+    g_mgr->BeginFrame();
+    gdm::JobCounter first;
+    queue.PushBatchTS([&records_lock, &records](int begin, int length){
+      Record* record = g_mgr->GetFrameArena().Allocate<Record>(1);
+      assert(record);
+      *record = Record{begin, length, begin ^ 0x5a5a};
+      std::lock_guard<std::mutex> lock(records_lock);
+      records.push_back(record); },
+      g_test_settings.batch_size, g_cases_array.size(), first);
+    g_mgr->WaitOnCounter(first);
+
+    g_mgr->BeginFrame();
+    gdm::JobCounter second;
+    queue.PushBatchTS([](int begin, int length){
+      Record* record = g_mgr->GetFrameArena().Allocate<Record>(1);
+      assert(record);
+      *record = Record{-1, -1, -1};
+      for (int i = begin; i < begin + length; ++i) g_cases_array[i] += 1; },
+      g_test_settings.batch_size, g_cases_array.size(), second);
+    g_mgr->WaitOnCounter(second);
+
+    std::size_t covered = 0;
+    for (const Record* record : records)
+    {
+      assert(record->marker == (record->begin ^ 0x5a5a));
+      covered += record->length;
+    }
+    LOG(TEST, "frame records: %zu, main arena used: %zu\n", records.size(), g_mgr->GetFrameArena().GetUsed());
+    assert(covered == g_cases_array.size());
+  }
+
+  int total_summ = DATA_SUM(g_cases_array);
+  LOG(FUNC, "frame arena data after:  %d\n\n", total_summ);
+  assert(total_summ == g_test_settings.array_size * 2);
+
+  return total_summ;
+}
+
+int case_16_nested_waits()
+{
+  LOG(FUNC, "case_16_nested_waits()\n");
+
+  // the only worker waits inside the job, main thread doesn't help, so
+  //  nested jobs are executed only by the waiting worker itself
+
+  static gdm::JobManager single {0, 1, gdm::core::BELOW_NORMAL, "Single"};
+
+  DATA_FILL(g_cases_array, 1);
+  const int size = static_cast<int>(g_cases_array.size());
+  const int third = size / 3;
+
+  {
+    CPU_PROFILE_SCOPE("ThreadMain", "ex_16", gdm::core::COLOR_AUTO);
+    gdm::JobCounter outer;
+    single.GetJobQueue().PushJobTS([third, size](){
+      gdm::JobCounter inner;
+      single.GetJobQueue().PushBatchTS([](int begin, int length){
+        for (int i = begin; i < begin + length; ++i) g_cases_array[i] += 1; },
+        g_test_settings.batch_size, third, inner);
+      single.WaitOnCounter(inner);
+      gdm::mt::ParallelFor(single, {third, third * 2}, [](int i){ g_cases_array[i] += 1; });
+      gdm::Task<int> rest = gdm::mt::Async(single, [third, size](){
+        for (int i = third * 2; i < size; ++i) g_cases_array[i] += 1;
+        return size - third * 2; });
+      LOG(TEST, "nested task count: %d\n", rest.Get());
+      assert(rest.Get() == size - third * 2); }, outer);
+    while (!outer.IsDone())
+      std::this_thread::yield();
+  }
+
+  int total_summ = DATA_SUM(g_cases_array);
+  LOG(FUNC, "nested waits data after:  %d\n\n", total_summ);
+  assert(total_summ == g_test_settings.array_size * 2);
+
+  return total_summ;
+}
+
+#if defined(__cpp_impl_coroutine)
+
+gdm::Task<int> co_increment(gdm::JobManager& mgr, int from, int to)
+{
+  gdm::JobCounter jobs;
+  mgr.GetJobQueue().PushBatchTS([from](int begin, int length){
+    for (int i = from + begin; i < from + begin + length; ++i) g_cases_array[i] += 1; },
+    g_test_settings.batch_size, to - from, jobs);
+  co_await jobs;
+  co_return to - from;
+}
+
+gdm::Task<int> co_increment_halves(gdm::JobManager& mgr)
+{
+  const int size = static_cast<int>(g_cases_array.size());
+  gdm::Task<int> first = co_increment(mgr, 0, size / 2);
+  int second = co_await co_increment(mgr, size / 2, size);
+  co_return co_await first + second;
+}
+
+int case_10_coroutines()
+{
+  LOG(FUNC, "case_10_coroutines()\n");
+
+  DATA_FILL(g_cases_array, 1);
+
+  {
+    CPU_PROFILE_SCOPE("ThreadMain", "ex_10", gdm::core::COLOR_AUTO);
+    int count = co_increment_halves(*g_mgr).Get();
+    LOG(TEST, "coroutines count: %d\n", count);
+    assert(count == g_test_settings.array_size);
+  }
+
+  int total_summ = DATA_SUM(g_cases_array);
+  LOG(FUNC, "coroutines data after:  %d\n\n", total_summ);
+  assert(total_summ == g_test_settings.array_size * 2);
+
+  return total_summ;
+}
+
+#endif
+
 void case_4_simulate_post_from_diff_sources_separate_thread()
 {
   static int cnt;
@@ -257,9 +774,82 @@ void case_4_simulate_post_from_diff_sources_separate_thread()
   t.detach();
 }
 
+// Whole list is run on every mode of manager. Each manager has at least two
+//  workers, so stealing and help while waiting really happen
+
+static bool RUN_CASES()
+{
+  int total = 0;
+#if 1
+  // first scenario - sequenced adding jobs
+  total += case_1_diff_jobs_semantic();
+  SLEEP_MS(GENERAL, 100);
+  total += case_2_batch_jobs_semantic();
+  SLEEP_MS(GENERAL, 100);
+  total += case_3_jobs_with_deps();
+  SLEEP_MS(GENERAL, 100);
+  total += case_4_simulate_post_from_diff_sources();
+  SLEEP_MS(GENERAL, 100);
+  total += case_5_job_graph();
+  SLEEP_MS(GENERAL, 100);
+  total += case_6_parallel_for();
+  SLEEP_MS(GENERAL, 100);
+  total += case_7_job_counters();
+  SLEEP_MS(GENERAL, 100);
+  total += case_8_separate_pools();
+  SLEEP_MS(GENERAL, 100);
+  total += case_9_tasks();
+  SLEEP_MS(GENERAL, 100);
+  total += case_11_priority_lanes();
+  SLEEP_MS(GENERAL, 100);
+  total += case_12_telemetry();
+  SLEEP_MS(GENERAL, 100);
+  total += case_13_algorithms();
+  SLEEP_MS(GENERAL, 100);
+  total += case_14_cancellation();
+  SLEEP_MS(GENERAL, 100);
+  total += case_15_frame_arena();
+  SLEEP_MS(GENERAL, 100);
+  total += case_16_nested_waits();
+  SLEEP_MS(GENERAL, 100);
+  assert(total == g_test_settings.array_size * 31);
+#ifdef NDEBUG
+  if(total != g_test_settings.array_size * 31)
+    return false;
+#endif
+#if defined(__cpp_impl_coroutine)
+  // coroutine jobs are checked only when built as c++20
+  int co_total = case_10_coroutines();
+  SLEEP_MS(GENERAL, 100);
+  assert(co_total == g_test_settings.array_size * 2);
+#ifdef NDEBUG
+  if(co_total != g_test_settings.array_size * 2)
+    return false;
+#endif
+#endif
+#endif
+
+#if 0
+  // second scenario - adding jobs from different threads
+  total += case_4_simulate_post_from_diff_sources();
+  case_4_simulate_post_from_diff_sources_separate_thread();
+  SLEEP_MS(GENERAL, 100);
+#ifdef NDEBUG
+  if(total != g_test_settings.array_size * 3)
+    return false;
+#endif
+#endif
+
+  return true;
+}
+
 int main(int argc, const char** argv)
 {
-  g_mgr = new gdm::JobManager{};
+  const unsigned workers = std::max(3u, std::thread::hardware_concurrency()) - 1;
+  gdm::JobManager* managers[] = {
+    new gdm::JobManager{0, workers},
+    new gdm::JobManager{gdm::core::WORK_STEALING, workers}
+  };
 
   g_test_settings.never_worker_sleep = argc > 1 ? atoi(argv[1]): true;
   g_test_settings.never_main_sleep = argc > 2 ? atoi(argv[2]): true;
@@ -284,6 +874,8 @@ int main(int argc, const char** argv)
     }
     else
       gdm::Logger::SetFlags(gdm::core::LOG_TO_STDOUT | gdm::core::LOG_TIMESTAMP);
+    for (gdm::JobManager* mgr : managers)
+      mgr->SetTelemetryDump(1000);
   }
 
   g_cases_array = std::vector<int>(g_test_settings.array_size, 1);
@@ -300,38 +892,16 @@ int main(int argc, const char** argv)
     if (dt >= 1000)
       LOG(MAIN, "ITERATION #%d : ", i);
 
-    int total = 0;
-#if 1
-    // first scenario - sequenced adding jobs
-    total += case_1_diff_jobs_semantic();
-    SLEEP_MS(GENERAL, 100);
-    total += case_2_batch_jobs_semantic();
-    SLEEP_MS(GENERAL, 100);
-    total += case_3_jobs_with_deps();
-    SLEEP_MS(GENERAL, 100);
-    total += case_4_simulate_post_from_diff_sources();
-    SLEEP_MS(GENERAL, 100);
-    assert(total == g_test_settings.array_size * 8);
-#ifdef NDEBUG
-    if(total != g_test_settings.array_size * 8)
-      return -1;
-#endif
-#endif
-
-#if 0
-    // second scenario - adding jobs from different threads
-    total += case_4_simulate_post_from_diff_sources();
-    case_4_simulate_post_from_diff_sources_separate_thread();
-    SLEEP_MS(GENERAL, 100);
-#ifdef NDEBUG
-    if(total != g_test_settings.array_size * 3)
-      return -1;
-#endif
-#endif
+    for (gdm::JobManager* mgr : managers)
+    {
+      g_mgr = mgr;
+      if (!RUN_CASES())
+        return -1;
+    }
 
     if (dt >= 1000)
     {
-      LOG(MAIN, " == %u\t%d\n\n", DATA_SUM(g_cases_array), total);
+      LOG(MAIN, " == %u\n\n", DATA_SUM(g_cases_array));
       dt = 0;
     }
     GDM_PROFILER_FRAME();
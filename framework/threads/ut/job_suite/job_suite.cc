@@ -0,0 +1,217 @@
+// *************************************************************
+// File:    job_suite.cc
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+// Usage: job_suite [max_workers] [repeats] [csv|json] [filter]
+
+// Repeatable scheduler benchmarks. Every scenario is run for warmup first,
+//  then sampled given number of times, and each row has summary of samples.
+//  Output is csv (or json) only, so runs may be diffed or loaded to sheets
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <algorithm>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "threads/job_manager.h"
+
+#include "job_bench/job_scenarios.h"
+
+struct SuiteSettings : BenchSettings
+{
+  SuiteSettings() { repeats = 15; }
+
+  int warmups = 2;
+  bool json = false;
+  const char* filter = "";
+  int empty_jobs = 4096;
+  int compute_items = 1 << 16;
+  int memory_items = 1 << 23;
+  int latency_rounds = 256;
+} g_suite_settings;
+
+// Warmup samples are thrown away, they pay for first touch of memory and
+//  for waking up the pool
+
+template <class Fn>
+static Stats Measure(Fn&& sample)
+{
+  for (int i = 0; i < g_suite_settings.warmups; ++i)
+    sample();
+  std::vector<double> samples;
+  samples.reserve(g_suite_settings.repeats);
+  for (int i = 0; i < g_suite_settings.repeats; ++i)
+    samples.push_back(sample());
+  return Summarize(std::move(samples));
+}
+
+static bool IsEnabled(const char* scenario)
+{
+  return !*g_suite_settings.filter || strstr(scenario, g_suite_settings.filter);
+}
+
+static void PrintHeader()
+{
+  if (g_suite_settings.json)
+    printf("[\n");
+  else
+    printf("scenario,mode,workers,unit,samples,min,median,mean,stddev,p90,max\n");
+}
+
+static void PrintRow(const char* scenario, gdm::core::JobManagerProps flags, unsigned workers, const char* unit, const Stats& stats)
+{
+  static bool first = true;
+  if (g_suite_settings.json)
+  {
+    printf("%s  {\"scenario\": \"%s\", \"mode\": \"%s\", \"workers\": %u, \"unit\": \"%s\", \"samples\": %d, "
+      "\"min\": %.3f, \"median\": %.3f, \"mean\": %.3f, \"stddev\": %.3f, \"p90\": %.3f, \"max\": %.3f}",
+      first ? "" : ",\n", scenario, MODE_NAME(flags), workers, unit, stats.samples_,
+      stats.min_, stats.median_, stats.mean_, stats.stddev_, stats.p90_, stats.max_);
+  }
+  else
+  {
+    printf("%s,%s,%u,%s,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n", scenario, MODE_NAME(flags), workers, unit, stats.samples_,
+      stats.min_, stats.median_, stats.mean_, stats.stddev_, stats.p90_, stats.max_);
+  }
+  first = false;
+  fflush(stdout);
+}
+
+static void PrintFooter()
+{
+  if (g_suite_settings.json)
+    printf("\n]\n");
+}
+
+// Empty jobs pushed under one lock and waited on counter, pure scheduling cost
+
+static double sample_empty_jobs(gdm::JobManager& mgr)
+{
+  return g_suite_settings.empty_jobs / RunSingleJobs(mgr, g_suite_settings.empty_jobs);
+}
+
+// Batch over small array with heavy per item math, stays in cache
+
+static double sample_compute_batch(gdm::JobManager& mgr, std::vector<float>& array)
+{
+  auto func = [&array](int begin, int length)
+  {
+    for (int i = begin; i < begin + length; ++i)
+    {
+      float value = array[i];
+      for (int k = 0; k < 32; ++k)
+        value = std::sqrt(value * value + 1.f) * 0.5f;
+      array[i] = value;
+    }
+  };
+  return array.size() / RunBatch(mgr, func, 256, array.size());
+}
+
+// Streaming batch over array much bigger than caches, result is in MB/s of
+//  read and written memory
+
+static double sample_memory_batch(gdm::JobManager& mgr, std::vector<float>& src, std::vector<float>& dst)
+{
+  auto func = [&src, &dst](int begin, int length)
+  {
+    for (int i = begin; i < begin + length; ++i)
+      dst[i] = src[i] * 1.5f + dst[i];
+  };
+  return 3.0 * src.size() * sizeof(float) / RunBatch(mgr, func, 16384, src.size());
+}
+
+static double sample_wait_latency(gdm::JobManager& mgr)
+{
+  std::vector<double> latencies;
+  for (int i = 0; i < g_suite_settings.latency_rounds / 8; ++i)
+    latencies.push_back(RunRoundTrip(mgr));
+  return Summarize(std::move(latencies)).median_;
+}
+
+static double sample_barrier_latency(gdm::JobManager& mgr)
+{
+  std::vector<double> latencies;
+  for (int i = 0; i < g_suite_settings.latency_rounds / 8; ++i)
+  {
+    const double start = TIME_NOW_US();
+    mgr.WaitOnBarrierTS();
+    latencies.push_back(TIME_NOW_US() - start);
+  }
+  return Summarize(std::move(latencies)).median_;
+}
+
+// External producer pushes jobs with pauses between them, latency is time
+//  from push until worker starts the job. Sample is median of one run
+
+static double sample_producer_consumer(gdm::JobManager& mgr)
+{
+  const int rounds = g_suite_settings.latency_rounds;
+  std::vector<double> latencies (rounds, 0.0);
+  gdm::JobCounter jobs;
+  std::thread producer ([&mgr, &latencies, &jobs, rounds]()
+  {
+    for (int i = 0; i < rounds; ++i)
+    {
+      for (double until = TIME_NOW_US() + 20.0; TIME_NOW_US() < until; )
+        std::this_thread::yield();
+      const double pushed = TIME_NOW_US();
+      mgr.GetJobQueue().PushJobTS([&latencies, i, pushed](){ latencies[i] = TIME_NOW_US() - pushed; }, jobs);
+    }
+  });
+  producer.join();
+  mgr.WaitOnCounter(jobs);
+  return Summarize(std::move(latencies)).median_;
+}
+
+static auto GetWorkerCounts() -> std::vector<unsigned>
+{
+  std::vector<unsigned> counts;
+  for (unsigned workers = 1; workers < g_suite_settings.max_workers; workers *= 2)
+    counts.push_back(workers);
+  counts.push_back(g_suite_settings.max_workers);
+  return counts;
+}
+
+static void run_mode(gdm::core::JobManagerProps flags)
+{
+  std::vector<float> compute (g_suite_settings.compute_items, 1.f);
+  std::vector<float> src (g_suite_settings.memory_items, 1.f);
+  std::vector<float> dst (g_suite_settings.memory_items, 0.f);
+
+  for (unsigned workers : GetWorkerCounts())
+  {
+    gdm::JobManager mgr {flags, workers};
+    if (IsEnabled("empty_jobs"))
+      PrintRow("empty_jobs", flags, workers, "jobs/us", Measure([&](){ return sample_empty_jobs(mgr); }));
+    if (IsEnabled("compute_batch"))
+      PrintRow("compute_batch", flags, workers, "items/us", Measure([&](){ return sample_compute_batch(mgr, compute); }));
+    if (IsEnabled("memory_batch"))
+      PrintRow("memory_batch", flags, workers, "MB/s", Measure([&](){ return sample_memory_batch(mgr, src, dst); }));
+    if (IsEnabled("wait_latency"))
+      PrintRow("wait_latency", flags, workers, "us", Measure([&](){ return sample_wait_latency(mgr); }));
+    if (IsEnabled("barrier_latency"))
+      PrintRow("barrier_latency", flags, workers, "us", Measure([&](){ return sample_barrier_latency(mgr); }));
+    if (IsEnabled("producer_consumer"))
+      PrintRow("producer_consumer", flags, workers, "us", Measure([&](){ return sample_producer_consumer(mgr); }));
+  }
+}
+
+int main(int argc, const char** argv)
+{
+  g_suite_settings.Parse(argc, argv);
+  g_suite_settings.json = argc > 3 && !strcmp(argv[3], "json");
+  g_suite_settings.filter = argc > 4 ? argv[4] : g_suite_settings.filter;
+
+  PrintHeader();
+  run_mode(0);
+  run_mode(gdm::core::WORK_STEALING);
+  PrintFooter();
+
+  return 0;
+}
@@ -0,0 +1,167 @@
+// *************************************************************
+// File:    locks_bench.cc
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+// Usage: locks_bench [max_threads] [iterations]
+
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <mutex>
+#include <shared_mutex>
+#include <algorithm>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "threads/spin_lock.h"
+#include "threads/ticket_lock.h"
+#include "threads/mcs_lock.h"
+#include "threads/rw_spin_lock.h"
+
+struct BenchSettings
+{
+  unsigned max_threads = std::max(2u, std::thread::hardware_concurrency());
+  int iterations = 100000;
+  int short_section = 1;
+  int long_section = 64;
+  int outside_work = 32;
+} g_bench_settings;
+
+struct alignas(64) SharedData
+{
+  unsigned values[16];
+
+}; // struct SharedData
+
+static double TIME_NOW_MS()
+{
+  return std::chrono::duration<double, std::milli>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void WORK(unsigned* values, int count)
+{
+  for (int i = 0; i < count; ++i)
+    values[i % 16] = values[i % 16] * 31 + i;
+}
+
+// Threads take the lock, change shared data for section_work steps and
+//  do some local work before next try. Returns locks per second, or zero
+//  if lost updates show that lock didn't exclude
+
+template <class Lock>
+static double bench_lock(unsigned threads_count, int section_work)
+{
+  Lock lock;
+  SharedData shared {};
+  unsigned counter = 0;
+
+  double start = TIME_NOW_MS();
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t < threads_count; ++t)
+  {
+    threads.emplace_back([&lock, &shared, &counter, section_work](){
+      unsigned local[16] = {};
+      for (int i = 0; i < g_bench_settings.iterations; ++i)
+      {
+        {
+          std::lock_guard<Lock> guard(lock);
+          ++counter;
+          WORK(shared.values, section_work);
+        }
+        WORK(local, g_bench_settings.outside_work);
+      }
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+  double elapsed = TIME_NOW_MS() - start;
+
+  if (counter != threads_count * g_bench_settings.iterations)
+    return 0.0;
+  return counter / elapsed * 1000.0;
+}
+
+// Every eighth lock is exclusive, others are shared
+
+template <class Lock>
+static double bench_read_mostly(unsigned threads_count)
+{
+  Lock lock;
+  SharedData shared {};
+  unsigned counter = 0;
+
+  double start = TIME_NOW_MS();
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t < threads_count; ++t)
+  {
+    threads.emplace_back([&lock, &shared, &counter](){
+      unsigned local[16] = {};
+      for (int i = 0; i < g_bench_settings.iterations; ++i)
+      {
+        if (i % 8 == 0)
+        {
+          std::unique_lock<Lock> writer(lock);
+          ++counter;
+          WORK(shared.values, g_bench_settings.short_section);
+        }
+        else
+        {
+          std::shared_lock<Lock> reader(lock);
+          for (int k = 0; k < 16; ++k)
+            local[k] += shared.values[k];
+        }
+        WORK(local, g_bench_settings.outside_work);
+      }
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+  double elapsed = TIME_NOW_MS() - start;
+
+  if (counter != threads_count * ((g_bench_settings.iterations + 7) / 8))
+    return 0.0;
+  return threads_count * g_bench_settings.iterations / elapsed * 1000.0;
+}
+
+static void run_contention(const char* name, int section_work)
+{
+  printf("%s section, locks/s\n", name);
+  printf("%-8s %-12s %-12s %-12s %-12s %-12s\n", "threads", "std::mutex", "spin", "ticket", "mcs", "rw spin");
+  for (unsigned threads = 1; threads <= g_bench_settings.max_threads; threads *= 2)
+  {
+    printf("%-8u %-12.0f %-12.0f %-12.0f %-12.0f %-12.0f\n", threads,
+      bench_lock<std::mutex>(threads, section_work),
+      bench_lock<gdm::SpinLock>(threads, section_work),
+      bench_lock<gdm::TicketLock>(threads, section_work),
+      bench_lock<gdm::McsLock>(threads, section_work),
+      bench_lock<gdm::RwSpinLock>(threads, section_work));
+  }
+}
+
+static void run_read_mostly()
+{
+  printf("read mostly, locks/s\n");
+  printf("%-8s %-18s %-12s\n", "threads", "std::shared_mutex", "rw spin");
+  for (unsigned threads = 1; threads <= g_bench_settings.max_threads; threads *= 2)
+  {
+    printf("%-8u %-18.0f %-12.0f\n", threads,
+      bench_read_mostly<std::shared_mutex>(threads),
+      bench_read_mostly<gdm::RwSpinLock>(threads));
+  }
+}
+
+int main(int argc, const char** argv)
+{
+  g_bench_settings.max_threads = argc > 1 ? atoi(argv[1]) : g_bench_settings.max_threads;
+  g_bench_settings.iterations = argc > 2 ? atoi(argv[2]) : g_bench_settings.iterations;
+
+  run_contention("short", g_bench_settings.short_section);
+  run_contention("long", g_bench_settings.long_section);
+  run_read_mostly();
+
+  return 0;
+}
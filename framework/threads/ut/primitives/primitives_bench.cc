@@ -0,0 +1,183 @@
+// *************************************************************
+// File:    primitives_bench.cc
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+// Usage: primitives_bench [iterations]
+
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <algorithm>
+#include <condition_variable>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "threads/semaphore.h"
+#include "threads/lightweight_semaphore.h"
+#include "threads/fence.h"
+
+struct BenchSettings
+{
+  int iterations = 1000000;
+  int rounds = 10000;
+} g_bench_settings;
+
+// Semaphore as it was before futex version, to compare with
+
+struct CvSemaphore
+{
+  explicit CvSemaphore(int value) : value_{value} { }
+
+  void Post()
+  {
+    {
+      std::unique_lock<std::mutex> lock(mx_);
+      ++value_;
+    }
+    cv_.notify_all();
+  }
+
+  void Wait()
+  {
+    std::unique_lock<std::mutex> lock(mx_);
+    cv_.wait(lock, [this](){ return value_ > 0; });
+    --value_;
+  }
+
+private:
+  int value_;
+  std::condition_variable cv_;
+  std::mutex mx_;
+
+}; // struct CvSemaphore
+
+static double TIME_NOW_NS()
+{
+  return std::chrono::duration<double, std::nano>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static double MEDIAN(std::vector<double>& values)
+{
+  std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+  return values[values.size() / 2];
+}
+
+// Post and Wait on the same thread, nobody ever sleeps
+
+template <class Sema>
+static double bench_uncontended()
+{
+  Sema sema {0};
+  double start = TIME_NOW_NS();
+  for (int i = 0; i < g_bench_settings.iterations; ++i)
+  {
+    sema.Post();
+    sema.Wait();
+  }
+  return (TIME_NOW_NS() - start) / g_bench_settings.iterations;
+}
+
+// Round trip between two threads, median
+
+template <class Sema>
+static double bench_ping_pong()
+{
+  Sema ping {0};
+  Sema pong {0};
+  std::thread thread ([&](){
+    for (int i = 0; i < g_bench_settings.rounds; ++i) { ping.Wait(); pong.Post(); } });
+
+  std::vector<double> latencies;
+  for (int i = 0; i < g_bench_settings.rounds; ++i)
+  {
+    double start = TIME_NOW_NS();
+    ping.Post();
+    pong.Wait();
+    latencies.push_back(TIME_NOW_NS() - start);
+  }
+  thread.join();
+  return MEDIAN(latencies);
+}
+
+// Time from Post to the moment when sleeping waiter runs, median
+
+template <class Sema>
+static double bench_wake()
+{
+  const int rounds = std::max(1, g_bench_settings.rounds / 100);
+  Sema sema {0};
+  std::atomic<double> woken {0.0};
+  std::thread thread ([&](){
+    for (int i = 0; i < rounds; ++i) { sema.Wait(); woken = TIME_NOW_NS(); } });
+
+  std::vector<double> latencies;
+  for (int i = 0; i < rounds; ++i)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    woken = 0.0;
+    double start = TIME_NOW_NS();
+    sema.Post();
+    while (woken.load() == 0.0)
+      std::this_thread::yield();
+    latencies.push_back(woken.load() - start);
+  }
+  thread.join();
+  return MEDIAN(latencies);
+}
+
+template <class Sema>
+static void run_semaphore(const char* name)
+{
+  printf("%-14s %-18.1f %-18.1f %-18.1f\n", name, bench_uncontended<Sema>(), bench_ping_pong<Sema>(), bench_wake<Sema>());
+}
+
+static void run_fence()
+{
+  gdm::Fence fence;
+  double start = TIME_NOW_NS();
+  for (int i = 1; i <= g_bench_settings.iterations; ++i)
+  {
+    fence.Signal(i);
+    fence.WaitOnValue(i);
+  }
+  double uncontended = (TIME_NOW_NS() - start) / g_bench_settings.iterations;
+
+  const int rounds = std::max(1, g_bench_settings.rounds / 100);
+  std::atomic<double> woken {0.0};
+  std::thread thread ([&](){
+    for (int i = 1; i <= rounds; ++i) { fence.WaitOnValue(g_bench_settings.iterations + i); woken = TIME_NOW_NS(); } });
+
+  std::vector<double> latencies;
+  for (int i = 1; i <= rounds; ++i)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    woken = 0.0;
+    start = TIME_NOW_NS();
+    fence.Signal(g_bench_settings.iterations + i);
+    while (woken.load() == 0.0)
+      std::this_thread::yield();
+    latencies.push_back(woken.load() - start);
+  }
+  thread.join();
+  printf("%-14s %-18.1f %-18s %-18.1f\n", "fence", uncontended, "-", MEDIAN(latencies));
+}
+
+int main(int argc, const char** argv)
+{
+  g_bench_settings.iterations = argc > 1 ? atoi(argv[1]) : g_bench_settings.iterations;
+  g_bench_settings.rounds = std::max(100, g_bench_settings.iterations / 100);
+
+  printf("%-14s %-18s %-18s %-18s\n", "primitive", "post+wait ns", "ping pong ns", "wake ns");
+  run_semaphore<CvSemaphore>("cv semaphore");
+  run_semaphore<gdm::Semaphore>("semaphore");
+  run_semaphore<gdm::LightweightSemaphore>("lightweight");
+  run_fence();
+
+  return 0;
+}
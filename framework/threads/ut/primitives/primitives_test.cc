@@ -0,0 +1,238 @@
+// *************************************************************
+// File:    primitives_test.cc
+// Author:  Novoselov Anton @ 2021
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+// Usage: primitives_test [iterations] [threads]
+
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <mutex>
+#include <shared_mutex>
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "threads/semaphore.h"
+#include "threads/lightweight_semaphore.h"
+#include "threads/fence.h"
+#include "threads/spin_lock.h"
+#include "threads/ticket_lock.h"
+#include "threads/mcs_lock.h"
+#include "threads/rw_spin_lock.h"
+
+struct TestSettings
+{
+  int iterations = 100000;
+  int threads = 4;
+} g_test_settings;
+
+// Producers post units one by one, consumers take them. Every unit should
+//  be taken exactly once and nobody should sleep forever
+
+template <class Sema>
+static int case_producers_consumers(const char* name)
+{
+  Sema sema {0};
+  std::atomic<int> taken {0};
+  const int units = g_test_settings.iterations * g_test_settings.threads;
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < g_test_settings.threads; ++i)
+  {
+    threads.emplace_back([&sema, &taken](){
+      for (int k = 0; k < g_test_settings.iterations; ++k) { sema.Wait(); taken.fetch_add(1, std::memory_order_relaxed); } });
+    threads.emplace_back([&sema](){
+      for (int k = 0; k < g_test_settings.iterations; ++k) sema.Post(); });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+
+  printf("%s producers/consumers: %d of %d\n", name, taken.load(), units);
+  assert(taken == units && sema.Get() == 0);
+  return taken == units ? 0 : 1;
+}
+
+// Consumers fall asleep first, then all units are posted at once
+
+template <class Sema>
+static int case_bulk_post(const char* name)
+{
+  Sema sema {0};
+  std::atomic<int> taken {0};
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < g_test_settings.threads; ++i)
+    threads.emplace_back([&sema, &taken](){ sema.Wait(); taken.fetch_add(1); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  sema.Post(g_test_settings.threads);
+  for (std::thread& thread : threads)
+    thread.join();
+
+  printf("%s bulk post: %d of %d\n", name, taken.load(), g_test_settings.threads);
+  assert(taken == g_test_settings.threads && sema.Get() == 0 && !sema.TryWait());
+  return taken == g_test_settings.threads ? 0 : 1;
+}
+
+// Two threads pass the turn to each other, data written before Post should
+//  be visible after Wait
+
+template <class Sema>
+static int case_ping_pong(const char* name)
+{
+  Sema ping {0};
+  Sema pong {0};
+  int data = 0;
+  int errors = 0;
+
+  std::thread thread ([&](){
+    for (int i = 0; i < g_test_settings.iterations; ++i) { ping.Wait(); errors += data != i * 2 + 1; ++data; pong.Post(); } });
+  for (int i = 0; i < g_test_settings.iterations; ++i)
+  {
+    errors += data != i * 2;
+    ++data;
+    ping.Post();
+    pong.Wait();
+  }
+  thread.join();
+
+  printf("%s ping pong: %d errors\n", name, errors);
+  assert(errors == 0 && data == g_test_settings.iterations * 2);
+  return errors;
+}
+
+// Waiters go through values in their own order, signaller moves fence forward
+
+static int case_fence()
+{
+  gdm::Fence fence;
+  const int values = g_test_settings.iterations / 100;
+  std::atomic<int> errors {0};
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < g_test_settings.threads; ++i)
+  {
+    threads.emplace_back([&fence, &errors, i, values](){
+      for (int value = i; value <= values; value += g_test_settings.threads) {
+        fence.WaitOnValue(value); errors += fence.GetValue() < value; } });
+  }
+  for (int value = 1; value <= values; ++value)
+  {
+    if (value % 64 == 0)
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    fence.Signal(value);
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+
+  printf("fence: %d errors, value %d\n", errors.load(), fence.GetValue());
+  assert(errors == 0 && fence.GetValue() == values);
+  return errors;
+}
+
+// Non atomic counter is changed under lock, lost updates mean broken
+//  exclusion. Nested lock of other instance checks that one thread may
+//  hold two locks
+
+template <class Lock>
+static int case_lock(const char* name)
+{
+  Lock lock;
+  Lock inner;
+  int counter = 0;
+  int inner_counter = 0;
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < g_test_settings.threads; ++i)
+  {
+    threads.emplace_back([&](){
+      for (int k = 0; k < g_test_settings.iterations; ++k)
+      {
+        if (k % 2 == 0)
+        {
+          std::lock_guard<Lock> guard(lock);
+          ++counter;
+          std::lock_guard<Lock> inner_guard(inner);
+          ++inner_counter;
+        }
+        else
+        {
+          while (!lock.TryLock()) { }
+          ++counter;
+          lock.Unlock();
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+
+  const int expected = g_test_settings.iterations * g_test_settings.threads;
+  printf("%s lock: %d of %d\n", name, counter, expected);
+  assert(counter == expected && inner_counter == expected - expected / 2);
+  return counter == expected ? 0 : 1;
+}
+
+// Readers check that pair written by writer is never seen half updated
+
+static int case_rw_lock()
+{
+  gdm::RwSpinLock lock;
+  int first = 0;
+  int second = 0;
+  std::atomic<int> errors {0};
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < g_test_settings.threads; ++i)
+  {
+    threads.emplace_back([&, i](){
+      for (int k = 0; k < g_test_settings.iterations; ++k)
+      {
+        if ((k + i) % 8 == 0)
+        {
+          std::unique_lock<gdm::RwSpinLock> writer(lock);
+          ++first;
+          ++second;
+        }
+        else
+        {
+          std::shared_lock<gdm::RwSpinLock> reader(lock);
+          errors += first != second;
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+
+  printf("rw lock: %d errors, %d writes\n", errors.load(), first);
+  assert(errors == 0 && first == second);
+  return errors;
+}
+
+int main(int argc, const char** argv)
+{
+  g_test_settings.iterations = argc > 1 ? atoi(argv[1]) : g_test_settings.iterations;
+  g_test_settings.threads = argc > 2 ? atoi(argv[2]) : g_test_settings.threads;
+
+  int errors = 0;
+  errors += case_producers_consumers<gdm::Semaphore>("semaphore");
+  errors += case_producers_consumers<gdm::LightweightSemaphore>("lightweight");
+  errors += case_bulk_post<gdm::Semaphore>("semaphore");
+  errors += case_bulk_post<gdm::LightweightSemaphore>("lightweight");
+  errors += case_ping_pong<gdm::Semaphore>("semaphore");
+  errors += case_ping_pong<gdm::LightweightSemaphore>("lightweight");
+  errors += case_fence();
+  errors += case_lock<gdm::SpinLock>("spin");
+  errors += case_lock<gdm::TicketLock>("ticket");
+  errors += case_lock<gdm::McsLock>("mcs");
+  errors += case_lock<gdm::RwSpinLock>("rw spin");
+  errors += case_rw_lock();
+
+  printf(errors ? "FAILED\n" : "COMPLETED\n");
+  return errors ? -1 : 0;
+}
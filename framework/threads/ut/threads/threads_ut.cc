@@ -23,6 +23,7 @@
 
 #include "threads/thread.h"
 #include "threads/spin_lock.h"
+#include "threads/cpu_topology.h"
 
 struct S
 {
@@ -94,3 +95,30 @@ TEST_CASE("Threads")
     }
   }
 }
+
+TEST_CASE("CpuTopology")
+{
+  gdm::CpuTopology topology = gdm::CpuTopology::Probe();
+  const unsigned main_cpu = topology.GetCpus().front().id_;
+
+  REQUIRE(topology.GetCpusCount() > 0);
+  REQUIRE(topology.GetCoresCount() > 0);
+  REQUIRE(topology.GetCoresCount() <= topology.GetCpusCount());
+  REQUIRE(topology.FindCpu(main_cpu) != nullptr);
+
+  SECTION("Placement")
+  {
+    const unsigned workers = topology.GetCpusCount() * 2;
+    REQUIRE(topology.MakePlacement(gdm::core::PLACE_ANY, workers, main_cpu).empty());
+    REQUIRE(topology.MakePlacement(gdm::core::PLACE_SEQUENTIAL, workers, main_cpu).size() == workers);
+
+    std::vector<unsigned> cores = topology.MakePlacement(gdm::core::PLACE_PHYSICAL_CORES, workers, main_cpu);
+    REQUIRE(cores.size() == workers);
+    for (unsigned i = 0; i < topology.GetCoresCount() - 1; ++i)
+      REQUIRE(topology.FindCpu(cores[i])->smt_index_ == 0);
+    REQUIRE(cores[topology.GetCpusCount() - 1] == main_cpu);
+
+    for (unsigned cpu : topology.MakePlacement(gdm::core::PLACE_L3_DOMAIN, workers, main_cpu))
+      REQUIRE(topology.FindCpu(cpu)->l3_ == topology.FindCpu(main_cpu)->l3_);
+  }
+}
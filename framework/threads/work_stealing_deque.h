@@ -0,0 +1,70 @@
+// *************************************************************
+// File:    work_stealing_deque.h
+// Author:  Novoselov Anton @ 2018
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+// Chase-Lev deque (https://www.dre.vanderbilt.edu/~schmidt/PDF/work-stealing-dequeue.pdf)
+// with memory orders from "Correct and Efficient Work-Stealing for Weak Memory Models"
+// (Le, Pop, Cohen, Nardelli - 2013)
+
+#ifndef AH_GDM_WORK_STEALING_DEQUE_H
+#define AH_GDM_WORK_STEALING_DEQUE_H
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+
+namespace gdm {
+
+// Owner thread calls Push/Pop from bottom (LIFO), any other thread
+// calls Steal from top (FIFO). Buffer grows on overflow, old buffers
+// are kept until destruction since thieves may still read them
+
+template <class T>
+struct WorkStealingDeque
+{
+  static_assert(std::is_trivially_copyable_v<T>, "Deque stores items in atomics");
+
+  explicit WorkStealingDeque(int capacity = 1024);
+  ~WorkStealingDeque();
+  WorkStealingDeque(const WorkStealingDeque&) = delete;
+  WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+public:
+  void Push(T item);
+  bool Pop(T& item);
+  bool Steal(T& item);
+
+  auto GetSize() const -> int;
+  bool IsEmpty() const { return GetSize() <= 0; }
+
+private:
+  struct Buffer
+  {
+    explicit Buffer(std::int64_t capacity);
+    ~Buffer();
+
+    auto Get(std::int64_t index) const -> T;
+    void Put(std::int64_t index, T item);
+    auto Grow(std::int64_t bottom, std::int64_t top) const -> Buffer*;
+
+    std::int64_t capacity_;
+    std::int64_t mask_;
+    std::atomic<T>* items_;
+  };
+
+private:
+  alignas(64) std::atomic<std::int64_t> top_;
+  alignas(64) std::atomic<std::int64_t> bottom_;
+  alignas(64) std::atomic<Buffer*> buffer_;
+  std::vector<Buffer*> retired_;
+
+}; // struct WorkStealingDeque
+
+} // namespace gdm
+
+#include "work_stealing_deque.inl"
+
+#endif // AH_GDM_WORK_STEALING_DEQUE_H
@@ -0,0 +1,137 @@
+// *************************************************************
+// File:    work_stealing_deque.inl
+// Author:  Novoselov Anton @ 2018
+// URL:     https://github.com/ans-hub/gdm_framework
+// *************************************************************
+
+#include "work_stealing_deque.h"
+
+#include <assert.h>
+
+// --private Buffer
+
+template <class T>
+inline gdm::WorkStealingDeque<T>::Buffer::Buffer(std::int64_t capacity)
+  : capacity_{capacity}
+  , mask_{capacity - 1}
+  , items_{new std::atomic<T>[static_cast<std::size_t>(capacity)]}
+{
+  assert((capacity & (capacity - 1)) == 0 && "Capacity should be power of 2");
+}
+
+template <class T>
+inline gdm::WorkStealingDeque<T>::Buffer::~Buffer()
+{
+  delete[] items_;
+}
+
+template <class T>
+inline T gdm::WorkStealingDeque<T>::Buffer::Get(std::int64_t index) const
+{
+  return items_[index & mask_].load(std::memory_order_relaxed);
+}
+
+template <class T>
+inline void gdm::WorkStealingDeque<T>::Buffer::Put(std::int64_t index, T item)
+{
+  items_[index & mask_].store(item, std::memory_order_relaxed);
+}
+
+template <class T>
+inline auto gdm::WorkStealingDeque<T>::Buffer::Grow(std::int64_t bottom, std::int64_t top) const -> Buffer*
+{
+  Buffer* buffer = new Buffer(capacity_ * 2);
+  for (std::int64_t i = top; i != bottom; ++i)
+    buffer->Put(i, Get(i));
+  return buffer;
+}
+
+// --public
+
+template <class T>
+inline gdm::WorkStealingDeque<T>::WorkStealingDeque(int capacity)
+  : top_{0}
+  , bottom_{0}
+  , buffer_{new Buffer(capacity)}
+  , retired_{}
+{ }
+
+template <class T>
+inline gdm::WorkStealingDeque<T>::~WorkStealingDeque()
+{
+  for (Buffer* buffer : retired_)
+    delete buffer;
+  delete buffer_.load();
+}
+
+template <class T>
+inline void gdm::WorkStealingDeque<T>::Push(T item)
+{
+  std::int64_t bottom = bottom_.load(std::memory_order_relaxed);
+  std::int64_t top = top_.load(std::memory_order_acquire);
+  Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+
+  if (bottom - top > buffer->capacity_ - 1)
+  {
+    retired_.push_back(buffer);
+    buffer = buffer->Grow(bottom, top);
+    buffer_.store(buffer, std::memory_order_release);
+  }
+
+  buffer->Put(bottom, item);
+  std::atomic_thread_fence(std::memory_order_release);
+  bottom_.store(bottom + 1, std::memory_order_relaxed);
+}
+
+template <class T>
+inline bool gdm::WorkStealingDeque<T>::Pop(T& item)
+{
+  std::int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+  Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+  bottom_.store(bottom, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  std::int64_t top = top_.load(std::memory_order_relaxed);
+
+  if (top > bottom)
+  {
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+    return false;
+  }
+
+  item = buffer->Get(bottom);
+  if (top != bottom)
+    return true;
+
+  // last item - race with thieves for it
+
+  bool won = top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+  bottom_.store(bottom + 1, std::memory_order_relaxed);
+  return won;
+}
+
+template <class T>
+inline bool gdm::WorkStealingDeque<T>::Steal(T& item)
+{
+  std::int64_t top = top_.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  std::int64_t bottom = bottom_.load(std::memory_order_acquire);
+
+  if (top >= bottom)
+    return false;
+
+  Buffer* buffer = buffer_.load(std::memory_order_consume);
+  T stolen = buffer->Get(top);
+  if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    return false;
+
+  item = stolen;
+  return true;
+}
+
+template <class T>
+inline int gdm::WorkStealingDeque<T>::GetSize() const
+{
+  std::int64_t bottom = bottom_.load(std::memory_order_relaxed);
+  std::int64_t top = top_.load(std::memory_order_relaxed);
+  return static_cast<int>(bottom - top);
+}